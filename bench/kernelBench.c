@@ -0,0 +1,380 @@
+/**
+ * kernelBench.c
+ *
+ * Microbenchmarks for the kernels of the exact and heuristic algorithms, used
+ * to compare the bitset backends. The library is included as a whole, such
+ * that its static functions can be called directly and are compiled with the
+ * same bitset width as this file. Every kernel is run on a fixed set of
+ * embedded cubic graphs and the time per operation is reported as the mean and
+ * standard deviation over a number of samples.
+ *
+ */
+
+#define USAGE \
+"\nUsage: `./kernelBench [-h] [-m #] [-s #]`\n"
+#define HELPTEXT \
+"Time the kernels of the exact and heuristic algorithms on embedded cubic\n\
+graphs using the bitset backend this program was compiled with.\n\
+\n\
+  -h, --help                    Print this help text\n\
+  -m, --sample-ms=#             Minimal duration of one sample in\n\
+                                 milliseconds; Default is 5\n\
+  -s, --samples=#               Number of samples per kernel; Default is 15\n\
+"
+#include <getopt.h>
+#include <math.h>
+#include "../frankNumber/frankNumber.c"
+#include "../readGraph/readGraph6.h"
+
+#if defined(USE_64_BIT)
+#define BACKEND "64"
+#elif defined(USE_128_BIT)
+#define BACKEND "128"
+#else
+#define BACKEND "128a"
+#endif
+
+//******************************************************************************
+//
+//                          Embedded graphs
+//
+//******************************************************************************
+
+//  Graphs whose number of vertices exceeds fn_max_vertices() are skipped. The
+//  graph6 strings end with a newline, as expected by loadGraph().
+static const struct {
+    const char *name;
+    const char *graphString;
+} embeddedGraphs[] = {
+    {"petersen", "IheA@GUAo\n"},
+    {"blanusa", "QHeA@GUA_A?@_@O??A??Q?@W?Ao\n"},
+    {"flower5", "Ss@HOo?@GD?K???C_@O?K??@?@G_@P??o\n"},
+    {"flower7", "[s@HOo?@GD?K???C_@O?K????@G?@O??o?????@G??D???K????O??Ca"
+     "??@P???K\n"},
+    {"flower9", "cs@HOo?@GD?K???C_@O?K????@G?@O??o?????@G??D???K???????C_??"
+     "@O???K????????@G???@O????o?????O???@G_???DC????K\n"},
+    {"flower15", "{s@HOo?@GD?K???C_@O?K????@G?@O??o?????@G??D???K???????C_??"
+     "@O???K????????@G???@O????o?????????@G????D?????K???????????C_????@O???"
+     "??K????????????@G?????@O??????o?????????????@G??????D???????K?????????"
+     "??????C_??????@O???????K????????????????@G???????@O????????o?????????O"
+     "???????@G_???????DC????????K\n"}
+};
+
+#define NUMBER_OF_EMBEDDED_GRAPHS \
+ (int) (sizeof(embeddedGraphs)/sizeof(embeddedGraphs[0]))
+
+//  A graph together with a strong orientation and its deletable edges, which
+//  are the inputs of the kernels of the exact algorithm.
+struct benchGraph {
+    const char *graphString;
+    int numberOfVertices;
+    struct cubicGraph cubicGraph;
+    struct diGraph orientation;
+    edgeset deletableEdges;
+    struct arena arena;
+};
+
+//  Orient the tree edges of a depth first search away from the root and the
+//  other edges towards it. This gives a strong orientation of every
+//  2-edge-connected graph.
+static void orientDepthFirst(struct benchGraph *graph, int vertex,
+ int parent, int depth[]) {
+    forEach(nbr, graph->cubicGraph.adjacencyList[vertex]) {
+        if(nbr == parent) {
+            continue;
+        }
+        if(depth[nbr] == -1) {
+            depth[nbr] = depth[vertex] + 1;
+            addArc(&graph->orientation, vertex, nbr);
+            orientDepthFirst(graph, nbr, vertex, depth);
+        }
+        else if(depth[nbr] < depth[vertex]) {
+            addArc(&graph->orientation, vertex, nbr);
+        }
+    }
+}
+
+static bool loadBenchGraph(struct benchGraph *graph, const char *graphString) {
+    int n = getNumberOfVertices(graphString);
+    if(n > fn_max_vertices()) {
+        return false;
+    }
+    if(n < 1 ||
+     loadGraph(graphString, n, graph->cubicGraph.adjacencyList) == -1) {
+        fprintf(stderr, "Error: could not load %s", graphString);
+        exit(1);
+    }
+    graph->graphString = graphString;
+    graph->numberOfVertices = n;
+    initCubicGraph(&graph->cubicGraph, n);
+    graph->orientation = (struct diGraph) {.numberOfVertices = n,
+     .adjacencyList = malloc(sizeof(bitset)*n),
+     .reverseAdjacencyList = malloc(sizeof(bitset)*n)};
+    emptyGraph(&graph->orientation);
+    int depth[n];
+    for(int i = 0; i < n; i++) {
+        depth[i] = -1;
+    }
+    depth[0] = 0;
+    orientDepthFirst(graph, 0, -1, depth);
+    if(!isStronglyConnected(&graph->orientation)) {
+        fprintf(stderr, "Error: no strong orientation of %s\n", graphString);
+        exit(1);
+    }
+    graph->deletableEdges = getDeletableEdges(&graph->cubicGraph,
+     &graph->orientation);
+    if(!initArena(&graph->arena, getArenaSize(n))) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    return true;
+}
+
+static void freeBenchGraph(struct benchGraph *graph) {
+    free(graph->orientation.adjacencyList);
+    free(graph->orientation.reverseAdjacencyList);
+    freeArena(&graph->arena);
+}
+
+//******************************************************************************
+//
+//                          Kernels
+//
+//******************************************************************************
+
+//  Every kernel performs one operation on the graph and returns a value
+//  depending on its result, such that the compiler cannot remove it.
+typedef long long int kernel(struct benchGraph *graph);
+
+static long long int decodeKernel(struct benchGraph *graph) {
+    bitset adjacencyList[MAXVERTICES];
+    loadGraph(graph->graphString, graph->numberOfVertices, adjacencyList);
+    return size(adjacencyList[graph->numberOfVertices - 1]);
+}
+
+//  Iterate over the neighbours of every vertex and over all vertices.
+static long long int forEachKernel(struct benchGraph *graph) {
+    long long int sum = 0;
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        forEach(nbr, graph->cubicGraph.adjacencyList[i]) {
+            sum += nbr;
+        }
+    }
+    forEach(vertex, complement(EMPTY, graph->numberOfVertices)) {
+        sum += vertex;
+    }
+    return sum;
+}
+
+//  The smallest neighbour of every vertex.
+static long long int firstKernel(struct benchGraph *graph) {
+    long long int sum = 0;
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        sum += first(graph->cubicGraph.adjacencyList[i]);
+    }
+    return sum;
+}
+
+//  The largest neighbour of every vertex, picked as the one which is neither
+//  of the two smallest.
+static long long int otherOfThreeKernel(struct benchGraph *graph) {
+    long long int sum = 0;
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        int *neighbours = graph->cubicGraph.neighbours[i];
+        sum += otherOfThree(graph->cubicGraph.adjacencyList[i], neighbours[0],
+         neighbours[1]);
+    }
+    return sum;
+}
+
+//  The size of the out- and in-neighbourhood of every vertex and of the set of
+//  deletable edges.
+static long long int sizeKernel(struct benchGraph *graph) {
+    long long int sum = edgeSetSize(graph->deletableEdges);
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        sum += size(graph->orientation.adjacencyList[i]);
+        sum += size(graph->orientation.reverseAdjacencyList[i]);
+    }
+    return sum;
+}
+
+static long long int isStronglyConnectedKernel(struct benchGraph *graph) {
+    return isStronglyConnected(&graph->orientation);
+}
+
+//  Orient the edges one by one as in the strong orientation, checking that
+//  the mixed graph stays strongly connected, as done by
+//  generateAllOrientations() on its way to a leaf.
+static long long int orientPossibleArcKernel(struct benchGraph *graph) {
+    struct cubicGraph *cubicGraph = &graph->cubicGraph;
+    bitset possibleSuccessors[MAXVERTICES];
+    memcpy(possibleSuccessors, cubicGraph->adjacencyList,
+     sizeof(bitset)*graph->numberOfVertices);
+    long long int sum = 0;
+    for(int edge = 0; edge < cubicGraph->numberOfEdges; edge++) {
+        int u = cubicGraph->endpoints[edge][0];
+        int w = cubicGraph->endpoints[edge][1];
+        if(!contains(graph->orientation.adjacencyList[u], w)) {
+            w = u;
+            u = cubicGraph->endpoints[edge][1];
+        }
+        sum += orientPossibleArc(possibleSuccessors, u, w);
+    }
+    return sum;
+}
+
+static long long int getDeletableEdgesKernel(struct benchGraph *graph) {
+    return edgeSetSize(getDeletableEdges(&graph->cubicGraph,
+     &graph->orientation));
+}
+
+//  Fix the first arc of a complementary orientation and propagate the arcs it
+//  forces, as done by hasComplementaryOrientation().
+static long long int canAddNewArcKernel(struct benchGraph *graph) {
+    struct orientation orientation = emptyOrientation();
+    bool added = canAddNewArc(&graph->cubicGraph, &orientation, 0, 0,
+     graph->deletableEdges);
+    return added + edgeSetSize(orientation.oriented);
+}
+
+//  The perfect matching heuristic of the sufficient condition.
+static long long int heuristicKernel(struct benchGraph *graph) {
+    int n = graph->numberOfVertices;
+    struct options options = {.modulo = 1, .arena = &graph->arena};
+    struct fn_counters numberOf = {0};
+    int F[n];
+    return hasSufficientCondition(&graph->cubicGraph, &options, &numberOf,
+     graph->cubicGraph.vertexUniverse, F, NULL);
+}
+
+static const struct {
+    const char *name;
+    kernel *function;
+} kernels[] = {
+    {"decode", decodeKernel},
+    {"forEach", forEachKernel},
+    {"first", firstKernel},
+    {"otherOfThree", otherOfThreeKernel},
+    {"size", sizeKernel},
+    {"isStronglyConnected", isStronglyConnectedKernel},
+    {"orientPossibleArc", orientPossibleArcKernel},
+    {"getDeletableEdges", getDeletableEdgesKernel},
+    {"canAddNewArc", canAddNewArcKernel},
+    {"heuristic", heuristicKernel}
+};
+
+#define NUMBER_OF_KERNELS (int) (sizeof(kernels)/sizeof(kernels[0]))
+
+//******************************************************************************
+//
+//                          Timing
+//
+//******************************************************************************
+
+static volatile long long int sink;
+
+static double getSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+//  Seconds taken by running the kernel the given number of times.
+static double timeKernel(kernel *function, struct benchGraph *graph,
+ long long int operations) {
+    long long int sum = 0;
+    double start = getSeconds();
+    for(long long int i = 0; i < operations; i++) {
+        sum += function(graph);
+    }
+    double seconds = getSeconds() - start;
+    sink += sum;
+    return seconds;
+}
+
+//  Double the number of operations per sample until a sample takes at least
+//  sampleSeconds, then take the samples and report the mean and standard
+//  deviation of the time per operation.
+static void benchmarkKernel(const char *graphName, struct benchGraph *graph,
+ int k, int samples, double sampleSeconds) {
+    long long int operations = 1;
+    while(timeKernel(kernels[k].function, graph, operations) <
+     sampleSeconds) {
+        operations *= 2;
+    }
+    double sum = 0;
+    double sumOfSquares = 0;
+    for(int i = 0; i < samples; i++) {
+        double nanoseconds = 1e9 *
+         timeKernel(kernels[k].function, graph, operations) / operations;
+        sum += nanoseconds;
+        sumOfSquares += nanoseconds * nanoseconds;
+    }
+    double mean = sum / samples;
+    double variance = samples > 1 ?
+     (sumOfSquares - samples * mean * mean) / (samples - 1) : 0;
+    double deviation = variance > 0 ? sqrt(variance) : 0;
+    printf("%-8s %-10s %4d  %-20s %12.1f %10.1f %6.1f%%\n", BACKEND,
+     graphName, graph->numberOfVertices, kernels[k].name, mean, deviation,
+     mean > 0 ? 100 * deviation / mean : 0);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    int samples = 15;
+    double sampleSeconds = 0.005;
+    int opt;
+    while (1) {
+        int option_index = 0;
+        static struct option long_options[] =
+        {
+            {"help", no_argument, NULL, 'h'},
+            {"sample-ms", required_argument, NULL, 'm'},
+            {"samples", required_argument, NULL, 's'},
+            {NULL, 0, NULL, 0}
+        };
+
+        opt = getopt_long(argc, argv, "hm:s:", long_options, &option_index);
+        if (opt == -1) break;
+        switch(opt) {
+            case 'h':
+                fprintf(stderr, "%s\n", USAGE);
+                fprintf(stderr, "%s", HELPTEXT);
+                return 0;
+            case 'm':
+                sampleSeconds = strtol(optarg, NULL, 10) / 1000.0;
+                if(sampleSeconds <= 0) {
+                    fprintf(stderr, "Error: sample-ms should be positive.\n");
+                    return 1;
+                }
+                break;
+            case 's':
+                samples = (int) strtol(optarg, NULL, 10);
+                if(samples < 1) {
+                    fprintf(stderr, "Error: take at least one sample.\n");
+                    return 1;
+                }
+                break;
+            case '?':
+                fprintf(stderr, "%s\n", USAGE);
+                return 1;
+        }
+    }
+
+    printf("%-8s %-10s %4s  %-20s %12s %10s %7s\n", "backend", "graph", "n",
+     "kernel", "ns/op", "stddev", "cv");
+    for(int g = 0; g < NUMBER_OF_EMBEDDED_GRAPHS; g++) {
+        struct benchGraph graph;
+        if(!loadBenchGraph(&graph, embeddedGraphs[g].graphString)) {
+            fprintf(stderr, "Skipping %s, too large for this backend.\n",
+             embeddedGraphs[g].name);
+            continue;
+        }
+        for(int k = 0; k < NUMBER_OF_KERNELS; k++) {
+            benchmarkKernel(embeddedGraphs[g].name, &graph, k, samples,
+             sampleSeconds);
+        }
+        freeBenchGraph(&graph);
+    }
+    return 0;
+}
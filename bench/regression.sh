@@ -0,0 +1,205 @@
+#!/bin/sh
+#
+# regression.sh
+#
+# End-to-end benchmark of findFrankNumber on the graphs of bench/corpus.txt,
+# whose Frank numbers are known. Every mode is run on the whole corpus and
+# the answers and the time taken are compared with a baseline JSON file. The
+# first run, or a run with -u, writes the baseline instead.
+#
+# Exits with status 1 if an answer is wrong, differs from the baseline or if
+# a mode became slower than the baseline by more than the threshold.
+
+USAGE="Usage: bench/regression.sh [-h] [-u] [-b FILE] [-r #] [-t #] [BINARY]"
+HELPTEXT="Run BINARY (default ./findFrankNumber) in the modes default, -e, -b,
+-2 and -s on the graphs of bench/corpus.txt and compare the answers and the
+time taken with a baseline.
+
+  -b FILE   Baseline file; Default is bench/baseline.json
+  -h        Print this help text
+  -r #      Take the fastest of # runs of every mode; Default is 5
+  -t #      Report a slowdown if a mode takes more than # percent longer
+             than in the baseline; Default is 10
+  -u        Write the baseline instead of comparing with it"
+
+directory=$(dirname "$0")
+corpus="$directory/corpus.txt"
+baseline="$directory/baseline.json"
+runs=5
+threshold=10
+update=false
+while getopts "b:hr:t:u" opt; do
+    case $opt in
+        b) baseline=$OPTARG ;;
+        h) echo "$USAGE"; echo; echo "$HELPTEXT"; exit 0 ;;
+        r) runs=$OPTARG ;;
+        t) threshold=$OPTARG ;;
+        u) update=true ;;
+        *) echo "$USAGE" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+binary=${1:-./findFrankNumber}
+if [ ! -x "$binary" ]; then
+    echo "Error: $binary is not an executable, build it first." >&2
+    exit 1
+fi
+if [ ! -f "$baseline" ]; then
+    update=true
+fi
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Lines starting with # are comments.
+grep -v '^#' "$corpus" > "$work/corpus.txt"
+corpus="$work/corpus.txt"
+awk '{print $3}' "$corpus" > "$work/corpus.g6"
+numberOfGraphs=$(wc -l < "$work/corpus.g6")
+
+# Known Frank numbers in corpus order, e.g. 3222.
+expected=$(awk '{printf "%s", $2}' "$corpus")
+
+now() {
+    date +%s%N
+}
+
+# Turn the graphs written to stdout into answers in corpus order: 3 if the
+# graph was written, i.e. it was not shown to have Frank number 2, else 2.
+getAnswers() {
+    awk 'NR == FNR {written[$0] = 1; next}
+     {printf "%s", ($3 in written) ? 3 : 2}' "$1" "$corpus"
+}
+
+# Check the whole corpus with the given flags. Sets seconds and answers.
+runMode() {
+    best=
+    for run in $(seq "$runs"); do
+        start=$(now)
+        "$binary" "$@" < "$work/corpus.g6" > "$work/output" 2> /dev/null
+        end=$(now)
+        if [ -z "$best" ] || [ $((end - start)) -lt "$best" ]; then
+            best=$((end - start))
+        fi
+    done
+    seconds=$(awk -v ns="$best" 'BEGIN {printf "%.6f", ns / 1e9}')
+    answers=$(getAnswers "$work/output")
+}
+
+# Check every graph on its own, split over two parts with -s. A graph has
+# Frank number 2 if one of the parts shows this, i.e. does not write it.
+runSingleGraphMode() {
+    best=
+    for run in $(seq "$runs"); do
+        : > "$work/output"
+        start=$(now)
+        while read -r graph; do
+            parts=0
+            for part in 0/2 1/2; do
+                if [ -n "$(echo "$graph" | "$binary" -s "$part" \
+                 2> /dev/null)" ]; then
+                    parts=$((parts + 1))
+                fi
+            done
+            if [ $parts -eq 2 ]; then
+                echo "$graph" >> "$work/output"
+            fi
+        done < "$work/corpus.g6"
+        end=$(now)
+        if [ -z "$best" ] || [ $((end - start)) -lt "$best" ]; then
+            best=$((end - start))
+        fi
+    done
+    seconds=$(awk -v ns="$best" 'BEGIN {printf "%.6f", ns / 1e9}')
+    answers=$(getAnswers "$work/output")
+}
+
+# Read the seconds or answers of a mode from the baseline, which has one line
+# per mode.
+getBaseline() {
+    pattern="\"$1\": {\"seconds\": \([0-9.]*\), .*\"answers\": \"\([0-9]*\)\""
+    sed -n "s/.*$pattern.*/\\$2/p" "$baseline"
+}
+
+# Every answer of the heuristic should be 3 if the known Frank number is 3;
+# the other modes should give the known Frank number.
+isCorrect() {
+    if [ "$1" = "only-heuristic" ]; then
+        awk -v a="$2" -v e="$expected" 'BEGIN {
+            for(i = 1; i <= length(e); i++) {
+                if(substr(e, i, 1) == 3 && substr(a, i, 1) != 3) {
+                    exit 1
+                }
+            }
+        }'
+    else
+        [ "$2" = "$expected" ]
+    fi
+}
+
+# Names of the graphs for which two answer strings differ.
+getDifferences() {
+    awk -v a="$1" -v b="$2" '{
+        if(substr(a, NR, 1) != substr(b, NR, 1)) {
+            printf " %s", $1
+        }
+    }' "$corpus"
+}
+
+failed=false
+json="{\n  \"binary\": \"$binary\",\n  \"graphs\": $numberOfGraphs,\n  \"modes\": {"
+separator=
+printf "%-16s %10s %12s %10s  %s\n" "mode" "seconds" "graphs/s" "baseline" \
+ "result"
+for mode in default only-exact brute-force only-heuristic single-graph; do
+    case $mode in
+        default) runMode ;;
+        only-exact) runMode -e ;;
+        brute-force) runMode -b ;;
+        only-heuristic) runMode -2 ;;
+        single-graph) runSingleGraphMode ;;
+    esac
+    throughput=$(awk -v n="$numberOfGraphs" -v s="$seconds" \
+     'BEGIN {printf "%.1f", (s > 0 ? n / s : 0)}')
+    json="$json$separator\n    \"$mode\": {\"seconds\": $seconds, \"graphsPerSecond\": $throughput, \"answers\": \"$answers\"}"
+    separator=","
+
+    result=ok
+    if ! isCorrect "$mode" "$answers"; then
+        result="WRONG ANSWER:$(getDifferences "$answers" "$expected")"
+        failed=true
+    fi
+    baselineSeconds=-
+    if ! $update; then
+        baselineSeconds=$(getBaseline "$mode" 1)
+        baselineAnswers=$(getBaseline "$mode" 2)
+        if [ -z "$baselineSeconds" ]; then
+            baselineSeconds=-
+        elif [ "$answers" != "$baselineAnswers" ]; then
+            result="$result, DIFFERS FROM BASELINE:$(getDifferences \
+             "$answers" "$baselineAnswers")"
+            failed=true
+        else
+            change=$(awk -v s="$seconds" -v b="$baselineSeconds" \
+             'BEGIN {printf "%+.1f", (b > 0 ? 100 * (s - b) / b : 0)}')
+            if awk -v c="$change" -v t="$threshold" 'BEGIN {exit !(c > t)}'
+            then
+                result="$result, SLOWER BY $change%"
+                failed=true
+            else
+                result="$result ($change%)"
+            fi
+        fi
+    fi
+    printf "%-16s %10s %12s %10s  %s\n" "$mode" "$seconds" "$throughput" \
+     "$baselineSeconds" "$result"
+done
+json="$json\n  }\n}"
+
+if $update; then
+    printf "$json\n" > "$baseline"
+    echo "Wrote baseline to $baseline."
+fi
+if $failed; then
+    exit 1
+fi
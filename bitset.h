@@ -3,15 +3,21 @@
 
 #ifdef USE_64_BIT
 	#include "bitset64Vertices.h"
+	#include "bitset64Edges.h"
 	#define MAXVERTICES 64
+	#define MAXEDGES 64
 
 #elif defined(USE_128_BIT)
 	#include "bitset128Vertices.h"
+	#include "bitset256Edges.h"
 	#define MAXVERTICES 128
+	#define MAXEDGES 256
 
 #elif defined(USE_128_BIT_ARRAY)
 	#include "bitset128VerticesArray.h"
+	#include "bitset256Edges.h"
 	#define MAXVERTICES 128
+	#define MAXEDGES 256
 
 #endif
 
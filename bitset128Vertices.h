@@ -40,22 +40,55 @@ typedef uint64_t bitset __attribute__ ((vector_size (NOFBYTES)));
 //	Define whether set1 equals set2.
 #define equals(set1, set2) (((set1) == (set2))[0] && ((set1) == (set2))[1])
 
-//	Loops over all elements of the set. 
-#define forEach(element, set) for (int element = next((set), -1); (element) != -1; (element) = next((set), (element)))
-
-//	Loops over all elements of the set starting from start (not included). 
-#define forEachAfterIndex(element, set, start) for (int element = next((set), (start)); (element) != -1; (element) = next((set), (element)))
-
-#define next(set, current)  (current < 63 ? safeNext0(set, current) : safeNext64(set, current))
-
-#define safeNext0(set, current) (set[0] ? unsafeNext0(set, current) : safeNext64(set, 63))
-#define safeNext64(set, current) (set[1] ? unsafeNext64(set, current) : -1)
-
-#define unsafeNext0(set, current) (__builtin_clzll((set)[0]) + (current) >= 63 ? safeNext64(set, 63) : \
-																				 (current) + __builtin_ctzll((set)[0] >> ((current) + 1)) + 1)
-#define unsafeNext64(set, current) (__builtin_clzll((set)[1]) + ((current) - 64) >= 63 ? -1 : \
-		 																				(current) + __builtin_ctzll((set)[1] >> ((current) - 64 + 1)) + 1)
-
+//  Returns the smallest element of a non-empty set.
+#define first(set) ((set)[0] ? __builtin_ctzll((set)[0]) : \
+ 64 + __builtin_ctzll((set)[1]))
+
+//  Returns the element of a set of size one. Only one word is non-zero, so
+//  their union has the same lowest bit.
+#define onlyElement(set) (__builtin_ctzll((set)[0] | (set)[1]) + \
+ ((set)[0] ? 0 : 64))
+
+//  Returns the element of a set of size three, such as the neighbourhood of a
+//  vertex in a cubic graph, which is neither of its elements a and b.
+#define otherOfThree(set, a, b) \
+ onlyElement(difference((set), union(singleton(a), singleton(b))))
+
+//  Removes smallest, the smallest element of set, by clearing the lowest bit of
+//  its word. The word is not indexed by a variable, such that the set can stay
+//  in registers.
+#define removeSmallest(set, smallest) ((smallest) < 64 ? \
+ ((set)[0] &= (set)[0] - 1) : ((set)[1] &= (set)[1] - 1))
+
+//  Returns the elements of the set which are larger than start, for start
+//  between -1 and 127.
+static inline bitset elementsAfter(bitset set, int start) {
+    for(int i = 0; i < 2; i++) {
+        int bits = start + 1 - 64*i;
+        set[i] &= bits <= 0 ? ~(uint64_t) 0 :
+         bits >= 64 ? 0 : ~(uint64_t) 0 << bits;
+    }
+    return set;
+}
+
+//  Loops over all elements of the set in increasing order. The set is
+//  evaluated once, so elements removed from it in the body are still visited;
+//  use first() in a while loop for that. The outer two loops run once and only
+//  scope the copy of the set, such that break and continue work as usual.
+#define forEach(element, set) \
+ for(int element = 0, element##Once = 1; element##Once; element##Once = 0) \
+  for(bitset element##Rest = (set); element##Once; element##Once = 0) \
+   for(; !isEmpty(element##Rest) && (element = first(element##Rest), 1); \
+    removeSmallest(element##Rest, element))
+
+//  Loops over all elements of the set starting from start (not included).
+#define forEachAfterIndex(element, set, start) \
+ forEach(element, elementsAfter((set), (start)))
+
+//  Returns the first element after current in the set, or -1 if there is
+//  none.
+#define next(set, current) (isEmpty(elementsAfter((set), (current))) ? -1 : \
+ first(elementsAfter((set), (current))))
 
 //  Checks whether node is an element of set.
 #define contains(set, node) (!isEmpty(intersection((set), singleton(node))))
@@ -0,0 +1,66 @@
+// EDGE SETS FOR GRAPHS UP TO 256 EDGES
+#ifndef EDGESET_MACROS
+#define EDGESET_MACROS
+
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+//  Edge set macros, we assume edges are labeled 0,1,2,... Edge sets are wider
+//  than vertex sets, since a cubic graph on n vertices has 3n/2 edges. With
+//  AVX2 every operation is a single instruction on a 256-bit register.
+typedef uint64_t edgeset __attribute__ ((vector_size (32)));
+
+//  Returns an empty edge set.
+#define EMPTY_EDGES (edgeset) {0LL}
+
+//  Returns the edge set {0,1,...,numberOfEdges - 1}.
+static inline edgeset allEdges(int numberOfEdges) {
+    edgeset set;
+    for(int i = 0; i < 4; i++) {
+        int bits = numberOfEdges - 64*i;
+        set[i] = bits >= 64 ? ~(uint64_t) 0 :
+         bits <= 0 ? 0 : ~(uint64_t) 0 >> (64 - bits);
+    }
+    return set;
+}
+
+//  Adds edge to set.
+#define addEdge(set, edge) ((set)[(edge) >> 6] |= (uint64_t) 1 << ((edge) & 63))
+
+//  Removes edge from set.
+#define removeEdge(set, edge) \
+ ((set)[(edge) >> 6] &= ~((uint64_t) 1 << ((edge) & 63)))
+
+//  Checks whether edge is an element of set.
+#define containsEdge(set, edge) (((set)[(edge) >> 6] >> ((edge) & 63)) & 1)
+
+//  Returns the union of set1 and set2.
+#define edgeUnion(set1, set2) ((set1) | (set2))
+
+//  Returns the intersection of set1 and set2.
+#define edgeIntersection(set1, set2) ((set1) & (set2))
+
+//  Returns set1\set2 (set difference).
+#define edgeDifference(set1, set2) ((set1) & ~(set2))
+
+//  Check if set is empty.
+static inline bool isEmptyEdgeSet(edgeset set) {
+#ifdef __AVX2__
+    return _mm256_testz_si256((__m256i) set, (__m256i) set);
+#else
+    return !(set[0] | set[1] | set[2] | set[3]);
+#endif
+}
+
+//  Check if set1 equals set2.
+#define edgeSetsEqual(set1, set2) isEmptyEdgeSet((set1) ^ (set2))
+
+//  Returns the size of the set.
+#define edgeSetSize(set) (__builtin_popcountll((set)[0]) + \
+ __builtin_popcountll((set)[1]) + __builtin_popcountll((set)[2]) + \
+ __builtin_popcountll((set)[3]))
+
+#endif
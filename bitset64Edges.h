@@ -0,0 +1,42 @@
+// EDGE SETS FOR GRAPHS UP TO 64 EDGES
+#ifndef EDGESET_MACROS
+#define EDGESET_MACROS
+
+//  Edge set macros, we assume edges are labeled 0,1,2,... Edge sets are
+//  bitsets of the same width as vertex sets, see bitset64Vertices.h.
+typedef bitset edgeset;
+
+//  Returns an empty edge set.
+#define EMPTY_EDGES EMPTY
+
+//  Returns the edge set {0,1,...,numberOfEdges - 1}.
+#define allEdges(numberOfEdges) complement(EMPTY, (numberOfEdges))
+
+//  Adds edge to set.
+#define addEdge(set, edge) add((set), (edge))
+
+//  Removes edge from set.
+#define removeEdge(set, edge) removeElement((set), (edge))
+
+//  Checks whether edge is an element of set.
+#define containsEdge(set, edge) contains((set), (edge))
+
+//  Returns the union of set1 and set2.
+#define edgeUnion(set1, set2) union((set1), (set2))
+
+//  Returns the intersection of set1 and set2.
+#define edgeIntersection(set1, set2) intersection((set1), (set2))
+
+//  Returns set1\set2 (set difference).
+#define edgeDifference(set1, set2) difference((set1), (set2))
+
+//  Check if set is empty.
+#define isEmptyEdgeSet(set) isEmpty(set)
+
+//  Check if set1 equals set2.
+#define edgeSetsEqual(set1, set2) equals((set1), (set2))
+
+//  Returns the size of the set.
+#define edgeSetSize(set) size(set)
+
+#endif
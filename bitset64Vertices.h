@@ -36,18 +36,43 @@ typedef uint64_t bitset;
 //	Check if set1 equals set2.
 #define equals(set1, set2) ((set1) == (set2))
 
-//	Loops over all elements of the set. 
-#define forEach(element, set) for (int element = next((set), -1); (element) != -1; (element) = next((set), (element)))
-
-//	Loops over all elements of the set starting from start (not included). 
-#define forEachAfterIndex(element, set, start) for (int element = next((set), (start)); (element) != -1; (element) = next((set), (element)))
-
-//  Returns -1 if the set is empty. Otherwise it executes unsafeNext(set, current).
-#define next(set, current)  (isEmpty(set) ? -1 : unsafeNext((set), (current)) ) //the builtin clz and ctz compiler functions have unexpected behavior at zero.
-
-// Returns the first element after current in the set. If there are no more elements after current, it returns -1. 
-// Unsafe because the behaviour when the set is empty is not guaranteed.
-#define unsafeNext(set, current) (__builtin_clzll(set) + (current) >= 63 ? -1 : (current) + __builtin_ctzll((set) >> ((current) + 1)) + 1)
+//  Returns the smallest element of a non-empty set.
+#define first(set) __builtin_ctzll(set)
+
+//  Returns the element of a set of size one.
+#define onlyElement(set) first(set)
+
+//  Returns the element of a set of size three, such as the neighbourhood of a
+//  vertex in a cubic graph, which is neither of its elements a and b.
+#define otherOfThree(set, a, b) \
+ onlyElement(difference((set), union(singleton(a), singleton(b))))
+
+//  Removes smallest, the smallest element of set, by clearing the lowest bit.
+#define removeSmallest(set, smallest) ((set) &= (set) - 1)
+
+//  Returns the elements of the set which are larger than start, for start
+//  between -1 and 63.
+#define elementsAfter(set, start) \
+ ((start) >= 63 ? EMPTY : (set) >> ((start) + 1) << ((start) + 1))
+
+//  Loops over all elements of the set in increasing order. The set is
+//  evaluated once, so elements removed from it in the body are still visited;
+//  use first() in a while loop for that. The outer two loops run once and only
+//  scope the copy of the set, such that break and continue work as usual.
+#define forEach(element, set) \
+ for(int element = 0, element##Once = 1; element##Once; element##Once = 0) \
+  for(bitset element##Rest = (set); element##Once; element##Once = 0) \
+   for(; !isEmpty(element##Rest) && (element = first(element##Rest), 1); \
+    removeSmallest(element##Rest, element))
+
+//  Loops over all elements of the set starting from start (not included).
+#define forEachAfterIndex(element, set, start) \
+ forEach(element, elementsAfter((set), (start)))
+
+//  Returns the first element after current in the set, or -1 if there is
+//  none.
+#define next(set, current) (isEmpty(elementsAfter((set), (current))) ? -1 : \
+ first(elementsAfter((set), (current))))
 
 //  Checks whether node is an element of set.
 #define contains(set, node) (!isEmpty(intersection((set), singleton(node))))
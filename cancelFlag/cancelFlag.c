@@ -0,0 +1,101 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cancelFlag.h"
+
+#define CANCEL_FLAG_MAGIC "FNCANCL"
+
+//  Contents of the file. raisedBy is one more than the shard which raised the
+//  flag, or 0.
+struct sharedFlag {
+    char magic[8];
+    atomic_int raisedBy;
+};
+
+struct cancelFlag {
+    int fd;
+    struct sharedFlag *shared;
+};
+
+//  The lowered flag is written next to fileName and linked to it, such that no
+//  process ever maps a partial file and a flag created by another process in
+//  the meantime is kept. Returns false on failure.
+static bool createCancelFile(const char *fileName) {
+    size_t length = strlen(fileName) + 32;
+    char temporaryName[length];
+    snprintf(temporaryName, length, "%s.%d.tmp", fileName, (int) getpid());
+    int fd = open(temporaryName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd == -1) {
+        return false;
+    }
+    struct sharedFlag lowered;
+    memset(&lowered, 0, sizeof(lowered));
+    memcpy(lowered.magic, CANCEL_FLAG_MAGIC, sizeof(lowered.magic));
+    bool isWritten = write(fd, &lowered, sizeof(lowered)) ==
+     (ssize_t) sizeof(lowered);
+    close(fd);
+    bool isLinked = isWritten &&
+     (link(temporaryName, fileName) == 0 || errno == EEXIST);
+    unlink(temporaryName);
+    return isLinked;
+}
+
+struct cancelFlag *openCancelFlag(const char *fileName) {
+    struct cancelFlag *flag = malloc(sizeof(struct cancelFlag));
+    if(flag == NULL) {
+        return NULL;
+    }
+    flag->fd = open(fileName, O_RDWR);
+    if(flag->fd == -1 && errno == ENOENT && createCancelFile(fileName)) {
+        flag->fd = open(fileName, O_RDWR);
+    }
+    if(flag->fd == -1) {
+        free(flag);
+        return NULL;
+    }
+    struct stat fileStatus;
+    if(fstat(flag->fd, &fileStatus) == -1 ||
+     (size_t) fileStatus.st_size < sizeof(struct sharedFlag)) {
+        close(flag->fd);
+        free(flag);
+        return NULL;
+    }
+    flag->shared = mmap(NULL, sizeof(struct sharedFlag),
+     PROT_READ | PROT_WRITE, MAP_SHARED, flag->fd, 0);
+    if(flag->shared == MAP_FAILED) {
+        close(flag->fd);
+        free(flag);
+        return NULL;
+    }
+    if(memcmp(flag->shared->magic, CANCEL_FLAG_MAGIC,
+     sizeof(flag->shared->magic)) != 0) {
+        closeCancelFlag(flag);
+        return NULL;
+    }
+    return flag;
+}
+
+const atomic_int *getCancelWord(struct cancelFlag *flag) {
+    return &flag->shared->raisedBy;
+}
+
+bool raiseCancelFlag(struct cancelFlag *flag, int shard) {
+    int expected = 0;
+    return atomic_compare_exchange_strong(&flag->shared->raisedBy, &expected,
+     shard + 1);
+}
+
+int getCancellingShard(struct cancelFlag *flag) {
+    return atomic_load(&flag->shared->raisedBy) - 1;
+}
+
+void closeCancelFlag(struct cancelFlag *flag) {
+    munmap(flag->shared, sizeof(struct sharedFlag));
+    close(flag->fd);
+    free(flag);
+}
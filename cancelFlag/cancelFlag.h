@@ -0,0 +1,31 @@
+#ifndef CANCEL_FLAG
+#define CANCEL_FLAG
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+//  A flag in a small memory-mapped file which is shared by all processes
+//  opening the same file. The shards of a graph checked with -s use it to stop
+//  as soon as one of them found a complementary pair of orientations.
+struct cancelFlag;
+
+//  Open the flag in fileName, creating it lowered if the file does not exist.
+//  An existing flag is never lowered, so a shard starting after another one
+//  raised it stops at once. The file has to be removed before the shards of
+//  the next graph start. Returns NULL on failure.
+struct cancelFlag *openCancelFlag(const char *fileName);
+
+//  The shared word, which is non-zero once the flag is raised. It can be
+//  polled without any locking.
+const atomic_int *getCancelWord(struct cancelFlag *flag);
+
+//  Raise the flag on behalf of shard. Returns false if another shard raised
+//  it first.
+bool raiseCancelFlag(struct cancelFlag *flag, int shard);
+
+//  The shard which raised the flag or -1 if it was not raised.
+int getCancellingShard(struct cancelFlag *flag);
+
+void closeCancelFlag(struct cancelFlag *flag);
+
+#endif
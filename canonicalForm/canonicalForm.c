@@ -0,0 +1,235 @@
+#include <stdlib.h>
+#include <string.h>
+#include "canonicalForm.h"
+
+//  Colour of a vertex followed by the sorted colours of its neighbours.
+struct vertexSignature {
+    int key[4];
+    int vertex;
+};
+
+static int compareSignatures(const void *a, const void *b) {
+    const struct vertexSignature *s1 = a;
+    const struct vertexSignature *s2 = b;
+    for(int i = 0; i < 4; i++) {
+        if(s1->key[i] != s2->key[i]) {
+            return s1->key[i] < s2->key[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+//  Give every vertex the rank of its signature as new colour. Returns the
+//  number of colours.
+static int rankSignatures(struct vertexSignature signatures[],
+ int numberOfVertices, int colour[]) {
+    qsort(signatures, numberOfVertices, sizeof(struct vertexSignature),
+     compareSignatures);
+    int numberOfColours = 0;
+    for(int i = 0; i < numberOfVertices; i++) {
+        if(i > 0 && compareSignatures(&signatures[i-1], &signatures[i])) {
+            numberOfColours++;
+        }
+        colour[signatures[i].vertex] = numberOfColours;
+    }
+    return numberOfColours + 1;
+}
+
+//  Split colour classes according to the colours of the neighbours until the
+//  colouring is equitable. Since ranks are used as colours the result only
+//  depends on the isomorphism class of the coloured graph.
+static int refineColouring(bitset adjacencyList[], int numberOfVertices,
+ int colour[], int numberOfColours) {
+    struct vertexSignature signatures[numberOfVertices];
+    while(numberOfColours < numberOfVertices) {
+        for(int v = 0; v < numberOfVertices; v++) {
+            int *key = signatures[v].key;
+            signatures[v].vertex = v;
+            key[0] = colour[v];
+            int k = 1;
+            forEach(nbr, adjacencyList[v]) {
+                key[k++] = colour[nbr];
+            }
+
+            //  Sort the three neighbour colours.
+            for(int i = 1; i < 4; i++) {
+                for(int j = i; j > 1 && key[j-1] > key[j]; j--) {
+                    int tmp = key[j];
+                    key[j] = key[j-1];
+                    key[j-1] = tmp;
+                }
+            }
+        }
+        int newNumberOfColours = rankSignatures(signatures, numberOfVertices,
+         colour);
+        if(newNumberOfColours == numberOfColours) {
+            break;
+        }
+        numberOfColours = newNumberOfColours;
+    }
+    return numberOfColours;
+}
+
+struct labellingSearch {
+    bitset *adjacencyList;
+    int numberOfVertices;
+    long long unsigned int maxLeaves;
+    long long unsigned int leaves;
+
+    //  Whether a node was left unexplored because maxLeaves leaves were found.
+    bool truncated;
+    int *firstCode;
+    struct canonicalForm *form;
+};
+
+//  Code of the graph relabelled by a discrete colouring.
+static void getCode(bitset adjacencyList[], int numberOfVertices, int colour[],
+ int code[]) {
+    for(int v = 0; v < numberOfVertices; v++) {
+        int *labels = &code[3*colour[v]];
+        int k = 0;
+        forEach(nbr, adjacencyList[v]) {
+            labels[k++] = colour[nbr];
+        }
+        for(int i = 1; i < 3; i++) {
+            for(int j = i; j > 0 && labels[j-1] > labels[j]; j--) {
+                int tmp = labels[j];
+                labels[j] = labels[j-1];
+                labels[j-1] = tmp;
+            }
+        }
+    }
+}
+
+//  Individualization-refinement tree. The canonical labelling is the leaf with
+//  the smallest code. Every automorphism maps the first leaf to a leaf with the
+//  same code and vice versa, so counting these leaves gives the order of the
+//  automorphism group.
+static void searchLabellings(struct labellingSearch *search, int colour[],
+ int numberOfColours) {
+    int numberOfVertices = search->numberOfVertices;
+    if(search->leaves >= search->maxLeaves) {
+        search->truncated = true;
+        return;
+    }
+
+    //  Discrete colouring: compare relabelled graph to the first and to the
+    //  smallest leaf.
+    if(numberOfColours == numberOfVertices) {
+        struct canonicalForm *form = search->form;
+        size_t codeSize = sizeof(int)*3*numberOfVertices;
+        int code[3*numberOfVertices];
+        getCode(search->adjacencyList, numberOfVertices, colour, code);
+        if(search->leaves++ == 0) {
+            memcpy(search->firstCode, code, codeSize);
+            memcpy(form->code, code, codeSize);
+            memcpy(form->labelling, colour, sizeof(int)*numberOfVertices);
+            form->automorphisms = 1;
+            return;
+        }
+        if(memcmp(code, search->firstCode, codeSize) == 0) {
+            form->automorphisms++;
+        }
+        if(memcmp(code, form->code, codeSize) < 0) {
+            memcpy(form->code, code, codeSize);
+            memcpy(form->labelling, colour, sizeof(int)*numberOfVertices);
+        }
+        return;
+    }
+
+    //  Branch on every vertex of the first non-trivial colour class.
+    int colourClassSize[numberOfColours];
+    for(int i = 0; i < numberOfColours; i++) {
+        colourClassSize[i] = 0;
+    }
+    for(int v = 0; v < numberOfVertices; v++) {
+        colourClassSize[colour[v]]++;
+    }
+    int targetColour = 0;
+    for(int i = numberOfColours - 1; i >= 0; i--) {
+        if(colourClassSize[i] > 1) {
+            targetColour = i;
+        }
+    }
+    struct vertexSignature signatures[numberOfVertices];
+    int childColour[numberOfVertices];
+    for(int v = 0; v < numberOfVertices; v++) {
+        if(colour[v] != targetColour) {
+            continue;
+        }
+        for(int u = 0; u < numberOfVertices; u++) {
+            signatures[u] = (struct vertexSignature)
+             {.key = {colour[u], u != v, 0, 0}, .vertex = u};
+        }
+        int numberOfChildColours = rankSignatures(signatures, numberOfVertices,
+         childColour);
+        numberOfChildColours = refineColouring(search->adjacencyList,
+         numberOfVertices, childColour, numberOfChildColours);
+        searchLabellings(search, childColour, numberOfChildColours);
+    }
+}
+
+//  Mix the code into a 64-bit value starting from seed.
+static uint64_t hashCode(int code[], int length, uint64_t seed) {
+    uint64_t hash = seed;
+    for(int i = 0; i < length; i++) {
+        hash ^= (uint64_t) code[i];
+        hash *= 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    hash ^= hash >> 32;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    return hash ^ (hash >> 31);
+}
+
+bool computeCanonicalForm(bitset adjacencyList[], int numberOfVertices,
+ long long unsigned int maxLeaves, struct canonicalForm *form) {
+    form->numberOfVertices = numberOfVertices;
+    form->automorphisms = 1;
+    for(int i = 0; i < numberOfVertices; i++) {
+        if(size(adjacencyList[i]) != 3) {
+            return false;
+        }
+    }
+
+    int firstCode[3*numberOfVertices];
+    struct labellingSearch search = {.adjacencyList = adjacencyList,
+     .numberOfVertices = numberOfVertices, .maxLeaves = maxLeaves,
+     .firstCode = firstCode, .form = form};
+    int colour[numberOfVertices];
+    for(int i = 0; i < numberOfVertices; i++) {
+        colour[i] = 0;
+    }
+    searchLabellings(&search, colour,
+     refineColouring(adjacencyList, numberOfVertices, colour, 1));
+    if(search.truncated) {
+        return false;
+    }
+
+    form->hash[0] = hashCode(form->code, 3*numberOfVertices,
+     0xcbf29ce484222325ULL ^ numberOfVertices);
+    form->hash[1] = hashCode(form->code, 3*numberOfVertices,
+     0x84222325cbf29ce4ULL + numberOfVertices);
+    return true;
+}
+
+void numberEdgesCanonically(struct canonicalForm *form, int numberOfVertices,
+ int edgeNumbering[][numberOfVertices]) {
+    int vertexWithLabel[numberOfVertices];
+    for(int v = 0; v < numberOfVertices; v++) {
+        vertexWithLabel[form->labelling[v]] = v;
+    }
+    int counter = 0;
+    for(int i = 0; i < numberOfVertices; i++) {
+        for(int k = 0; k < 3; k++) {
+            int j = form->code[3*i + k];
+            if(j > i) {
+                int u = vertexWithLabel[i];
+                int v = vertexWithLabel[j];
+                edgeNumbering[u][v] = counter;
+                edgeNumbering[v][u] = counter;
+                counter++;
+            }
+        }
+    }
+}
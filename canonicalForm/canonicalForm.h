@@ -0,0 +1,40 @@
+#ifndef CANONICAL_FORM
+#define CANONICAL_FORM
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../bitset.h"
+
+//  Canonical labelling of a cubic graph. Two cubic graphs are isomorphic if
+//  and only if they have the same code.
+struct canonicalForm {
+    int numberOfVertices;
+
+    //  labelling[v] is the canonical label of vertex v.
+    int labelling[MAXVERTICES];
+
+    //  The sorted canonical labels of the three neighbours of every vertex, in
+    //  order of canonical label.
+    int code[3*MAXVERTICES];
+
+    //  Order of the automorphism group.
+    long long unsigned int automorphisms;
+
+    //  Hash of the code.
+    uint64_t hash[2];
+};
+
+//  Compute the canonical form using an individualization-refinement search
+//  tree. Returns false if the graph is not cubic or if the search tree has more
+//  than maxLeaves leaves. In the latter case only form->automorphisms is set
+//  and it is a lower bound.
+bool computeCanonicalForm(bitset adjacencyList[], int numberOfVertices,
+ long long unsigned int maxLeaves, struct canonicalForm *form);
+
+//  Number the edges from 0 to 3n/2 - 1 in the order in which they appear in the
+//  canonical code. The number of edge uv is stored in edgeNumbering[u][v]
+//  where u and v are the original labels.
+void numberEdgesCanonically(struct canonicalForm *form, int numberOfVertices,
+ int edgeNumbering[][numberOfVertices]);
+
+#endif
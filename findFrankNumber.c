@@ -6,7 +6,13 @@
  */
 
 #define USAGE \
-"\nUsage: `./findFrankNumber [-2|-e] [-b] [-c] [-d] [-h] [-p] [-s] [-v] [res/mod]`\n"
+"\nUsage: `./findFrankNumber [-2|-e] [-b] [-c] [-d] [-h] [-p] [-s] [-t #] [-v]\
+ [-w #] [--budget-ms=# --deferred=FILE] [--cache=FILE] [--cancel-file=FILE]\
+ [--dedup] [--gray-code] [--stats[=json]]\
+ [--hardware-counters] [--search-profile=FILE] [--trace=FILE]\
+ [--progress[=#]] [--progress-file=FILE]\
+ [--serve=SOCKET [--max-request=#] [--timeout=#]] [--coordinate=ADDRESS [--chunk-size=#]]\
+ [--work-for=ADDRESS] [res/mod]`\n"
 #define HELPTEXT \
 "Filter 3-edge-connected cubic graphs having Frank number 2.\n\
 Unless option -e is present, correct output is only guaranteed if the graphs\n\
@@ -25,22 +31,97 @@ The order in which the arguments appear does not matter.\n\
                                  for cyclically 4-edge-connected graphs\n\
   -b, --brute-force             Whenever a graph is checked using the exact\n\
                                  algorithm apply a brute force method instead\n\
+      --budget-ms=#             Stop checking a graph after # milliseconds\n\
+                                 and write it to the file given by\n\
+                                 --deferred instead of to stdout, such that\n\
+                                 it can be checked in a later run\n\
+      --cache=FILE              Look up the result of every graph in the\n\
+                                 memory-mapped cache FILE before computing\n\
+                                 it and store it afterwards; Isomorphic\n\
+                                 graphs share an entry; FILE is created if\n\
+                                 it does not exist\n\
+      --cancel-file=FILE        With -s, stop as soon as one of the shards\n\
+                                 using the same FILE found that the graph\n\
+                                 has Frank number 2; The other shards exit\n\
+                                 with status 3 without output; FILE is\n\
+                                 created if it does not exist and has to be\n\
+                                 removed before checking the next graph\n\
+      --chunk-size=#            With --coordinate, lease # consecutive graphs\n\
+                                 at a time; Default is 64\n\
   -c, --complement              Reverse output of the graphs, i.e. output all\n\
                                  graphs which would not be output without this\n\
                                  flag and do not output those which would\n\
+      --coordinate=ADDRESS      Do not check the graphs but lease them in\n\
+                                 chunks to worker processes started with\n\
+                                 --work-for=ADDRESS; A chunk is leased again\n\
+                                 if its worker is lost; ADDRESS is a Unix\n\
+                                 domain socket or host:port for TCP\n\
   -d, --double-check            Whenever a graph passes the sufficient\n\
                                  condition, double check the result by\n\
                                  computing the corresponding orientations\n\
+      --dedup                   Compute the result only once for isomorphic\n\
+                                 graphs in the input\n\
+      --deferred=FILE           With --budget-ms, the file receiving the\n\
+                                 graphs which exceeded the budget\n\
   -e, --only-exact              Only perform the exact algorithm and not the\n\
                                  heuristic one; This flag needs to be present\n\
                                  for graphs which are not cyclically\n\
                                  4-edge-connected\n\
+      --gray-code               Let the exact algorithm generate the\n\
+                                 orientations in Gray code order, such that\n\
+                                 consecutive ones differ in few edges and\n\
+                                 their deletable edges are updated faster\n\
+      --hardware-counters       With --stats, which it implies, also count\n\
+                                 cycles, instructions, branch misses and L1\n\
+                                 and last level cache misses per phase and\n\
+                                 per number of vertices using\n\
+                                 perf_event_open\n\
   -h, --help                    Print this help text\n\
+      --max-request=#           With --serve, close the connection of clients\n\
+                                 sending requests of more than # bytes;\n\
+                                 Default is 1048576\n\
   -p, --print-orientation       Print the two orientations for graphs\n\
                                  determined to have Frank number 2\n\
+      --progress[=#]            Every # seconds (default 60) and when\n\
+                                 receiving SIGUSR1, write the number of\n\
+                                 graphs checked, the rate, the ETA if stdin\n\
+                                 is a file, the fraction of graphs decided\n\
+                                 by the heuristic and the slowest graph so\n\
+                                 far to stderr\n\
+      --progress-file=FILE      Write the progress reports to FILE in the\n\
+                                 Prometheus textfile format instead\n\
   -s, --single-graph-parallel   Parallellize the computation of the exact\n\
                                  method for a single graph; Use with res/mod\n\
+      --search-profile=FILE     Write the number of nodes, pruned branches\n\
+                                 and backtracks per depth of the search trees\n\
+                                 of the exact algorithm to FILE as CSV; Needs\n\
+                                 a build with make searchprofile; Implies\n\
+                                 one thread\n\
+      --serve=SOCKET            Do not read stdin but answer requests of\n\
+                                 clients connecting to the Unix domain socket\n\
+                                 SOCKET using the number of threads given by\n\
+                                 -t; See README.md for the protocol\n\
+      --stats[=FORMAT]          Time the phases of checking every graph and\n\
+                                 write a summary with latency histograms and\n\
+                                 the slowest graphs to stderr at the end;\n\
+                                 FORMAT is text (default) or json\n\
+  -t, --threads=#               Check the graphs using # threads; Graphs are\n\
+                                 read ahead and of those the graphs which are\n\
+                                 expected to be hardest are started first;\n\
+                                 Output order is unchanged\n\
+      --timeout=#               With --serve, stop working on a request after\n\
+                                 # milliseconds; Graphs which were not\n\
+                                 finished by then are reported as timeout\n\
+      --trace=FILE              Write a timeline with a span for every graph\n\
+                                 and phase per thread to FILE in the Chrome\n\
+                                 trace event format\n\
   -v, --verbose                 Give more detailed output\n\
+      --work-for=ADDRESS        Check chunks of graphs leased by the\n\
+                                 coordinator at ADDRESS using one connection\n\
+                                 per thread given by -t; The algorithm is\n\
+                                 chosen by the coordinator\n\
+  -w, --window=#                Number of graphs read ahead when using more\n\
+                                 than one thread; Default is 256\n\
   res/mod                       Split the generation in mod (not necessarily\n\
                                  equally big) parts; Here part res will be\n\
                                  executed\n\
@@ -51,25 +132,25 @@ The order in which the arguments appear does not matter.\n\
 #include <getopt.h>
 #include <time.h>
 #include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netdb.h>
 #include "readGraph/readGraph6.h"
+#include "graphFeatures/graphFeatures.h"
+#include "canonicalForm/canonicalForm.h"
+#include "resultCache/resultCache.h"
+#include "cancelFlag/cancelFlag.h"
+#include "runStats/runStats.h"
+#include "hardwareCounters/hardwareCounters.h"
+#include "traceEvents/traceEvents.h"
+#include "progress/progress.h"
+#include "frankNumber/frankNumber.h"
 #include "bitset.h"
 
-struct counters {
-    long long unsigned int generatedOrientations;
-    long long unsigned int mostGeneratedOrientations;
-    long long unsigned int storedBitsets;
-    long long unsigned int mostStoredBitsets;
-    long long unsigned int orientationsGivingSubset;
-    long long unsigned int orientationsGivingSuperset;
-    long long unsigned int emptyBitsetsStored;
-    long long unsigned int complementaryBitsets;
-    long long unsigned int graphsSatisfyingOddnessCondition;
-    long long unsigned int graphsNotSatisfyingOddnessCondition;
-    long long unsigned int graphsSatisfyingFirstOddness;
-    long long unsigned int graphsSatisfyingSecondOddness;
-    long long unsigned int totalOrientationsGenerated;
-};
-
 struct options {
     bool bruteForceFlag;
     bool complementFlag;
@@ -79,109 +160,61 @@ struct options {
     bool verboseFlag;
     bool printFlag;
     bool singleGraphFlag;
+    bool grayCodeFlag;
     int modulo;
     int remainder;
-    unsigned long long int sizeOfArray;
+    int numberOfThreads;
+    int windowSize;
+    struct resultCache *cache;
+
+    //  With --stats, the timings of all graphs are collected in stats and
+    //  timing receives those of the graph this thread is working on.
+    struct runStats *stats;
+    struct graphTiming *timing;
+
+    //  With --hardware-counters, the counters of this thread and the start of
+    //  the phases of the library which are in progress.
+    bool hardwareCountersFlag;
+    struct hardwareCounters *counters;
+    struct phaseStart libraryPhaseStarts[FN_NUMBER_OF_PHASES];
+
+    //  With --trace, the spans of this thread are recorded in trace, which
+    //  belongs to traceFile.
+    struct traceFile *traceFile;
+    struct traceBuffer *trace;
+    long long unsigned int traceStarts[FN_NUMBER_OF_PHASES];
+
+    //  With --search-profile, the search tree profile of every graph checked
+    //  by the exact algorithm is appended to this file.
+    FILE *searchProfile;
+
+    //  With --progress or --progress-file, shared by all threads.
+    struct progress *progress;
+
+    //  With --budget-ms, the check of a graph is aborted after budget
+    //  milliseconds and the graph is written to deferred instead.
+    long int budget;
+    FILE *deferred;
 };
 
-//******************************************************************************
-//
-//                          Dynamic arrays
-//
-//******************************************************************************
-
-typedef struct {
-  bitset *array;
-  size_t used;
-  size_t size;
-} Array;
-
-void initArray(Array *a, size_t initialSize) {
-  a->array = malloc(initialSize * sizeof(bitset));
-  if(a->array == NULL) {
-    fprintf(stderr, "Error: out of memory\n");
-    exit(1);
-  }
-  a->used = 0;
-  a->size = initialSize;
+//  Start of a span of the trace of this thread, 0 without --trace.
+long long unsigned int startSpan(struct options *options) {
+    return options->trace != NULL ? getTraceTime() : 0;
 }
 
-// Double arraysize when too big.
-void insertArray(Array *a, bitset element) {
-  if (a->used == a->size) {
-    a->size *= 2;
-    a->array = realloc(a->array, a->size * sizeof(bitset));
-    if(a->array == NULL) {
-        fprintf(stderr, "Error: out of memory\n");
-        exit(1);
+void endSpan(struct options *options, const char *name,
+ long long unsigned int start, const char *graphString) {
+    if(options->trace != NULL) {
+        addSpan(options->trace, name, start, getTraceTime(), graphString);
     }
-  }
-  a->array[a->used++] = element;
-}
-
-void insertArrayAtPos(Array *a, bitset element, size_t index) {
-    if (index > a->size) {
-        fprintf(stderr, "Error: index does not lie in the array.\n");
-        exit(1);
-    }
-  a->array[index] = element;
-}
-
-void freeArray(Array *a) {
-  free(a->array);
-  a->array = NULL;
-  a->used = a->size = 0;
 }
 
 //******************************************************************************
 //
-//                          Digraphs
+//                              Printing
 //
 //******************************************************************************
 
-// Digraph structure containing bitset representations.
-struct diGraph {
-    int numberOfVertices;
-    bitset* adjacencyList;
-    bitset* reverseAdjacencyList;
-    int numberOfArcs;
-}; 
-
-//  Initializer for empty graph.
-#define emptyGraph(g) {\
- (g)->numberOfArcs = 0;\
- for(int i = 0; i < (g)->numberOfVertices; i++) {\
-    (g)->adjacencyList[i] = EMPTY;\
-    (g)->reverseAdjacencyList[i] = EMPTY;\
- }\
-}
-
-//  Add one directed edge. numberOfArcs will be incorrect if adding existing
-//  arc.
-#define addArc(g,i,j) {\
- add((g)->adjacencyList[i], j); (g)->numberOfArcs++;\
- add((g)->reverseAdjacencyList[j], i);\
-}
-
-//  Remove one undirected edge. numberOfArcs will be incorrect if removing
-//  non-existing arc.
-#define removeArc(g,i,j) {\
- removeElement((g)->adjacencyList[i], j);(g)->numberOfArcs--;\
- removeElement((g)->reverseAdjacencyList[j], i);\
-}
-
-//  Print adjacency list of digraph.
-void printDiGraph(struct diGraph *g) {
-    for(int i = 0; i < g->numberOfVertices; i++) {
-        fprintf(stderr, "%d:", i);
-        forEach(nbr, g->adjacencyList[i]) {
-            fprintf(stderr, " %d", nbr);
-        }
-        fprintf(stderr, "\n");
-    }
-    fprintf(stderr,"\n");   
-}
-
 //  Print adjacency list.
 void printGraph(bitset adjacencyList[], int numberOfVertices) {
     for(int i = 0; i < numberOfVertices; i++) {
@@ -196,1335 +229,1942 @@ void printGraph(bitset adjacencyList[], int numberOfVertices) {
 
 //******************************************************************************
 //
-//                         Strong connectivity check
+//                              Result cache
 //
 //******************************************************************************
 
-void visit(struct diGraph *g, int vertexToVisit, bitset *unvisitedVertices,
- int L[], int *lengthOfL) {
-    if(!contains(*unvisitedVertices, vertexToVisit)) {
-        return;
+//  Graphs whose canonical labelling needs a larger search tree are not looked
+//  up in the cache.
+#define CANONICAL_FORM_MAX_LEAVES 100000
+
+enum cacheMode getCacheMode(struct options *options) {
+    if(!options->exhaustiveCheckFlag) {
+        return CACHE_MODE_HEURISTIC;
     }
-    removeElement(*unvisitedVertices, vertexToVisit);
-    forEach(outNeighbour, g->adjacencyList[vertexToVisit]) {
-        visit(g, outNeighbour, unvisitedVertices, L, lengthOfL);
+    if(!options->oddCyclesHeuristicFlag) {
+        return CACHE_MODE_EXACT;
     }
-    L[*lengthOfL] = vertexToVisit;
-    (*lengthOfL)++;
+    return CACHE_MODE_DEFAULT;
 }
 
-void assign(struct diGraph *g, int vertex, bitset *assignedVertices) {
-    if(contains(*assignedVertices, vertex)) {
+//  Store the edge directions of both orientations of the certificate in the
+//  order of the canonical code.
+void encodeCertificate(int adjacency[][3], int numberOfVertices,
+ struct canonicalForm *form, struct fn_result *result,
+ struct cacheEntry *entry) {
+    memset(entry->certificate, 0, sizeof(entry->certificate));
+    entry->hasCertificate = result->hasCertificate &&
+     3*numberOfVertices/2 <= 64*CERTIFICATE_WORDS;
+    if(!entry->hasCertificate) {
         return;
     }
-    add(*assignedVertices, vertex);
-    forEach(inNeighbour, g->reverseAdjacencyList[vertex]) {
-        assign(g, inNeighbour, assignedVertices);
+    int edgeNumbering[numberOfVertices][numberOfVertices];
+    numberEdgesCanonically(form, numberOfVertices, edgeNumbering);
+    for(int v = 0; v < numberOfVertices; v++) {
+        for(int i = 0; i < 3; i++) {
+            int w = adjacency[v][i];
+            if(w < v) {
+                continue;
+            }
+            int edge = edgeNumbering[v][w];
+            bool increasing = form->labelling[v] < form->labelling[w];
+            for(int k = 0; k < 2; k++) {
+                if(result->orientation[k][v][i] == increasing) {
+                    entry->certificate[k][edge/64] |= 1ULL << (edge%64);
+                }
+            }
+        }
     }
 }
 
-bool isStronglyConnected(struct diGraph *g) {
-    bitset unvisitedVertices = complement(EMPTY, g->numberOfVertices);
-    int L[g->numberOfVertices];
-    int lengthOfL = 0;
-    for(int i = 0; i < g->numberOfVertices ; i++) {
-        visit(g, i, &unvisitedVertices, L, &lengthOfL);
+void decodeCertificate(int adjacency[][3], int numberOfVertices,
+ struct canonicalForm *form, struct cacheEntry *entry,
+ bool (*orientation[2])[3]) {
+    int edgeNumbering[numberOfVertices][numberOfVertices];
+    numberEdgesCanonically(form, numberOfVertices, edgeNumbering);
+    for(int v = 0; v < numberOfVertices; v++) {
+        for(int i = 0; i < 3; i++) {
+            int w = adjacency[v][i];
+            int edge = edgeNumbering[v][w];
+            bool increasing = form->labelling[v] < form->labelling[w];
+            for(int k = 0; k < 2; k++) {
+                bool bit = (entry->certificate[k][edge/64] >> (edge%64)) & 1;
+                orientation[k][v][i] = bit == increasing;
+            }
+        }
     }
-    bitset assignedVertices = EMPTY;
-    assign(g, L[lengthOfL-1], &assignedVertices);
+}
 
-    return size(assignedVertices) == g->numberOfVertices;
+//  Look up the graph in the cache. If the exact algorithm will be used, an
+//  entry computed using only the exact algorithm can be used as well.
+bool lookupFrankNumber(struct options *options, struct cacheEntry *entry) {
+    if(lookupResult(options->cache, entry)) {
+        return true;
+    }
+    if(entry->mode == CACHE_MODE_DEFAULT) {
+        entry->mode = CACHE_MODE_EXACT;
+        if(lookupResult(options->cache, entry)) {
+            return true;
+        }
+        entry->mode = CACHE_MODE_DEFAULT;
+    }
+    return false;
 }
+
 //******************************************************************************
 //
-//                     Deletable edges
+//                          Checking a single graph
 //
 //******************************************************************************
 
-//  Give all edges a graph an index from 0 to |E(G)| - 1 and store in matrix
-//  edgeIndices.
-void numberEdges(bitset adjacencyList[], int numberOfVertices,
- int edgeIndices[][numberOfVertices]) {
-    int counter = 0;
-    for(int i = 0; i < numberOfVertices; i++) {
-        forEachAfterIndex(nbr, adjacencyList[i], i) {
-            edgeIndices[i][nbr] = counter;
-            edgeIndices[nbr][i] = counter;
-            counter++;
+//  Parse graphString into adjacencyList. Returns the number of vertices or -1
+//  if the graph needs to be skipped.
+int parseGraph(char *graphString, struct options *options,
+ bitset adjacencyList[]) {
+    int numberOfVertices = getNumberOfVertices(graphString);
+    if(numberOfVertices == -1 || numberOfVertices > MAXVERTICES) {
+        if(options->verboseFlag){
+            fprintf(stderr, "Skipping invalid graph!\n");
         }
+        return -1;
     }
+
+    //  The library stores sets of edges in a bitset of its own, the number of
+    //  edges in a cubic graph (3*n/2) may not exceed its width unless only the
+    //  heuristic algorithm is used.
+    int maxVertices = options->exhaustiveCheckFlag ||
+     options->doublecheckFlag ? fn_max_vertices() :
+     fn_max_heuristic_vertices();
+    if(numberOfVertices > maxVertices) {
+        if(options->verboseFlag){
+            fprintf(stderr, "Skipping invalid graph! Too many edges.\n");
+        }
+        return -1;
+    }
+    if(loadGraph(graphString, numberOfVertices, adjacencyList) == -1) {
+        if(options->verboseFlag){
+            fprintf(stderr, "Skipping invalid graph!\n");
+        }
+        return -1;
+    }
+    return numberOfVertices;
 }
 
-//  Used for checking if edge is deletable.
-bool containsDirectedPathBetween(struct diGraph *orientation,
- bitset unvisitedVertices, int i, int end) {
+//  Decode graphString into adjacencyList, which should have room for
+//  MAXVERTICES bitsets. Returns the number of vertices or -1 if the graph
+//  needs to be skipped.
+int decodeGraph(char *graphString, struct options *options,
+ bitset adjacencyList[]) {
+    struct phaseStart start;
+    long long unsigned int spanStart = startSpan(options);
+    startPhase(options->timing, &start);
+    int numberOfVertices = parseGraph(graphString, options, adjacencyList);
+    endPhase(options->timing, &start, DECODE_PHASE);
+    endSpan(options, "decode", spanStart, NULL);
+    if(numberOfVertices == -1) {
+        return -1;
+    }
+    if(options->timing != NULL) {
+        options->timing->numberOfVertices = numberOfVertices;
+    }
+
+    startPhase(options->timing, &start);
+    bool isCubic = true;
+    for(int i = 0; i < numberOfVertices && isCubic; i++) {
+        isCubic = size(adjacencyList[i]) == 3;
+    }
+    endPhase(options->timing, &start, VALIDATION_PHASE);
+    if(!isCubic) {
+        if(options->verboseFlag){
+            fprintf(stderr, "Skipping invalid graph! Not cubic.\n");
+        }
+        return -1;
+    }
+    return numberOfVertices;
+}
 
-    if(contains(orientation->adjacencyList[i], end)) {
-        return true;
+//  Translate the options to flags of fn_check().
+int getCheckFlags(struct options *options, bool wantsCertificate) {
+    int flags = 0;
+    if(!options->exhaustiveCheckFlag) {
+        flags |= FN_ONLY_HEURISTIC;
     }
-    removeElement(unvisitedVertices, i);
-    forEach(element, intersection(orientation->adjacencyList[i],
-     unvisitedVertices)) {
-        if(containsDirectedPathBetween(orientation, unvisitedVertices, element,
-         end)) {
-            return true;
-        }
+    if(!options->oddCyclesHeuristicFlag) {
+        flags |= FN_ONLY_EXACT;
     }
-    return false;
+    if(options->bruteForceFlag) {
+        flags |= FN_BRUTE_FORCE;
+    }
+    if(options->doublecheckFlag) {
+        flags |= FN_DOUBLE_CHECK;
+    }
+    if(options->verboseFlag) {
+        flags |= FN_VERBOSE;
+    }
+    if(options->printFlag) {
+        flags |= FN_PRINT_ORIENTATIONS;
+    }
+    if(options->grayCodeFlag) {
+        flags |= FN_GRAY_CODE;
+    }
+    if(wantsCertificate) {
+        flags |= FN_CERTIFICATE;
+    }
+    if(options->timing != NULL) {
+        flags |= FN_TIMING;
+    }
+    return flags;
 }
 
-//  We assume that the given orientation is strongly connected.
-bitset getDeletableEdges(struct diGraph *orientation, int numberOfVertices,
- int edgeNumbering[][numberOfVertices]) {
+static const enum statsPhase libraryPhases[FN_NUMBER_OF_PHASES] = {
+    [FN_PHASE_VALIDATION] = VALIDATION_PHASE,
+    [FN_PHASE_SUFFICIENT_CONDITION] = SUFFICIENT_CONDITION_PHASE,
+    [FN_PHASE_ORIENTATIONS] = ORIENTATIONS_PHASE,
+    [FN_PHASE_DELETABLE_EDGES] = DELETABLE_EDGES_PHASE,
+    [FN_PHASE_COMPLEMENTARY_ORIENTATION] = COMPLEMENTARY_ORIENTATION_PHASE
+};
 
-    bitset deletableEdges = EMPTY;
+//  Add the phases timed by the library to those of the graph.
+void addLibraryTiming(struct graphTiming *timing,
+ const struct fn_timing *libraryTiming) {
+    for(int i = 0; i < FN_NUMBER_OF_PHASES; i++) {
+        timing->wallSeconds[libraryPhases[i]] += libraryTiming->wallSeconds[i];
+        timing->cpuSeconds[libraryPhases[i]] += libraryTiming->cpuSeconds[i];
+        timing->calls[libraryPhases[i]] += libraryTiming->calls[i];
+    }
+}
 
-    for(int i = 0; i < numberOfVertices; i++) {
-        forEach(nbr, orientation->adjacencyList[i]) {
-            removeArc(orientation, i, nbr);
-            if(containsDirectedPathBetween(orientation,
-             complement(EMPTY, numberOfVertices), i, nbr)) {
-                add(deletableEdges, edgeNumbering[i][nbr]);
-            }
-            addArc(orientation, i, nbr);
+//  Names of the phases of the library shown in the trace. The other phases
+//  are not traced. The complementary orientation phase is entered for every
+//  strong orientation, so only the searches taking at least
+//  MIN_COMPLEMENT_SPAN nanoseconds are traced.
+static const char *tracedLibraryPhases[FN_NUMBER_OF_PHASES] = {
+    [FN_PHASE_SUFFICIENT_CONDITION] = "heuristic",
+    [FN_PHASE_ORIENTATIONS] = "exact",
+    [FN_PHASE_COMPLEMENTARY_ORIENTATION] = "complement"
+};
+
+#define MIN_COMPLEMENT_SPAN 10000
+
+//  Phase hook of the library which counts the hardware events of its phases
+//  and adds them to the trace. data points to the options of the thread.
+void handleLibraryPhase(void *data, enum fn_phase phase, bool end) {
+    struct options *options = data;
+    bool isTraced = options->trace != NULL &&
+     tracedLibraryPhases[phase] != NULL;
+    if(!end) {
+        startEvents(options->timing, &options->libraryPhaseStarts[phase]);
+        if(isTraced) {
+            options->traceStarts[phase] = getTraceTime();
+        }
+        return;
+    }
+    if(options->timing != NULL) {
+        endEvents(options->timing, &options->libraryPhaseStarts[phase],
+         libraryPhases[phase]);
+    }
+    if(isTraced) {
+        long long unsigned int now = getTraceTime();
+        if(phase != FN_PHASE_COMPLEMENTARY_ORIENTATION ||
+         now - options->traceStarts[phase] >= MIN_COMPLEMENT_SPAN) {
+            addSpan(options->trace, tracedLibraryPhases[phase],
+             options->traceStarts[phase], now, NULL);
         }
     }
-
-    return deletableEdges;
 }
 
-void printDeletableEdges(int numberOfVertices,
- int edgeNumbering[][numberOfVertices], bitset orientation[], 
- bitset deletableEdges) {
-    fprintf(stderr, "Deletable edges: ");
-    for(int i = 0; i < numberOfVertices; i++) {
-        forEach(nbr, orientation[i]) {
-            if(contains(deletableEdges,edgeNumbering[i][nbr])) {
-                fprintf(stderr, "%d--%d ", i, nbr);
+//  Write the rows of the search tree profile of a graph in which something
+//  happened as CSV.
+void writeSearchProfile(FILE *file, char *graphString,
+ const struct fn_search_profile *profile) {
+    static const char *searches[FN_NUMBER_OF_SEARCHES] = {
+     [FN_SEARCH_ORIENTATIONS] = "orientations",
+     [FN_SEARCH_COMPLEMENTARY_ORIENTATION] = "complementary"};
+    int length = (int) strcspn(graphString, "\r\n");
+    for(int i = 0; i < FN_NUMBER_OF_SEARCHES; i++) {
+        for(int depth = 0; depth < profile->numberOfDepths; depth++) {
+            const struct fn_search_depth *counts = &profile->depth[i][depth];
+            if(counts->nodes == 0) {
+                continue;
+            }
+            fprintf(file, "%.*s,%s,%d,%llu", length, graphString, searches[i],
+             depth, counts->nodes);
+            for(int reason = 0; reason < FN_NUMBER_OF_PRUNE_REASONS; reason++) {
+                fprintf(file, ",%llu", counts->pruned[reason]);
             }
+            fprintf(file, ",%llu\n", counts->backtracks);
         }
     }
-    fprintf(stderr, "\n");
 }
 
-//******************************************************************************
-//
-//                          Exact algorithm
-//
-//******************************************************************************
-
-#define isSubset(set1, set2) equals((set1), intersection((set1),(set2))) 
-
-// Brute force approach
-int getIntermediateFrankNumber(struct options *options,
- struct counters *numberOf, int numberOfVertices,
- int edgeNumbering[][numberOfVertices], Array *bitsetsOfDeletableEdges,
- bitset deletableEdges) {
+//  The neighbours of every vertex in increasing order.
+void getNeighbourTriples(bitset adjacencyList[], int numberOfVertices,
+ int adjacency[][3]) {
+    for(int v = 0; v < numberOfVertices; v++) {
+        int i = 0;
+        forEach(w, adjacencyList[v]) {
+            adjacency[v][i++] = w;
+        }
+    }
+}
 
-    size_t insertPosition = bitsetsOfDeletableEdges->used;
-    bitset bitsetContainingAllEdges = complement(EMPTY, 3*numberOfVertices/2);
-    bitset *array = bitsetsOfDeletableEdges->array;
+//  With --budget-ms, give the context a deadline for a graph whose check
+//  starts now.
+void setBudgetDeadline(struct options *options, struct fn_context *context) {
+    if(options->budget == 0) {
+        return;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += options->budget / 1000;
+    deadline.tv_nsec += (options->budget % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    fn_context_set_deadline(context, &deadline);
+}
 
-    // Check if Frank number is 2
-    for(size_t i = 0; i < bitsetsOfDeletableEdges->used; i++) {
+//  Outcome of checkGraph() for callers which need more than the Frank number.
+struct checkOutcome {
+    bool wantsCertificate;
+    bool aborted;
+    bool cancelled;
+    bool hasCertificate;
+    bool orientation[2][MAXVERTICES][3];
+};
 
-        if(!isEmpty(array[i])) {
+//  Returns 2 if the graph is determined to have Frank number 2 and 0
+//  otherwise. If a cache is used, the result is looked up first and stored
+//  afterwards. If outcome is not NULL, it tells whether the deadline of the
+//  context passed or its cancel flag was raised and it receives the
+//  certificate if asked for.
+int checkGraph(char *graphString, bitset adjacencyList[], int numberOfVertices,
+ struct options *options, struct fn_context *context,
+ long long unsigned int *cachedResults, struct checkOutcome *outcome) {
+    long long unsigned int spanStart = startSpan(options);
+    struct timespec start;
+    bool triedHeuristic = false;
+    bool heuristicSucceeded = false;
+    if(options->progress != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+    }
+    if(options->verboseFlag) {
+        fprintf(stderr, "Looking at:\n%s", graphString);
+    }
 
-            //  If the deletable edges of new orientation is a subset of older
-            //  we can dismiss it.
-            if(isSubset(deletableEdges, array[i])) {
-                numberOf->orientationsGivingSubset++;
-                return 0;
+    if(options->printFlag) {
+        fprintf(stderr, "Labelling of graph:\n");
+        printGraph(adjacencyList, numberOfVertices);
+    }
+
+    int adjacency[numberOfVertices][3];
+    getNeighbourTriples(adjacencyList, numberOfVertices, adjacency);
+    bool wantsCertificate = outcome != NULL && outcome->wantsCertificate;
+    if(outcome != NULL) {
+        outcome->aborted = false;
+        outcome->cancelled = false;
+        outcome->hasCertificate = false;
+    }
+    struct canonicalForm form;
+    struct cacheEntry entry = {.numberOfVertices = numberOfVertices,
+     .mode = getCacheMode(options)};
+    bool useCache = options->cache != NULL &&
+     computeCanonicalForm(adjacencyList, numberOfVertices,
+     CANONICAL_FORM_MAX_LEAVES, &form);
+    int frankNumber = 0;
+    if(useCache) {
+        entry.hash[0] = form.hash[0];
+        entry.hash[1] = form.hash[1];
+    }
+    if(useCache && lookupFrankNumber(options, &entry)) {
+        (*cachedResults)++;
+        frankNumber = entry.frankNumber;
+        if(options->verboseFlag) {
+            fprintf(stderr, "\tResult taken from cache.\n");
+        }
+        bool orientation1[numberOfVertices][3];
+        bool orientation2[numberOfVertices][3];
+        bool (*orientation[2])[3] = {orientation1, orientation2};
+        if(entry.hasCertificate && (options->printFlag || wantsCertificate)) {
+            decodeCertificate(adjacency, numberOfVertices, &form, &entry,
+             orientation);
+        }
+        if(options->printFlag && entry.hasCertificate) {
+            fn_print_orientation(adjacency, numberOfVertices, orientation[0]);
+            fn_print_orientation(adjacency, numberOfVertices, orientation[1]);
+        }
+        if(wantsCertificate && entry.hasCertificate) {
+            outcome->hasCertificate = true;
+            for(int k = 0; k < 2; k++) {
+                memcpy(outcome->orientation[k], orientation[k],
+                 sizeof(bool[3])*numberOfVertices);
             }
-
-            //  If the deletable edges of new orientation is superset of older
-            //  we can dismiss older. We set it to EMPTY.
-            if(isSubset(array[i], deletableEdges)) {
-                if(insertPosition == bitsetsOfDeletableEdges->used) {
-                    numberOf->orientationsGivingSuperset++;
-                }
-                array[i] = EMPTY;
+        }
+    }
+    else {
+        struct fn_counters before = *fn_context_counters(context);
+        struct fn_result result;
+        int status = fn_check(context, adjacency, numberOfVertices,
+         getCheckFlags(options, useCache || wantsCertificate), &result);
+        const struct fn_counters *numberOf = fn_context_counters(context);
+        heuristicSucceeded = numberOf->graphsSatisfyingOddnessCondition !=
+         before.graphsSatisfyingOddnessCondition;
+        triedHeuristic = heuristicSucceeded ||
+         numberOf->graphsNotSatisfyingOddnessCondition !=
+         before.graphsNotSatisfyingOddnessCondition;
+        if(status != FN_OK && status != FN_ABORTED &&
+         status != FN_CANCELLED) {
+            fprintf(stderr, "Error: could not check graph.\n");
+            exit(1);
+        }
+        if(options->timing != NULL) {
+            addLibraryTiming(options->timing, fn_context_timing(context));
+        }
+        if(options->searchProfile != NULL) {
+            writeSearchProfile(options->searchProfile, graphString,
+             fn_context_search_profile(context));
+        }
+        frankNumber = result.frankNumber;
+        if(status == FN_ABORTED || status == FN_CANCELLED) {
+            if(outcome != NULL) {
+                outcome->aborted = status == FN_ABORTED;
+                outcome->cancelled = status == FN_CANCELLED;
             }
-
-            //  If union of new and older deletable edges are all edges, Frank
-            //  number is 2.
-            if(equals(union(deletableEdges, array[i]),
-             bitsetContainingAllEdges)) {
-                numberOf->complementaryBitsets++;
-                insertArray(bitsetsOfDeletableEdges, deletableEdges);
-                return 2;
+        }
+        else if(useCache) {
+            entry.frankNumber = frankNumber;
+            encodeCertificate(adjacency, numberOfVertices, &form, &result,
+             &entry);
+            if(!insertResult(options->cache, &entry)) {
+                fprintf(stderr, "Warning: could not store result in cache.\n");
             }
         }
-        else {
-
-            //  Prepare to store new deletable edges in first EMPTY position.
-            if(insertPosition == bitsetsOfDeletableEdges->used) {
-                insertPosition = i;
+        if(wantsCertificate && result.hasCertificate) {
+            outcome->hasCertificate = true;
+            for(int k = 0; k < 2; k++) {
+                memcpy(outcome->orientation[k], result.orientation[k],
+                 sizeof(bool[3])*numberOfVertices);
             }
         }
     }
 
-    //  Store new deletable edges at first empty position or at the end of
-    //  the array.
-    if(insertPosition != bitsetsOfDeletableEdges->used) {
-        insertArrayAtPos(bitsetsOfDeletableEdges, deletableEdges,
-         insertPosition);
+    if(options->verboseFlag) {
+        if(outcome != NULL && outcome->aborted) {
+            fprintf(stderr, "\tAborted, the deadline passed.\n\n");
+        }
+        else if(outcome != NULL && outcome->cancelled) {
+            fprintf(stderr, "\tCancelled by another shard.\n\n");
+        }
+        else {
+            fprintf(stderr, frankNumber == 2 ? "\tFrankNumber = 2.\n\n" :
+             "\tFrankNumber >= 3.\n\n");
+        }
+        fprintf(stderr, "------------------------------------\n\n");
     }
-    else {
-        insertArray(bitsetsOfDeletableEdges, deletableEdges);
+    endSpan(options, "graph", spanStart, graphString);
+    if(options->progress != NULL) {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        addCheckedGraph(options->progress, graphString,
+         (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9,
+         triedHeuristic, heuristicSucceeded);
     }
-
-    return 0;
+    return frankNumber;
 }
 
-//  Check if both of the other edges incident to x are not in deletableEdges. 
-bool otherEdgesAreNonDeletable(bitset adjacencyList[], int numberOfVertices, 
- int x, int y, bitset deletableEdges, int edgeNumbering[][numberOfVertices]) {
-    forEach(element, adjacencyList[x]) {
-        if(element == y) {
-            continue;
-        }
-        if(contains(deletableEdges, edgeNumbering[x][element])) {
-            return false;
-        }
+//  Send the graph to stdout if it passes the filter. Returns whether it did.
+bool writeGraph(char *graphString, int frankNumber, struct options *options) {
+    if((frankNumber == 2) != options->complementFlag) {
+        return false;
     }
+    struct phaseStart start;
+    long long unsigned int spanStart = startSpan(options);
+    startPhase(options->timing, &start);
+    printf("%s", graphString);
+    endPhase(options->timing, &start, OUTPUT_PHASE);
+    endSpan(options, "output", spanStart, NULL);
     return true;
 }
 
-// Add edges according to the three rules, return false if adding leads to
-// contradiction
-bool canAddNewArc(bitset adjacencyList[], int numberOfVertices,
- struct diGraph *orientation, int x, int y, bitset deletableEdges, 
- int edgeNumbering[][numberOfVertices]) {
-    
-    //  If the edge already exists, there cannot be any contradictions in the
-    //  orientation
-    if(contains(orientation->adjacencyList[x], y)) {
-        return true;
-    }
+//******************************************************************************
+//
+//                      Hardness-aware batch scheduling
+//
+//******************************************************************************
 
-    if(contains(orientation->adjacencyList[y], x)) {
-        return false;
+//  With more than one thread, up to options->windowSize graphs are in flight
+//  at a time. Their features are computed by the workers as soon as they are
+//  read, and every worker which becomes free checks the in-flight graph with
+//  the highest predicted cost, such that the hardest graphs do not end up
+//  running alone at the end. A new graph is read whenever the oldest one is
+//  finished, so there is no barrier between windows and results are written
+//  in input order. With a cache, a graph isomorphic to one which is being
+//  checked waits for it and takes its result from the cache.
+
+enum jobState {READ_JOB, PREDICTING_JOB, PREDICTED_JOB, CHECKING_JOB,
+ FINISHED_JOB};
+
+struct batchJob {
+    char *graphString;
+    bitset adjacencyList[MAXVERTICES];
+    int numberOfVertices;
+    double predictedCost;
+
+    //  Hash of the canonical form if hasHash.
+    bool hasHash;
+    uint64_t hash[2];
+    enum jobState state;
+    int frankNumber;
+    bool aborted;
+    struct graphTiming timing;
+};
+
+//  The graphs in flight are jobs[firstJob % windowSize] up to
+//  jobs[(endJob - 1) % windowSize]. checkedJobs[i] is the job checked by
+//  worker i or NULL.
+struct workerPool {
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    pthread_cond_t jobFinished;
+    struct batchJob *jobs;
+    struct batchJob **checkedJobs;
+    int windowSize;
+    int numberOfWorkers;
+    long long unsigned int firstJob;
+    long long unsigned int endJob;
+    bool usesCache;
+    bool shutdown;
+};
+
+//  Every worker has its own copy of the options and its own context.
+struct worker {
+    pthread_t thread;
+    int index;
+    struct workerPool *pool;
+    struct options options;
+    struct fn_context *context;
+    long long unsigned int cachedResults;
+};
+
+void runJob(struct worker *worker, struct batchJob *job) {
+    if(worker->options.stats != NULL) {
+        worker->options.timing = &job->timing;
+        job->timing.counters = worker->options.counters;
+    }
+    if(job->state == PREDICTING_JOB) {
+        job->numberOfVertices = decodeGraph(job->graphString, &worker->options,
+         job->adjacencyList);
+        job->predictedCost = 0;
+        if(job->numberOfVertices != -1) {
+            struct graphFeatures features;
+            computeGraphFeatures(job->adjacencyList, job->numberOfVertices,
+             &features);
+            job->predictedCost = predictCost(&features,
+             worker->options.oddCyclesHeuristicFlag,
+             worker->options.exhaustiveCheckFlag);
+            job->hasHash = features.hasHash;
+            job->hash[0] = features.hash[0];
+            job->hash[1] = features.hash[1];
+        }
+        return;
     }
+    if(job->numberOfVertices != -1) {
+        struct checkOutcome outcome = {.wantsCertificate = false};
+        setBudgetDeadline(&worker->options, worker->context);
+        job->frankNumber = checkGraph(job->graphString, job->adjacencyList,
+         job->numberOfVertices, &worker->options, worker->context,
+         &worker->cachedResults, &outcome);
+        job->aborted = outcome.aborted;
+    }
+}
 
-    if(size(orientation->adjacencyList[x]) >= 2) {
+//  Whether the result of job could be taken from the cache once another
+//  worker finished checking an isomorphic graph.
+bool isIsomorphicToCheckedJob(struct workerPool *pool, struct batchJob *job) {
+    if(!pool->usesCache || !job->hasHash) {
         return false;
-    } 
-    if(size(orientation->reverseAdjacencyList[y]) >= 2) {
-        return false;
-    } 
+    }
+    for(int i = 0; i < pool->numberOfWorkers; i++) {
+        struct batchJob *checkedJob = pool->checkedJobs[i];
+        if(checkedJob != NULL && checkedJob->hasHash &&
+         checkedJob->numberOfVertices == job->numberOfVertices &&
+         checkedJob->hash[0] == job->hash[0] &&
+         checkedJob->hash[1] == job->hash[1]) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    //  Deletable edges incident to same vertex need to be one incoming, one
-    //  outgoing.
-    if(contains(deletableEdges, edgeNumbering[x][y])) {
-        forEach(element, adjacencyList[x]) {
-            if(element == y) {
-                continue;
-            }
-            if(contains(deletableEdges, edgeNumbering[x][element])) {
-                if(contains(orientation->adjacencyList[x], element)) {
-                    return false;
-                }
-            }
+//  Take the next job for a worker: the oldest graph whose features are not
+//  computed yet or else the graph with the highest predicted cost, the oldest
+//  one among equal costs. Returns NULL if there is nothing to do. Must be
+//  called with the lock held.
+struct batchJob *takeJob(struct workerPool *pool) {
+    struct batchJob *hardestJob = NULL;
+    for(long long unsigned int i = pool->firstJob; i < pool->endJob; i++) {
+        struct batchJob *job = &pool->jobs[i % pool->windowSize];
+        if(job->state == READ_JOB) {
+            job->state = PREDICTING_JOB;
+            return job;
         }
-        forEach(element, adjacencyList[y]) {
-            if(element == x) {
-                continue;
-            }
-            if(contains(deletableEdges, edgeNumbering[y][element])) {
-                if(contains(orientation->reverseAdjacencyList[y], element)) {
-                    return false;
-                }
-            }
+        if(job->state == PREDICTED_JOB && (hardestJob == NULL ||
+         job->predictedCost > hardestJob->predictedCost) &&
+         !isIsomorphicToCheckedJob(pool, job)) {
+            hardestJob = job;
         }
     }
-    else { // xy is not in deletableEdges
+    if(hardestJob != NULL) {
+        hardestJob->state = CHECKING_JOB;
+    }
+    return hardestJob;
+}
 
-        // If xy was not deletable, it needs to be deletable in the current
-        // orientation, i.e. x needs to have one incoming and one outgoing
-        // apart from xy.
-        if(size(orientation->adjacencyList[x]) >= 2 || 
-         size(orientation->reverseAdjacencyList[x]) >= 2) {
-            return false;
+void *runWorker(void *arg) {
+    struct worker *worker = arg;
+    struct workerPool *pool = worker->pool;
+
+    //  The counters only count the events of the thread which opened them.
+    worker->options.counters = NULL;
+    if(worker->options.hardwareCountersFlag) {
+        worker->options.counters = openHardwareCounters();
+    }
+    worker->options.trace = NULL;
+    if(worker->options.traceFile != NULL) {
+        char threadName[32];
+        snprintf(threadName, sizeof(threadName), "worker %d", worker->index);
+        worker->options.trace = newTraceBuffer(worker->options.traceFile,
+         threadName);
+    }
+    pthread_mutex_lock(&pool->lock);
+    while(true) {
+        struct batchJob *job = NULL;
+        while(!pool->shutdown && (job = takeJob(pool)) == NULL) {
+            pthread_cond_wait(&pool->workAvailable, &pool->lock);
+        }
+        if(job == NULL) {
+            break;
         }
-        if(size(orientation->adjacencyList[y]) >= 2 ||
-         size(orientation->reverseAdjacencyList[y]) >= 2) {
-            return false;
+        if(job->state == CHECKING_JOB) {
+            pool->checkedJobs[worker->index] = job;
         }
+        pthread_mutex_unlock(&pool->lock);
+        runJob(worker, job);
+        pthread_mutex_lock(&pool->lock);
 
-        //  If xy is not deletable then it needs the be oriented in opposite
-        //  direction of other non-deletable edge incident to x.
-        forEach(element, adjacencyList[x]) {
-            if(element == y) {
-                continue;
-            }
-            if(!contains(deletableEdges, edgeNumbering[x][element])) {
-                if(contains(orientation->reverseAdjacencyList[x], y)) {
-                    return false;
-                }
-                break;
-            }
+        //  A predicted job can be checked, and a finished one may let an
+        //  isomorphic graph take its result from the cache.
+        if(job->state == PREDICTING_JOB) {
+            job->state = PREDICTED_JOB;
         }
-
-        //  If xy is not deletable then it needs the be oriented in opposite
-        //  direction of other non-deletable edge incident to y
-        forEach(element, adjacencyList[y]) {
-            if(element == x) {
-                continue;
-            }
-            if(!contains(deletableEdges, edgeNumbering[y][element])) {
-                if(contains(orientation->adjacencyList[y], x)) {
-                    return false;
-                }
-                break;
-            }
+        else {
+            job->state = FINISHED_JOB;
+            pool->checkedJobs[worker->index] = NULL;
+            pthread_cond_signal(&pool->jobFinished);
         }
-
+        pthread_cond_broadcast(&pool->workAvailable);
     }
-    addArc(orientation, x, y);
+    pthread_mutex_unlock(&pool->lock);
+    closeHardwareCounters(worker->options.counters);
+    freeTraceBuffer(worker->options.trace);
+    return NULL;
+}
 
-    //  If x has two outgoing and no incoming, add the final incoming.
-    if(size(orientation->adjacencyList[x]) == 2 &&
-     size(orientation->reverseAdjacencyList[x]) < 1) {
-        int lastNeighbour = next(difference(adjacencyList[x],
-         orientation->adjacencyList[x]), -1);
-        if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-         lastNeighbour, x, deletableEdges, edgeNumbering)) {
-            return false;
-        }
+//  Add the counters of one worker to the totals.
+void mergeCounters(struct fn_counters *total,
+ const struct fn_counters *part) {
+    total->storedBitsets += part->storedBitsets;
+    total->orientationsGivingSubset += part->orientationsGivingSubset;
+    total->orientationsGivingSuperset += part->orientationsGivingSuperset;
+    total->emptyBitsetsStored += part->emptyBitsetsStored;
+    total->complementaryBitsets += part->complementaryBitsets;
+    total->graphsSatisfyingOddnessCondition +=
+     part->graphsSatisfyingOddnessCondition;
+    total->graphsNotSatisfyingOddnessCondition +=
+     part->graphsNotSatisfyingOddnessCondition;
+    total->graphsSatisfyingFirstOddness += part->graphsSatisfyingFirstOddness;
+    total->graphsSatisfyingSecondOddness += part->graphsSatisfyingSecondOddness;
+    total->totalOrientationsGenerated += part->totalOrientationsGenerated;
+    total->generatedOrientations += part->generatedOrientations;
+    if(total->mostGeneratedOrientations < part->mostGeneratedOrientations) {
+        total->mostGeneratedOrientations = part->mostGeneratedOrientations;
+    }
+    if(total->mostStoredBitsets < part->mostStoredBitsets) {
+        total->mostStoredBitsets = part->mostStoredBitsets;
     }
+}
 
-    //  If y has no outgoing and two incoming, add the final outgoing.
-    if(size(orientation->adjacencyList[y]) == 0 &&
-     size(orientation->reverseAdjacencyList[y]) == 2) {
-        int lastNeighbour = next(difference(adjacencyList[y],
-         orientation->reverseAdjacencyList[y]), -1);
-        if(!canAddNewArc(adjacencyList, numberOfVertices, orientation, y,
-         lastNeighbour, deletableEdges, edgeNumbering)) {
-            return false;
-        }
+//  Read graphs from stdin and check them using options->numberOfThreads
+//  threads. Same bookkeeping as the sequential loop in main.
+void checkGraphsInBatches(struct options *options,
+ struct fn_counters *numberOf, long long unsigned int *cachedResults,
+ unsigned long long int *totalGraphs, unsigned long long int *counter,
+ unsigned long long int *skippedGraphs, unsigned long long int *passedGraphs,
+ unsigned long long int *deferredGraphs) {
+    struct workerPool pool = {.lock = PTHREAD_MUTEX_INITIALIZER,
+     .workAvailable = PTHREAD_COND_INITIALIZER,
+     .jobFinished = PTHREAD_COND_INITIALIZER,
+     .windowSize = options->windowSize,
+     .numberOfWorkers = options->numberOfThreads,
+     .usesCache = options->cache != NULL};
+    pool.jobs = malloc(sizeof(struct batchJob)*options->windowSize);
+    pool.checkedJobs = calloc(options->numberOfThreads,
+     sizeof(struct batchJob *));
+    struct worker *workers = malloc(sizeof(struct worker)*
+     options->numberOfThreads);
+    if(pool.jobs == NULL || pool.checkedJobs == NULL || workers == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
     }
-
-    //  Deletable edges incident to same vertex need to be one incoming, one
-    //  outgoing
-    if(contains(deletableEdges, edgeNumbering[x][y])) {
-        forEach(element, adjacencyList[x]) {
-            if(element == y) {
-                continue;
+    for(int i = 0; i < options->numberOfThreads; i++) {
+        workers[i] = (struct worker) {.index = i, .pool = &pool,
+         .options = *options,
+         .context = fn_context_new(fn_max_heuristic_vertices())};
+        if(workers[i].context == NULL) {
+            fprintf(stderr, "Error: out of memory\n");
+            exit(1);
+        }
+        if(options->hardwareCountersFlag || options->traceFile != NULL) {
+            fn_context_set_phase_hook(workers[i].context, handleLibraryPhase,
+             &workers[i].options);
+        }
+        if(pthread_create(&workers[i].thread, NULL, runWorker, &workers[i])) {
+            fprintf(stderr, "Error: could not create thread.\n");
+            exit(1);
+        }
+    }
+
+    long long unsigned int windowSize = options->windowSize;
+    bool endOfInput = false;
+    while(true) {
+
+        //  Read graphs belonging to the res/mod class while there is room. The
+        //  slot of a new job is not in flight, so it is filled without the
+        //  lock.
+        while(!endOfInput && pool.endJob - pool.firstJob < windowSize) {
+            char *graphString = NULL;
+            size_t size;
+            ssize_t length = getline(&graphString, &size, stdin);
+            if(length == -1) {
+                free(graphString);
+                endOfInput = true;
+                break;
             }
-            if(contains(deletableEdges, edgeNumbering[x][element])) {
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 element, x, deletableEdges, edgeNumbering)) {
-                    return false;
+            (*totalGraphs)++;
+            if((*totalGraphs - 1) % options->modulo != options->remainder) {
+                if(options->progress != NULL) {
+                    addInput(options->progress, length);
                 }
-            }
-        }
-        forEach(element, adjacencyList[y]) {
-            if(element == x) {
+                free(graphString);
                 continue;
             }
-            if(contains(deletableEdges, edgeNumbering[y][element])) {
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 y, element, deletableEdges, edgeNumbering)) {
-                    return false;
-                }
-            }
+            pool.jobs[pool.endJob % pool.windowSize] = (struct batchJob)
+             {.graphString = graphString, .state = READ_JOB};
+            pthread_mutex_lock(&pool.lock);
+            pool.endJob++;
+            pthread_cond_signal(&pool.workAvailable);
+            pthread_mutex_unlock(&pool.lock);
+        }
+        if(pool.firstJob == pool.endJob) {
+            break;
         }
 
-        //  If one deletable edge and two nondeletable, the nondeletable need to
-        //  be opposite of deletable.
-        if(otherEdgesAreNonDeletable(adjacencyList, numberOfVertices, x, y,
-         deletableEdges, edgeNumbering)) {
-            forEach(element, adjacencyList[x]) {
-                if(element == y) {
-                    continue;
-                }
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 element, x, deletableEdges, edgeNumbering)) {
-                    return false;
-                }
-            }
+        //  Wait for the oldest graph to be finished and write its result.
+        struct batchJob *job = &pool.jobs[pool.firstJob % pool.windowSize];
+        pthread_mutex_lock(&pool.lock);
+        while(job->state != FINISHED_JOB) {
+            pthread_cond_wait(&pool.jobFinished, &pool.lock);
         }
+        pthread_mutex_unlock(&pool.lock);
 
-        if(otherEdgesAreNonDeletable(adjacencyList, numberOfVertices, y, x,
-         deletableEdges, edgeNumbering)) {
-            forEach(element, adjacencyList[y]) {
-                if(element == x) {
-                    continue;
-                }
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 y, element, deletableEdges, edgeNumbering)) {
-                    return false;
-                }
-            }
+        //  The input of a graph only counts as read once it is finished.
+        if(options->progress != NULL) {
+            addInput(options->progress, strlen(job->graphString));
         }
-    }
-    else { // xy is not in deletableEdges
-
-        // xy needs to be deletable, so if we have two incoming of y, we need an
-        // outgoing.
-        if(size(orientation->adjacencyList[y]) == 0 &&
-         size(orientation->reverseAdjacencyList[y]) == 2) {
-            int lastNeighbour = next(difference(adjacencyList[y],
-             orientation->adjacencyList[y]), -1);
-            if(!canAddNewArc(adjacencyList, numberOfVertices, orientation, y,
-             lastNeighbour, deletableEdges, edgeNumbering)) {
-                return false;
-            }
+        if(job->numberOfVertices == -1) {
+            (*skippedGraphs)++;
         }
-
-        // xy needs to be deletable, so if we have one outgoing, one incoming to
-        // y, we need an incoming.
-        if(size(orientation->adjacencyList[y]) == 1 &&
-         size(orientation->reverseAdjacencyList[y]) == 1) {
-            int lastNeighbour = next(difference(adjacencyList[y],
-             union(orientation->adjacencyList[y], 
-             orientation->reverseAdjacencyList[y])), -1);
-            if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-             lastNeighbour, y, deletableEdges, edgeNumbering)) {
-                return false;
-            }
+        else if(job->aborted) {
+            (*deferredGraphs)++;
+            fprintf(options->deferred, "%s", job->graphString);
         }
+        else {
+            (*counter)++;
 
-        //  If xy is not deletable then it needs the be oriented in opposite
-        //  direction of other non-deletable edge incident to x
-        forEach(element, adjacencyList[x]) {
-            if(element == y) {continue; } if(!contains(deletableEdges, 
-             edgeNumbering[x][element])) {
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 x, element, deletableEdges, edgeNumbering)) {
-                    return false;
-                }
-                break;
+            //  The output is written by this thread.
+            if(options->stats != NULL) {
+                options->timing = &job->timing;
+                job->timing.counters = options->counters;
             }
-        }
-
-        //  If xy is not deletable then it needs the be oriented in opposite
-        //  direction of other non-deletable edge incident to y
-        forEach(element, adjacencyList[y]) {
-            if(element == x) {
-                continue;
+            if(writeGraph(job->graphString, job->frankNumber, options)) {
+                (*passedGraphs)++;
             }
-            if(!contains(deletableEdges, edgeNumbering[y][element])) {
-                if(!canAddNewArc(adjacencyList, numberOfVertices, orientation,
-                 element, y, deletableEdges, edgeNumbering)) {
-                    return false;
-                }
-                break;
+            if(options->stats != NULL) {
+                recordGraph(options->stats, job->graphString, &job->timing);
             }
-        }
-
-    }
-    return true;
+            options->timing = NULL;
+        }
+        free(job->graphString);
+        pthread_mutex_lock(&pool.lock);
+        pool.firstJob++;
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = true;
+    pthread_cond_broadcast(&pool.workAvailable);
+    pthread_mutex_unlock(&pool.lock);
+    for(int i = 0; i < options->numberOfThreads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        mergeCounters(numberOf, fn_context_counters(workers[i].context));
+        *cachedResults += workers[i].cachedResults;
+        fn_context_free(workers[i].context);
+    }
+    free(workers);
+    free(pool.checkedJobs);
+    free(pool.jobs);
 }
 
-//  Loop over all edges and try orienting them in both directions.
-bool canCompleteCompOrientation(bitset adjacencyList[], int numberOfVertices,
- struct options *options, struct diGraph *orientation, bitset deletableEdges,
- int edgeNumbering[][numberOfVertices], int endpoint1, int endpoint2) {
+//******************************************************************************
+//
+//                              Server mode
+//
+//******************************************************************************
 
-    if(endpoint2 == -1 && endpoint1 < (numberOfVertices - 1)) {
-        return canCompleteCompOrientation(adjacencyList, numberOfVertices,
-         options, orientation, deletableEdges, edgeNumbering, endpoint1 + 1,
-         next(adjacencyList[endpoint1 + 1], endpoint1 + 1));
-    }
+//  With --serve the graphs are read from clients connecting to a Unix domain
+//  socket instead of from stdin. The workers and their contexts stay alive
+//  between requests. A request consists of graph6 lines, optionally preceded
+//  by the line "!certificates", and ends with an empty line or when the client
+//  shuts down its side of the connection. For the i-th graph of the request
+//  (counting from 0) the line
+//
+//      i result [orientation orientation]
+//
+//  is sent as soon as the results of all earlier graphs were sent, where
+//  result is one of fn=2, fn>=3, unknown (only with -2), invalid or timeout.
+//  The orientations are only sent for graphs with Frank number 2 if
+//  certificates were asked for. They contain one character for every edge uv
+//  with u < v, in lexicographic order, which is 1 if the edge is oriented from
+//  u to v and 0 otherwise. The line "end" concludes the request, after which
+//  the connection can be used for a new request. If the request is too large
+//  or contains an unknown command, the line "error <message>" is sent and the
+//  connection is closed.
+
+#define DEFAULT_MAX_REQUEST_SIZE (1 << 20)
+
+enum serverResult {
+    PENDING_RESULT,
+    FN2_RESULT,
+    FN3_RESULT,
+    UNKNOWN_RESULT,
+    INVALID_RESULT,
+    TIMEOUT_RESULT
+};
 
-    //  We have oriented all edges.
-    if(endpoint2 == -1 && endpoint1 == numberOfVertices - 1) {
-        if(orientation->numberOfArcs != 3*numberOfVertices/2) {
-            fprintf(stderr, "%s\n", "Something went wrong");
-        }
+struct serverRequest;
+
+struct serverJob {
+    char *graphString;
+    struct serverRequest *request;
+    enum serverResult result;
+
+    //  Both orientations separated by a space or NULL.
+    char *certificate;
+    struct serverJob *nextInQueue;
+};
 
-        //  Check if formed orientation actually is complementary.
-        bitset complementDeletableEdges = getDeletableEdges(orientation,
-         numberOfVertices, edgeNumbering);
-        if(equals(union(deletableEdges, complementDeletableEdges),
-         complement(EMPTY, 3*numberOfVertices/2))) {
-            if(options->printFlag) {
-                printDeletableEdges(numberOfVertices, edgeNumbering,
-                 orientation->adjacencyList, complementDeletableEdges);
-                printDiGraph(orientation);
+struct serverRequest {
+    struct serverJob *jobs;
+    int numberOfJobs;
+    bool wantsCertificates;
+    bool hasDeadline;
+    struct timespec deadline;
+
+    //  Set when the client is gone. Jobs which did not start yet are skipped.
+    bool cancelled;
+    pthread_cond_t jobDone;
+};
+
+//  Jobs of all requests are put in one queue which is handled by the workers.
+struct server {
+    pthread_mutex_t lock;
+    pthread_cond_t jobAvailable;
+    struct serverJob *queueHead;
+    struct serverJob *queueTail;
+    struct options *options;
+    size_t maxRequestSize;
+    long int timeout;
+};
+
+struct serverWorker {
+    pthread_t thread;
+    struct server *server;
+    struct options options;
+    struct fn_context *context;
+    long long unsigned int cachedResults;
+};
+
+struct serverConnection {
+    struct server *server;
+    int socket;
+};
+
+//  Write both orientations of the certificate in the format of the protocol.
+char *formatCertificate(bitset adjacencyList[], int numberOfVertices,
+ struct checkOutcome *outcome) {
+    int numberOfEdges = 3*numberOfVertices/2;
+    char *certificate = malloc(2*numberOfEdges + 2);
+    if(certificate == NULL) {
+        return NULL;
+    }
+    int adjacency[numberOfVertices][3];
+    getNeighbourTriples(adjacencyList, numberOfVertices, adjacency);
+    char *position = certificate;
+    for(int k = 0; k < 2; k++) {
+        for(int u = 0; u < numberOfVertices; u++) {
+            for(int i = 0; i < 3; i++) {
+                if(adjacency[u][i] > u) {
+                    *position++ = outcome->orientation[k][u][i] ? '1' : '0';
+                }
             }
-            return true;
         }
-        return false;
+        *position++ = k == 0 ? ' ' : '\0';
     }
+    return certificate;
+}
 
-    //  If already oriented, go to next edge.
-    if(contains(orientation->adjacencyList[endpoint1], endpoint2) ||
-     contains(orientation->adjacencyList[endpoint2], endpoint1)) {
-        return canCompleteCompOrientation(adjacencyList, numberOfVertices,
-         options, orientation, deletableEdges, edgeNumbering, endpoint1,
-         next(adjacencyList[endpoint1], endpoint2));
-    }
-
-    //  Make copy of orientation
-    struct diGraph orientationCopy = {.numberOfVertices = numberOfVertices};
-    orientationCopy.adjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    orientationCopy.reverseAdjacencyList = 
-     malloc(sizeof(bitset)*numberOfVertices);
-    memcpy(orientationCopy.adjacencyList, orientation->adjacencyList,
-     sizeof(bitset)*numberOfVertices);
-    memcpy(orientationCopy.reverseAdjacencyList,
-     orientation->reverseAdjacencyList, sizeof(bitset)*numberOfVertices);
-    orientationCopy.numberOfArcs = orientation->numberOfArcs;
-
-    //  Try adding endpoint1->endpoint2
-    if(canAddNewArc(adjacencyList, numberOfVertices, orientation, endpoint1,
-     endpoint2, deletableEdges, edgeNumbering)) {
-
-        //  Continue with next edge.
-        if(canCompleteCompOrientation(adjacencyList, numberOfVertices, options,
-         orientation, deletableEdges, edgeNumbering, endpoint1, 
-         next(adjacencyList[endpoint1], endpoint2))) {
-            free(orientationCopy.adjacencyList);
-            free(orientationCopy.reverseAdjacencyList);
-            return true;
-       }
-    }
-
-    //  Put orientation back to before we added endpoint1->endpoint2.
-    memcpy(orientation->adjacencyList, orientationCopy.adjacencyList,
-     sizeof(bitset)*numberOfVertices);
-    memcpy(orientation->reverseAdjacencyList,
-     orientationCopy.reverseAdjacencyList, sizeof(bitset)*numberOfVertices);
-    orientation->numberOfArcs = orientationCopy.numberOfArcs;
-
-    //  Try adding endpoint2->endpoint1.
-    if(canAddNewArc(adjacencyList, numberOfVertices, orientation, endpoint2,
-     endpoint1, deletableEdges, edgeNumbering)) {
-
-        //  Continue with next edge.
-        if(canCompleteCompOrientation(adjacencyList, numberOfVertices, options,
-         orientation, deletableEdges, edgeNumbering, endpoint1,
-         next(adjacencyList[endpoint1], endpoint2))) {
-            free(orientationCopy.adjacencyList);
-            free(orientationCopy.reverseAdjacencyList);
-            return true;
+void runServerJob(struct serverWorker *worker, struct serverJob *job) {
+    struct serverRequest *request = job->request;
+    bitset adjacencyList[MAXVERTICES];
+    int numberOfVertices = decodeGraph(job->graphString, &worker->options,
+     adjacencyList);
+    if(numberOfVertices == -1) {
+        job->result = INVALID_RESULT;
+        return;
+    }
+    fn_context_set_deadline(worker->context,
+     request->hasDeadline ? &request->deadline : NULL);
+    struct checkOutcome outcome =
+     {.wantsCertificate = request->wantsCertificates};
+    int frankNumber = checkGraph(job->graphString, adjacencyList,
+     numberOfVertices, &worker->options, worker->context,
+     &worker->cachedResults, &outcome);
+    if(outcome.aborted) {
+        job->result = TIMEOUT_RESULT;
+    }
+    else if(frankNumber == 2) {
+        job->result = FN2_RESULT;
+        if(outcome.hasCertificate) {
+            job->certificate = formatCertificate(adjacencyList,
+             numberOfVertices, &outcome);
         }
     }
-
-    //  Both orientations lead to contradiction.
-    free(orientationCopy.adjacencyList);
-    free(orientationCopy.reverseAdjacencyList);
-    return false;
-}
-
-bool hasComplementaryOrientation(bitset adjacencyList[], int numberOfVertices,
- struct options *options, bitset deletableEdgesOfOrientationTocomplement, 
- int edgeNumbering[][numberOfVertices]) {
-
-    //  This will complement the given orientation.
-    struct diGraph orientation = {.numberOfVertices = numberOfVertices};
-    orientation.adjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    orientation.reverseAdjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    emptyGraph(&orientation);
-
-    //  Fix a first arc, does not matter which or in what direction.
-    //  (Orientation with opposite arcs has same deletable edges.)
-    if(!canAddNewArc(adjacencyList, numberOfVertices, &orientation, 0,
-     next(adjacencyList[0], -1), deletableEdgesOfOrientationTocomplement,
-      edgeNumbering)) {
-        return false;
+    else {
+        job->result = worker->options.exhaustiveCheckFlag ? FN3_RESULT :
+         UNKNOWN_RESULT;
     }
-
-    bool hasCompOrientation = canCompleteCompOrientation(adjacencyList,
-     numberOfVertices, options, &orientation,
-     deletableEdgesOfOrientationTocomplement, edgeNumbering, 0,
-     next(adjacencyList[0], -1));
-
-    free(orientation.adjacencyList);
-    free(orientation.reverseAdjacencyList);
-    return hasCompOrientation;
 }
 
-//  Generate strong orientations of graph, get deletable edges and perform one
-//  of the exact methods.
-int generateAllOrientations(bitset adjacencyList[], struct options *options,
- struct counters *numberOf, int numberOfVertices, 
- int edgeNumbering[][numberOfVertices], Array *bitsetsOfDeletableEdges, 
- struct diGraph *orientation, int endpoint1, int endpoint2) {
+void *runServerWorker(void *arg) {
+    struct serverWorker *worker = arg;
+    struct server *server = worker->server;
+    pthread_mutex_lock(&server->lock);
+    while(true) {
+        while(server->queueHead == NULL) {
+            pthread_cond_wait(&server->jobAvailable, &server->lock);
+        }
+        struct serverJob *job = server->queueHead;
+        server->queueHead = job->nextInQueue;
+        if(server->queueHead == NULL) {
+            server->queueTail = NULL;
+        }
+        bool cancelled = job->request->cancelled;
+        pthread_mutex_unlock(&server->lock);
 
-    int frankNumberUpperBound = 0;
-    if(endpoint2 == -1 && endpoint1 < (numberOfVertices - 1)) {
-        frankNumberUpperBound = generateAllOrientations(adjacencyList, options,
-         numberOf, numberOfVertices, edgeNumbering, bitsetsOfDeletableEdges,
-         orientation, endpoint1 + 1, next(adjacencyList[endpoint1 + 1], 
-         endpoint1 + 1));
-        return frankNumberUpperBound;
-    }
+        struct serverJob finishedJob = *job;
+        finishedJob.result = TIMEOUT_RESULT;
+        if(!cancelled) {
+            runServerJob(worker, &finishedJob);
+        }
 
-    //  All edges are oriented.
-    if(endpoint2 == -1 && endpoint1 == numberOfVertices - 1) {
+        pthread_mutex_lock(&server->lock);
+        job->result = finishedJob.result;
+        job->certificate = finishedJob.certificate;
+        pthread_cond_broadcast(&job->request->jobDone);
+    }
+    return NULL;
+}
 
-        numberOf->totalOrientationsGenerated++;
+enum requestEnd {
+    END_OF_REQUEST,     //  An empty line was read.
+    END_OF_INPUT,       //  The client shut down its side of the connection.
+    INVALID_REQUEST     //  An error was sent to the client.
+};
 
-        //  Skip orientations which do not have correct remainder.
-        if(options->singleGraphFlag) {
-            if(numberOf->totalOrientationsGenerated % options->modulo != 
-             options->remainder) {
-               return 0; 
+//  Like getline(), but gives up after maxLength bytes such that a client
+//  cannot make the server read forever. Returns -1 at the end of the input and
+//  -2 if the line is too long.
+ssize_t readLimitedLine(char **line, size_t *size, size_t maxLength,
+ FILE *input) {
+    size_t length = 0;
+    int c;
+    while((c = getc(input)) != EOF) {
+        if(length == maxLength) {
+            return -2;
+        }
+        if(length + 2 > *size) {
+            size_t newSize = *size < 64 ? 64 : 2*(*size);
+            char *newLine = realloc(*line, newSize);
+            if(newLine == NULL) {
+                return -2;
             }
+            *line = newLine;
+            *size = newSize;
         }
-
-        if(!isStronglyConnected(orientation)) {
-            return 0;
+        (*line)[length++] = c;
+        if(c == '\n') {
+            break;
         }
+    }
+    if(length == 0) {
+        return -1;
+    }
+    (*line)[length] = '\0';
+    return length;
+}
 
-        bitset deletableEdges = getDeletableEdges(orientation, numberOfVertices,
-         edgeNumbering);
-
-        //  Check if there is a vertex with three non-deletable incident edges.
-        //  In this case orientation has no complementary orientation giving
-        //  fn=2.
-        for(int i = 0; i < numberOfVertices; i++) {
-            bool noIncidentEdgesDeletable = true;
-            forEach(nbr, adjacencyList[i])  {
-                if(contains(deletableEdges, edgeNumbering[i][nbr])) {
-                    noIncidentEdgesDeletable = false;
-                }
+enum requestEnd readRequest(struct server *server, FILE *input, FILE *output,
+ struct serverRequest *request) {
+    size_t requestSize = 0;
+    int capacity = 0;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    while((length = readLimitedLine(&line, &size,
+     server->maxRequestSize - requestSize, input)) != -1) {
+        if(length == -2) {
+            fprintf(output, "error request too large\n");
+            free(line);
+            return INVALID_REQUEST;
+        }
+        requestSize += length;
+        if(line[0] == '\n' || (line[0] == '\r' && line[1] == '\n')) {
+            free(line);
+            return END_OF_REQUEST;
+        }
+        if(line[0] == '!') {
+            if(strcmp(line, "!certificates\n") != 0 &&
+             strcmp(line, "!certificates\r\n") != 0) {
+                fprintf(output, "error unknown command\n");
+                free(line);
+                return INVALID_REQUEST;
             }
-            if(noIncidentEdgesDeletable) {
-                return 0;
+            request->wantsCertificates = true;
+            continue;
+        }
+        if(request->numberOfJobs == capacity) {
+            capacity = capacity == 0 ? 64 : 2*capacity;
+            struct serverJob *jobs = realloc(request->jobs,
+             sizeof(struct serverJob)*capacity);
+            if(jobs == NULL) {
+                fprintf(output, "error out of memory\n");
+                free(line);
+                return INVALID_REQUEST;
             }
+            request->jobs = jobs;
         }
+        request->jobs[request->numberOfJobs++] = (struct serverJob)
+         {.graphString = line, .request = request};
+        line = NULL;
+        size = 0;
+    }
+    free(line);
+    return END_OF_INPUT;
+}
 
-        numberOf->generatedOrientations++;
-
-        //  Try finding a complement to the current orientation.
-        if(!options->bruteForceFlag) {
-            if(hasComplementaryOrientation(adjacencyList, numberOfVertices,
-             options, deletableEdges, edgeNumbering)) {
-                if(options->printFlag) {
-                    printDeletableEdges(numberOfVertices, edgeNumbering,
-                     orientation->adjacencyList, deletableEdges);
-                    printDiGraph(orientation);
-                }
-                return 2;
-            } 
-            return 0;
+//  Queue all jobs of the request and send the results in order.
+void handleRequest(struct server *server, FILE *output,
+ struct serverRequest *request) {
+    static const char *resultNames[] = {[FN2_RESULT] = "fn=2",
+     [FN3_RESULT] = "fn>=3", [UNKNOWN_RESULT] = "unknown",
+     [INVALID_RESULT] = "invalid", [TIMEOUT_RESULT] = "timeout"};
+    if(server->timeout > 0) {
+        request->hasDeadline = true;
+        clock_gettime(CLOCK_MONOTONIC, &request->deadline);
+        request->deadline.tv_sec += server->timeout / 1000;
+        request->deadline.tv_nsec += (server->timeout % 1000) * 1000000;
+        if(request->deadline.tv_nsec >= 1000000000) {
+            request->deadline.tv_sec++;
+            request->deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&server->lock);
+    for(int i = 0; i < request->numberOfJobs; i++) {
+        struct serverJob *job = &request->jobs[i];
+        if(server->queueTail == NULL) {
+            server->queueHead = job;
         }
-
-        //  If not complementFlag, try using the bruteforce method of comparing
-        //  all orientations pairwise.
-        return getIntermediateFrankNumber(options, numberOf, numberOfVertices,
-         edgeNumbering, bitsetsOfDeletableEdges, deletableEdges);
+        else {
+            server->queueTail->nextInQueue = job;
+        }
+        server->queueTail = job;
     }
+    pthread_cond_broadcast(&server->jobAvailable);
 
-    //  Orient edge and continue with next edge.
-    addArc(orientation, endpoint1, endpoint2);
-    if(size(orientation->adjacencyList[endpoint1]) != 3 &&
-     size(orientation->reverseAdjacencyList[endpoint2]) != 3) {
-        frankNumberUpperBound = generateAllOrientations(adjacencyList, options,
-         numberOf, numberOfVertices, edgeNumbering, bitsetsOfDeletableEdges, 
-         orientation, endpoint1, next(adjacencyList[endpoint1], endpoint2));
+    for(int i = 0; i < request->numberOfJobs; i++) {
+        struct serverJob *job = &request->jobs[i];
+        while(job->result == PENDING_RESULT) {
+            pthread_cond_wait(&request->jobDone, &server->lock);
+        }
+        if(request->cancelled) {
+            continue;
+        }
+        pthread_mutex_unlock(&server->lock);
+        fprintf(output, "%d %s", i, resultNames[job->result]);
+        if(job->certificate != NULL && request->wantsCertificates) {
+            fprintf(output, " %s", job->certificate);
+        }
+        fprintf(output, "\n");
+        bool failed = fflush(output) == EOF;
+        pthread_mutex_lock(&server->lock);
+        if(failed) {
+            request->cancelled = true;
+        }
     }
-    removeArc(orientation, endpoint1, endpoint2);
-
-    if(frankNumberUpperBound) {
-        return frankNumberUpperBound;
+    pthread_mutex_unlock(&server->lock);
+    if(!request->cancelled) {
+        fprintf(output, "end\n");
+        fflush(output);
     }
+}
 
-    //  Orient edge in other way and continue.
-    addArc(orientation, endpoint2, endpoint1);
-    if(size(orientation->reverseAdjacencyList[endpoint1]) != 3 && 
-     size(orientation->adjacencyList[endpoint2]) != 3) {
-        frankNumberUpperBound = generateAllOrientations(adjacencyList, options,
-         numberOf, numberOfVertices, edgeNumbering, bitsetsOfDeletableEdges,
-         orientation, endpoint1, next(adjacencyList[endpoint1], endpoint2));
+void freeRequest(struct serverRequest *request) {
+    for(int i = 0; i < request->numberOfJobs; i++) {
+        free(request->jobs[i].graphString);
+        free(request->jobs[i].certificate);
     }
-    removeArc(orientation, endpoint2, endpoint1);
+    free(request->jobs);
+    pthread_cond_destroy(&request->jobDone);
+}
 
-    if(frankNumberUpperBound) {
-        return frankNumberUpperBound;
+void *handleConnection(void *arg) {
+    struct serverConnection *connection = arg;
+    struct server *server = connection->server;
+    FILE *input = fdopen(connection->socket, "r");
+    FILE *output = fdopen(dup(connection->socket), "w");
+    bool keepOpen = input != NULL && output != NULL;
+    while(keepOpen) {
+        struct serverRequest request = {.jobDone = PTHREAD_COND_INITIALIZER};
+        enum requestEnd end = readRequest(server, input, output, &request);
+        if(end == END_OF_REQUEST ||
+         (end == END_OF_INPUT && request.numberOfJobs > 0)) {
+            handleRequest(server, output, &request);
+        }
+        keepOpen = end == END_OF_REQUEST && !request.cancelled;
+        freeRequest(&request);
+    }
+    if(input != NULL) {
+        fclose(input);
     }
-
-    //  None of the orientations of this edge led to an orientation of the graph
-    //  which has a second orientation giving fn=2.
-    return 0;
+    else {
+        close(connection->socket);
+    }
+    if(output != NULL) {
+        fclose(output);
+    }
+    free(connection);
+    return NULL;
 }
 
-int findFrankNumber(bitset adjacencyList[], int numberOfVertices,
- struct options *options, struct counters *numberOf) {
-    Array bitsetsOfDeletableEdges;
-    initArray(&bitsetsOfDeletableEdges, options->sizeOfArray);
-
-    int edgeNumbering[numberOfVertices][numberOfVertices];
-    numberEdges(adjacencyList, numberOfVertices, edgeNumbering);
-
-    struct diGraph orientation = {.numberOfVertices = numberOfVertices};
-    orientation.adjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    orientation.reverseAdjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    emptyGraph(&orientation);
-
-    int frankNumber = generateAllOrientations(adjacencyList, options, numberOf,
-     numberOfVertices, edgeNumbering, &bitsetsOfDeletableEdges, &orientation,
-     -1, -1);
-
-    //  In bruteforce case, we now have a list of bitsets corresponding to
-    //  deletable edges of (all) orientations.
-    if(options->bruteForceFlag) {
-        numberOf->storedBitsets = bitsetsOfDeletableEdges.used;
-        if(numberOf->storedBitsets > options->sizeOfArray) {
-            options->sizeOfArray = bitsetsOfDeletableEdges.size;
-        }
-        if(options->verboseFlag) {
-            fprintf(stderr, "\tBitsets stored: %llu, size of array %llu\n", 
-             numberOf->storedBitsets, options->sizeOfArray);
-        }
+//  Stop accepting connections on SIGINT or SIGTERM.
+void *waitForSignal(void *arg) {
+    int *listeningSocket = arg;
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    int signal;
+    sigwait(&signals, &signal);
+    shutdown(*listeningSocket, SHUT_RDWR);
+    return NULL;
+}
 
-        //  Count empty bitsets stored and check that there are enough
-        //  orientations for the Frank number to make sense. (This should of
-        //  course always be the case.)
-        bitset universe = EMPTY;
-        for(size_t i = 0; i < bitsetsOfDeletableEdges.used; i++) {
-            if(isEmpty(bitsetsOfDeletableEdges.array[i])) {
-                numberOf->emptyBitsetsStored++;
-            }
-            universe = union(universe, bitsetsOfDeletableEdges.array[i]);
-        }
-        if(options->verboseFlag) {
-            fprintf(stderr, "\tEmpty bitsets stored: %llu \n", 
-             numberOf->emptyBitsetsStored);
+//  Listen on socketPath until SIGINT or SIGTERM is received. Returns the exit
+//  status of the program.
+int serve(struct options *options, char *socketPath, size_t maxRequestSize,
+ long int timeout) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: socket path is too long.\n");
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath);
+    int listeningSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listeningSocket == -1 || bind(listeningSocket,
+     (struct sockaddr *) &address, sizeof(address)) == -1 ||
+     listen(listeningSocket, SOMAXCONN) == -1) {
+        fprintf(stderr, "Error: could not listen on %s.\n", socketPath);
+        return 1;
+    }
+
+    //  Only the signal thread receives the signals. Writing to a client which
+    //  is gone should not terminate the server.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    pthread_t signalThread;
+    pthread_create(&signalThread, NULL, waitForSignal, &listeningSocket);
+
+    struct server server = {.lock = PTHREAD_MUTEX_INITIALIZER,
+     .jobAvailable = PTHREAD_COND_INITIALIZER, .options = options,
+     .maxRequestSize = maxRequestSize, .timeout = timeout};
+    struct serverWorker *workers = malloc(sizeof(struct serverWorker)*
+     options->numberOfThreads);
+    if(workers == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    for(int i = 0; i < options->numberOfThreads; i++) {
+        workers[i] = (struct serverWorker) {.server = &server,
+         .options = *options,
+         .context = fn_context_new(fn_max_heuristic_vertices())};
+        if(workers[i].context == NULL ||
+         pthread_create(&workers[i].thread, NULL, runServerWorker,
+         &workers[i])) {
+            fprintf(stderr, "Error: could not create worker.\n");
+            exit(1);
+        }
+    }
+    fprintf(stderr, "Listening on %s with %d worker%s.\n", socketPath,
+     options->numberOfThreads, options->numberOfThreads == 1 ? "" : "s");
+
+    int clientSocket;
+    while((clientSocket = accept(listeningSocket, NULL, NULL)) != -1) {
+        struct serverConnection *connection =
+         malloc(sizeof(struct serverConnection));
+        pthread_t thread;
+        if(connection == NULL) {
+            close(clientSocket);
+            continue;
         }
-        if(!equals(universe, complement(EMPTY, 3*numberOfVertices/2))) {
-            fprintf(stderr, "%s\n",
-             "Error: Not enough orientations for Frank number to make sense.");
+        *connection = (struct serverConnection) {.server = &server,
+         .socket = clientSocket};
+        if(pthread_create(&thread, NULL, handleConnection, connection)) {
+            close(clientSocket);
+            free(connection);
+            continue;
         }
+        pthread_detach(thread);
     }
-
-    freeArray(&bitsetsOfDeletableEdges);
-    free(orientation.adjacencyList);
-    free(orientation.reverseAdjacencyList);
-    return frankNumber;
+    close(listeningSocket);
+    unlink(socketPath);
+    pthread_join(signalThread, NULL);
+    fprintf(stderr, "Stopped listening on %s.\n", socketPath);
+    return 0;
 }
 
 //******************************************************************************
 //
-//                              Heuristic algorithm
+//                          Distributed batch runs
 //
 //******************************************************************************
 
-//  Array and bitset representation of a cycle.
-struct cycle {
-    bitset cycleElements;
-    int numberOfElements;
-    int *cycle;
+//  With --coordinate the program does not check graphs itself. It reads the
+//  input in chunks of consecutive graphs and leases them to worker processes,
+//  started with --work-for, which connect to it over a Unix domain socket or
+//  TCP. The coordinator sends
+//
+//      chunk number flags count
+//
+//  followed by count graph6 lines, where flags are the fn_check() flags of the
+//  algorithm. The worker answers with the single line
+//
+//      result number results counters
+//
+//  where results contains one character for every graph of the chunk: 2 if it
+//  has Frank number 2, 0 if not and i if it is invalid. The counters are the
+//  fn_counters of the chunk in declaration order followed by the number of
+//  cached results. A worker gets a new chunk after every result and the line
+//  "done" once all graphs are checked. If the connection of a worker is lost
+//  before its result arrived, its chunk is leased to the next worker asking
+//  for one. Graphs are written in input order.
+
+#define DEFAULT_CHUNK_SIZE 64
+#define CONNECT_ATTEMPTS 100
+#define CONNECT_INTERVAL_NS 100000000
+
+//  Only the flags selecting the algorithm are sent to the workers.
+#define ALGORITHM_FLAGS (FN_ONLY_HEURISTIC | FN_ONLY_EXACT | FN_BRUTE_FORCE |\
+ FN_DOUBLE_CHECK)
+
+#define NUMBER_OF_COUNTER_FIELDS 13
+
+struct chunk {
+    unsigned long long int number;
+    char **graphStrings;
+    int numberOfGraphs;
+
+    //  One character per graph as in the protocol, NULL until the result
+    //  arrived.
+    char *results;
+    struct chunk *nextInOrder;
+    struct chunk *nextInQueue;
 };
 
-//  Count the odd cycles in a complement of the perfect F F. Assuming
-//  graphs to be cubic and bridgeless. We also store for each even cycle a
-//  maximal F in M.
-bool containsTwoOddCycles(bitset adjacencyList[], int numberOfVertices,
- int F[], struct cycle oddCycles[], int M[]) {
+struct coordinator {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct options *options;
+    int checkFlags;
+    int chunkSize;
+    int listeningSocket;
+    bool endOfInput;
+    bool finished;
+
+    //  Chunks which were read but not written yet, in input order.
+    struct chunk *oldestChunk;
+    struct chunk *newestChunk;
+
+    //  Chunks waiting to be leased.
+    struct chunk *queueHead;
+    struct chunk *queueTail;
+
+    unsigned long long int numberOfChunks;
+    unsigned long long int repeatedLeases;
+    int connectedWorkers;
+    int numberOfWorkers;
+
+    //  Same bookkeeping as checkGraphsInBatches().
+    struct fn_counters *numberOf;
+    long long unsigned int *cachedResults;
+    unsigned long long int *totalGraphs;
+    unsigned long long int *counter;
+    unsigned long long int *skippedGraphs;
+    unsigned long long int *passedGraphs;
+};
 
-    for(int i = 0; i < numberOfVertices; i++) {
-        M[i] = -1;
-    }
-    int numberOfOddCycles = 0;
-    bitset uncheckedVertices = complement(EMPTY, numberOfVertices);
-
-    //  Loop over all cycles and check parity
-    //  Store the odd edges of each cycle in M
-    forEach(element, uncheckedVertices) {
-        int currentVertex = element;
-        int previousVertex = -1;
-        bool cycleIsOdd = false;
-        bitset cycle = EMPTY;
-        if(numberOfOddCycles < 2) {
-            oddCycles[numberOfOddCycles].numberOfElements = 0;
-        }
-        do {
-            removeElement(uncheckedVertices, currentVertex);
-            add(cycle, currentVertex);
-            if(numberOfOddCycles < 2) {
-                oddCycles[numberOfOddCycles].cycle[
-                 oddCycles[numberOfOddCycles].numberOfElements++] = 
-                 currentVertex;
-            }
-            int nextVertex = next(adjacencyList[currentVertex], -1);
-            while(nextVertex == previousVertex ||
-             nextVertex == F[currentVertex]) {
-                nextVertex = next(adjacencyList[currentVertex], nextVertex);
-            }
-            if(M[currentVertex] == -1) {
-                M[currentVertex] = nextVertex;
-                M[nextVertex] = currentVertex;
-            }
-            previousVertex = currentVertex;
-            currentVertex = nextVertex;
-            cycleIsOdd = !cycleIsOdd;
-        } while(currentVertex != element);
-
-        if(cycleIsOdd) {
-            if(numberOfOddCycles < 2) {
-                oddCycles[numberOfOddCycles].cycleElements = cycle;
-            }
-            numberOfOddCycles++;
-            if(numberOfOddCycles > 2) {
-                return false;
-            }
-        }   
-    }
-    return numberOfOddCycles == 2;
-}
+struct workerConnection {
+    struct coordinator *coordinator;
+    int socket;
+};
 
-//  Add maximal F of odd cycles - x1 - x2 to M.
-void getOddCycleMatching(bitset adjacencyList[], int numberOfVertices,
- struct cycle oddCycles[], int indexOfx1, int indexOfx2, int M[]) {
-
-    int currentIndex = indexOfx1;
-    bool addToMatching = false;
-    do { 
-        int nextIndex = (currentIndex + 1) % oddCycles[0].numberOfElements;
-        if(addToMatching) {
-            M[oddCycles[0].cycle[nextIndex]] = oddCycles[0].cycle[currentIndex];
-            M[oddCycles[0].cycle[currentIndex]] = oddCycles[0].cycle[nextIndex];
-        }
-        addToMatching = !addToMatching;
-        currentIndex = nextIndex;
-    } while(currentIndex != indexOfx1);
-
-    currentIndex = indexOfx2;
-    addToMatching = false;
-    do { 
-        int nextIndex = (currentIndex + 1) % oddCycles[1].numberOfElements;
-        if(addToMatching) {
-            M[oddCycles[1].cycle[nextIndex]] = oddCycles[1].cycle[currentIndex];
-            M[oddCycles[1].cycle[currentIndex]] = oddCycles[1].cycle[nextIndex];
-        }
-        addToMatching = !addToMatching;
-        currentIndex = nextIndex;
-    } while(currentIndex != indexOfx2);
+//  The counters in the order in which they are sent.
+void getCounterFields(struct fn_counters *counters,
+ long long unsigned int *fields[]) {
+    long long unsigned int *orderedFields[NUMBER_OF_COUNTER_FIELDS] = {
+     &counters->generatedOrientations, &counters->storedBitsets,
+     &counters->orientationsGivingSubset, &counters->complementaryBitsets,
+     &counters->emptyBitsetsStored, &counters->orientationsGivingSuperset,
+     &counters->mostGeneratedOrientations, &counters->mostStoredBitsets,
+     &counters->graphsSatisfyingOddnessCondition,
+     &counters->graphsNotSatisfyingOddnessCondition,
+     &counters->graphsSatisfyingFirstOddness,
+     &counters->graphsSatisfyingSecondOddness,
+     &counters->totalOrientationsGenerated};
+    memcpy(fields, orderedFields, sizeof(orderedFields));
 }
 
-//  Find the index of u in arr[].
-int findInArray(int u, int arr[], int arrLength) {
-    for(int i = 0; i < arrLength; i++) {
-        if(arr[i] == u) {
-            return i;
+//  Addresses containing a '/' or no ':' are paths of Unix domain sockets,
+//  others are host:port for TCP. An empty host means all interfaces when
+//  listening and the local host when connecting. Returns the socket or -1.
+int openSocket(char *address, bool listening) {
+    char *colon = strrchr(address, ':');
+    if(strchr(address, '/') != NULL || colon == NULL) {
+        struct sockaddr_un unixAddress = {.sun_family = AF_UNIX};
+        if(strlen(address) >= sizeof(unixAddress.sun_path)) {
+            return -1;
+        }
+        strcpy(unixAddress.sun_path, address);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd == -1) {
+            return -1;
+        }
+        bool failed = listening ?
+         bind(fd, (struct sockaddr *) &unixAddress, sizeof(unixAddress)) == -1
+         || listen(fd, SOMAXCONN) == -1 :
+         connect(fd, (struct sockaddr *) &unixAddress,
+         sizeof(unixAddress)) == -1;
+        if(failed) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    char host[colon - address + 1];
+    memcpy(host, address, colon - address);
+    host[colon - address] = '\0';
+    struct addrinfo hints = {.ai_family = AF_UNSPEC,
+     .ai_socktype = SOCK_STREAM, .ai_flags = listening ? AI_PASSIVE : 0};
+    struct addrinfo *addresses;
+    if(getaddrinfo(host[0] == '\0' ? NULL : host, colon + 1, &hints,
+     &addresses) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for(struct addrinfo *info = addresses; info != NULL && fd == -1;
+     info = info->ai_next) {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if(fd == -1) {
+            continue;
+        }
+        int enable = 1;
+        setsockopt(fd, SOL_SOCKET, listening ? SO_REUSEADDR : SO_KEEPALIVE,
+         &enable, sizeof(enable));
+        bool failed = listening ?
+         bind(fd, info->ai_addr, info->ai_addrlen) == -1 ||
+         listen(fd, SOMAXCONN) == -1 :
+         connect(fd, info->ai_addr, info->ai_addrlen) == -1;
+        if(failed) {
+            close(fd);
+            fd = -1;
         }
     }
-    return -1;
+    freeaddrinfo(addresses);
+    return fd;
 }
 
-// Check if orientation of F - {x1,x2,(y1,y2)} is consistent on the cycle
-// containing u and v.
-bool circuitOrientationIsConsistent(bitset adjacencyList[],
- int numberOfVertices, int M[], int F[], 
- int circuitOrientation[], int u, int v) {
-
-    //  If circuit containing u of F - {x1,x2,(y1,y2)} not yet oriented, orient
-    //  it.
-    if(circuitOrientation[u] == -1) {
-
-        //  Orient the edges incident to u such that they are consistent with
-        //  the edges incident to v on the cycle containing u and v. If
-        //  circuitOrientation[v] is still -1, the direction we orient the
-        //  edges incident with u does not matter. 
-        int takeMaximalMatching = (circuitOrientation[v] == F[v]);
-        int currentVertex = u;
-        do {
-            int nextVertex = takeMaximalMatching ? M[currentVertex] : 
-             F[currentVertex];
-            circuitOrientation[currentVertex] = nextVertex;
-            currentVertex = nextVertex;
-            takeMaximalMatching = !takeMaximalMatching;
-        } while (currentVertex != u);
-    }
-
-    if(circuitOrientation[v] == -1) {
-        int takeMaximalMatching = (circuitOrientation[u] == F[u]);
-        int currentVertex = v;
-        do {
-            int nextVertex = takeMaximalMatching ? M[currentVertex] :
-             F[currentVertex];
-            circuitOrientation[currentVertex] = nextVertex;
-            currentVertex = nextVertex;
-            takeMaximalMatching = !takeMaximalMatching;
-        } while (currentVertex != v);
-    }
-    return (circuitOrientation[u] == F[u]) == (circuitOrientation[v] == M[v]);
-}
+//  Read the next chunk of graphs belonging to the res/mod class and queue it.
+//  Returns false at the end of the input. Call with the lock held.
+bool readChunk(struct coordinator *coordinator) {
+    struct options *options = coordinator->options;
+    struct chunk *chunk = malloc(sizeof(struct chunk));
+    char **graphStrings = malloc(sizeof(char *)*coordinator->chunkSize);
+    if(chunk == NULL || graphStrings == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    *chunk = (struct chunk) {.number = coordinator->numberOfChunks,
+     .graphStrings = graphStrings};
+    while(chunk->numberOfGraphs < coordinator->chunkSize) {
+        char *graphString = NULL;
+        size_t size;
+        ssize_t length = getline(&graphString, &size, stdin);
+        if(length == -1) {
+            free(graphString);
+            coordinator->endOfInput = true;
+            break;
+        }
+        (*coordinator->totalGraphs)++;
+        if((*coordinator->totalGraphs - 1) % options->modulo !=
+         options->remainder) {
+            free(graphString);
+            continue;
+        }
 
-//  If we are checking the heuristic with the even cycle, M might not be a
-//  correct maximal matching of this even cycle. Redo it.
-void rematch(bitset adjacencyList[], int numberOfVertices, int M[], int F[],
- int y1, int y2) {
-    int previousVertex = y2;
-    int currentVertex = y1;
-    bool addToMaximalMatching = false;
-    do {
-        int nextVertex = next(difference(adjacencyList[currentVertex], 
-         union(singleton(F[currentVertex]), singleton(previousVertex))), -1);
-        if(addToMaximalMatching) {
-            M[currentVertex] =  nextVertex;
-            M[nextVertex] = currentVertex;
-        }
-        previousVertex = currentVertex;
-        currentVertex = nextVertex;
-        addToMaximalMatching = !addToMaximalMatching; 
-    } while(currentVertex != y2);
-
-    M[y1] = y2;
-    M[y2] = y1;
+        //  Every graph occupies exactly one line of the protocol.
+        if(graphString[length - 1] != '\n') {
+            char *terminatedString = realloc(graphString, length + 2);
+            if(terminatedString == NULL) {
+                fprintf(stderr, "Error: out of memory\n");
+                exit(1);
+            }
+            graphString = terminatedString;
+            strcpy(graphString + length, "\n");
+        }
+        graphStrings[chunk->numberOfGraphs++] = graphString;
+    }
+    if(chunk->numberOfGraphs == 0) {
+        free(graphStrings);
+        free(chunk);
+        return false;
+    }
+    coordinator->numberOfChunks++;
+    if(coordinator->newestChunk == NULL) {
+        coordinator->oldestChunk = chunk;
+    }
+    else {
+        coordinator->newestChunk->nextInOrder = chunk;
+    }
+    coordinator->newestChunk = chunk;
+    if(coordinator->queueTail == NULL) {
+        coordinator->queueHead = chunk;
+    }
+    else {
+        coordinator->queueTail->nextInQueue = chunk;
+    }
+    coordinator->queueTail = chunk;
+    return true;
 }
 
-//  For checking cyclic connectivity.
-void DFS(bitset adjacencyList[], int numberOfVertices, bitset *component,
- bitset *uncheckedVertices, int v, int parent, bool *cycleFound) {
-
-    //  If checked before: cycle found.
-    if(contains(*component, v)) {
-        *cycleFound = true;
+//  Once all chunks are written, stop accepting workers and wake up the ones
+//  waiting for a chunk. Call with the lock held.
+void checkIfFinished(struct coordinator *coordinator) {
+    if(coordinator->finished || !coordinator->endOfInput ||
+     coordinator->oldestChunk != NULL) {
         return;
     }
-    removeElement(*uncheckedVertices, v);
-    add(*component, v);
-
-    //  Do not go back to parent.
-    forEach(nbr, difference(adjacencyList[v], singleton(parent))) {
-        DFS(adjacencyList, numberOfVertices, component, uncheckedVertices, nbr,
-         v, cycleFound);
-    } 
+    coordinator->finished = true;
+    shutdown(coordinator->listeningSocket, SHUT_RDWR);
+    pthread_cond_broadcast(&coordinator->changed);
 }
 
-bool isCyclicallyConnected(bitset adjacencyList[], int numberOfVertices) {
-    bitset uncheckedVertices = complement(EMPTY, numberOfVertices);
-    int numberOfComponents = 0;
-    int numberOfComponentsWithCycle = 0;
-    bitset components[numberOfVertices];
-    forEach(v, uncheckedVertices) {
-        numberOfComponents++;
-        components[numberOfComponents - 1] = EMPTY;
-        bool cycleFound = false;
-        DFS(adjacencyList, numberOfVertices, &components[numberOfComponents - 1],
-         &uncheckedVertices, v, -1, &cycleFound);
-        if(cycleFound) {
-            numberOfComponentsWithCycle++;
+//  Returns the next chunk which needs to be checked or NULL if all chunks were
+//  checked. Waits while all remaining chunks are leased to other workers.
+struct chunk *leaseChunk(struct coordinator *coordinator) {
+    pthread_mutex_lock(&coordinator->lock);
+    while(coordinator->queueHead == NULL && !coordinator->finished) {
+        if(coordinator->endOfInput || !readChunk(coordinator)) {
+            checkIfFinished(coordinator);
+            if(!coordinator->finished) {
+                pthread_cond_wait(&coordinator->changed, &coordinator->lock);
+            }
         }
-        if(numberOfComponentsWithCycle >= 2) {
-            return false;
+    }
+    struct chunk *chunk = coordinator->queueHead;
+    if(chunk != NULL) {
+        coordinator->queueHead = chunk->nextInQueue;
+        if(coordinator->queueHead == NULL) {
+            coordinator->queueTail = NULL;
         }
+        chunk->nextInQueue = NULL;
     }
-    return true;
+    pthread_mutex_unlock(&coordinator->lock);
+    return chunk;
 }
 
-#define removeEdgeFromAdjList(adjacencyList, endpoint1, endpoint2) {\
-    removeElement(adjacencyList[endpoint1], endpoint2);\
-    removeElement(adjacencyList[endpoint2],endpoint1);\
-}
-#define addEdgeToAdjList(adjacencyList, endpoint1, endpoint2) {\
-    add(adjacencyList[endpoint1], endpoint2);\
-    add(adjacencyList[endpoint2],endpoint1);\
+//  The worker of the chunk is gone. Put the chunk at the front of the queue.
+void returnChunk(struct coordinator *coordinator, struct chunk *chunk) {
+    pthread_mutex_lock(&coordinator->lock);
+    if(coordinator->options->verboseFlag) {
+        fprintf(stderr, "Lost the worker of chunk %llu, leasing it again.\n",
+         chunk->number);
+    }
+    coordinator->repeatedLeases++;
+    chunk->nextInQueue = coordinator->queueHead;
+    coordinator->queueHead = chunk;
+    if(coordinator->queueTail == NULL) {
+        coordinator->queueTail = chunk;
+    }
+    pthread_cond_broadcast(&coordinator->changed);
+    pthread_mutex_unlock(&coordinator->lock);
 }
 
-//  Check if edge is a strong 2-edge under the assumption it is valuated 2 in
-//  the flow. Hence, we only check it is not part of some cycle-separating
-//  3-edge-set containing two other edges from circuitOrientation (This is a
-//  sufficient condition.)
-bool edgeIsStrong2Edge(bitset adjacencyList[], int numberOfVertices,
- int endpoint1, int endpoint2, int circuitOrientation[]) {
-    bool hasCyclic211cut = false;
-    removeEdgeFromAdjList(adjacencyList, endpoint1, endpoint2);
-
-    //  Loop over all pairs of edges in the perfect F.
-    for(int i = 0; i < numberOfVertices; i++) {
-
-        //  Should not look at edge we already suppressed.
-        if(circuitOrientation[i] == -1) {
-            continue;
-        }
-        removeEdgeFromAdjList(adjacencyList, i, circuitOrientation[i]);
-
-        for(int j = i+1; j < numberOfVertices; j++) {
-            if(circuitOrientation[j] == -1) {
-                continue;
-            }
-            removeEdgeFromAdjList(adjacencyList, j, circuitOrientation[j]);
-
-            if(!isCyclicallyConnected(adjacencyList, numberOfVertices)) {
-                hasCyclic211cut = true;
+//  Store the results of the chunk and write all chunks whose predecessors are
+//  written.
+void completeChunk(struct coordinator *coordinator, struct chunk *chunk,
+ char *results, struct fn_counters *counters,
+ long long unsigned int cachedResults) {
+    pthread_mutex_lock(&coordinator->lock);
+    chunk->results = results;
+    mergeCounters(coordinator->numberOf, counters);
+    *coordinator->cachedResults += cachedResults;
+    while(coordinator->oldestChunk != NULL &&
+     coordinator->oldestChunk->results != NULL) {
+        struct chunk *oldest = coordinator->oldestChunk;
+        for(int i = 0; i < oldest->numberOfGraphs; i++) {
+            if(oldest->results[i] == 'i') {
+                (*coordinator->skippedGraphs)++;
             }
-            addEdgeToAdjList(adjacencyList, j, circuitOrientation[j]);
-
-            if(hasCyclic211cut) {
-                break;
+            else {
+                (*coordinator->counter)++;
+                if(writeGraph(oldest->graphStrings[i],
+                 oldest->results[i] == '2' ? 2 : 0, coordinator->options)) {
+                    (*coordinator->passedGraphs)++;
+                }
             }
+            free(oldest->graphStrings[i]);
         }
-
-        addEdgeToAdjList(adjacencyList, i, circuitOrientation[i]);
-        if(hasCyclic211cut) {
-            break;
+        coordinator->oldestChunk = oldest->nextInOrder;
+        if(coordinator->oldestChunk == NULL) {
+            coordinator->newestChunk = NULL;
         }
+        free(oldest->graphStrings);
+        free(oldest->results);
+        free(oldest);
     }
-    addEdgeToAdjList(adjacencyList, endpoint1, endpoint2);
-    return !hasCyclic211cut;
+    checkIfFinished(coordinator);
+    pthread_mutex_unlock(&coordinator->lock);
 }
 
-//  Are the suppressed strong 2-edges in the nz 4-flow deletable?
-bool suppressedEdgesAreDeletable(bitset adjacencyList[], int numberOfVertices,
- int circuitOrientation[], int edgesBetweenCycles[],
- int numberOfEdgesBetweenCycles) {
-    bool edgesAreDeletable = true;
-    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
-        removeEdgeFromAdjList(adjacencyList, edgesBetweenCycles[2*i],
-         edgesBetweenCycles[2*i+1]);
-    }
-    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
-        if(!edgeIsStrong2Edge(adjacencyList, numberOfVertices,
-         edgesBetweenCycles[2*i], next(adjacencyList[edgesBetweenCycles[2*i]], 
-         -1), circuitOrientation)){
-            edgesAreDeletable = false;
-            break;
+//  Parse the result line of the worker. Returns the results of the chunk or
+//  NULL if the line is invalid.
+char *parseChunkResult(char *line, struct chunk *chunk,
+ struct fn_counters *counters, long long unsigned int *cachedResults) {
+    unsigned long long int number;
+    int offset;
+    if(sscanf(line, "result %llu %n", &number, &offset) != 1 ||
+     number != chunk->number) {
+        return NULL;
+    }
+    char *position = line + offset;
+    if(strspn(position, "02i") != (size_t) chunk->numberOfGraphs ||
+     position[chunk->numberOfGraphs] != ' ') {
+        return NULL;
+    }
+    long long unsigned int *fields[NUMBER_OF_COUNTER_FIELDS];
+    getCounterFields(counters, fields);
+    char *end = position + chunk->numberOfGraphs;
+    for(int i = 0; i <= NUMBER_OF_COUNTER_FIELDS; i++) {
+        char *start = end;
+        long long unsigned int value = strtoull(start, &end, 10);
+        if(end == start) {
+            return NULL;
+        }
+        *(i < NUMBER_OF_COUNTER_FIELDS ? fields[i] : cachedResults) = value;
+    }
+
+    //  A worker which died while sending leaves an incomplete line.
+    if(strcmp(end, "\n") != 0) {
+        return NULL;
+    }
+    char *results = malloc(chunk->numberOfGraphs);
+    if(results == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    memcpy(results, position, chunk->numberOfGraphs);
+    return results;
+}
+
+//  Lease chunks to one worker until all chunks are checked or the connection
+//  is lost.
+void *handleWorkerConnection(void *arg) {
+    struct workerConnection *connection = arg;
+    struct coordinator *coordinator = connection->coordinator;
+    FILE *input = fdopen(connection->socket, "r");
+    FILE *output = fdopen(dup(connection->socket), "w");
+    bool connected = input != NULL && output != NULL;
+    char *line = NULL;
+    size_t size = 0;
+    struct chunk *chunk;
+    while(connected && (chunk = leaseChunk(coordinator)) != NULL) {
+        fprintf(output, "chunk %llu %d %d\n", chunk->number,
+         coordinator->checkFlags, chunk->numberOfGraphs);
+        for(int i = 0; i < chunk->numberOfGraphs; i++) {
+            fputs(chunk->graphStrings[i], output);
+        }
+        struct fn_counters counters = {0};
+        long long unsigned int cachedResults = 0;
+        char *results = NULL;
+        connected = fflush(output) != EOF &&
+         getline(&line, &size, input) != -1 &&
+         (results = parseChunkResult(line, chunk, &counters, &cachedResults))
+         != NULL;
+        if(connected) {
+            completeChunk(coordinator, chunk, results, &counters,
+             cachedResults);
         }
-        if(!edgeIsStrong2Edge(adjacencyList, numberOfVertices,
-         edgesBetweenCycles[2*i+1], next(
-         adjacencyList[edgesBetweenCycles[2*i+1]], -1), circuitOrientation)){
-            edgesAreDeletable = false;
-            break;
+        else {
+            returnChunk(coordinator, chunk);
         }
     }
-    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
-        addEdgeToAdjList(adjacencyList, edgesBetweenCycles[2*i],
-         edgesBetweenCycles[2*i+1]);
+    if(connected) {
+        fprintf(output, "done\n");
+        fflush(output);
     }
-    return edgesAreDeletable;
-}
+    free(line);
+    if(input != NULL) {
+        fclose(input);
+    }
+    else {
+        close(connection->socket);
+    }
+    if(output != NULL) {
+        fclose(output);
+    }
+    free(connection);
 
-//  Used for double checking heuristic algorithm.
-void verifyOddnessHeuristicOrientations(bitset adjacencyList[],
- int numberOfVertices, struct options *options, int circuitOrientation[], 
- int F[], int M[], int edgesBetweenCycles[], int numberOfEdgesBetweenCycles); 
-
-// Generate all perfect matchings of the graph and check for each of the
-// complementary 2-factors whether one of the configurations for the sufficient
-// conditions are present.
-bool hasSufficientCondition(bitset adjacencyList[], int numberOfVertices,
- struct options *options, struct counters *numberOf, bitset remainingVertices,
- int F[]) {
-
-    //  If this holds, F is a perfect matching.
-    int nextVertex = next(remainingVertices, -1);
-    if(nextVertex == -1) {
-
-        struct cycle oddCycles[2];
-        oddCycles[0].cycle = malloc(sizeof(int)*numberOfVertices);
-        oddCycles[1].cycle = malloc(sizeof(int)*numberOfVertices);
-        int M[numberOfVertices];
-        if(containsTwoOddCycles(adjacencyList, numberOfVertices, F, oddCycles,
-         M)) {
-
-            //  Check if odd cycles are connected via an edge uv
-            forEach(u, oddCycles[0].cycleElements) {
-                int v = F[u];
-                if(contains(oddCycles[1].cycleElements, v)) {
-                    int indexOfx1 = findInArray(u, oddCycles[0].cycle,
-                     oddCycles[0].numberOfElements);
-                    int indexOfx2 = findInArray(v, oddCycles[1].cycle,
-                     oddCycles[1].numberOfElements);
-
-                    //  Add a maximal matching of the odd cycles to the maximal
-                    //  matching M of G - F
-                    getOddCycleMatching(adjacencyList, numberOfVertices,
-                     oddCycles, indexOfx1, indexOfx2, M);
-
-                    int u1 = oddCycles[0].cycle[
-                        (indexOfx1 + 1) % oddCycles[0].numberOfElements];
-                    int u2 = oddCycles[1].cycle[
-                        (indexOfx2 + 1) % oddCycles[1].numberOfElements];
-                    int v1 = oddCycles[0].cycle[
-                        (oddCycles[0].numberOfElements + indexOfx1 - 1) % 
-                        oddCycles[0].numberOfElements];
-                    int v2 = oddCycles[1].cycle[
-                        (oddCycles[1].numberOfElements + indexOfx2 - 1) % 
-                        oddCycles[1].numberOfElements];                    
-                    
-                    //  Orient cycles of F and check condition
-                    int circuitOrientation[numberOfVertices];
-                    //  Can be optimized!
-                    for(int i = 0; i < numberOfVertices; i++) {
-                        circuitOrientation[i] = -1;
-                    }
-                    if(circuitOrientationIsConsistent(adjacencyList,
-                     numberOfVertices, M, F, circuitOrientation,
-                     u1, v1) && 
-                     circuitOrientationIsConsistent(adjacencyList, 
-                     numberOfVertices, M, F, circuitOrientation, 
-                     u2, v2)) {
-                        int edgesBetweenCycles[] = {u,v};
-                        if(suppressedEdgesAreDeletable(adjacencyList,
-                         numberOfVertices, circuitOrientation,
-                         edgesBetweenCycles, 1)) {
-                            numberOf->graphsSatisfyingFirstOddness++;
-                            if(options->doublecheckFlag || options->printFlag) {
-                                verifyOddnessHeuristicOrientations(
-                                 adjacencyList, numberOfVertices, options,
-                                 circuitOrientation, F, M, edgesBetweenCycles,
-                                 1);
-                            }
-                            free(oddCycles[0].cycle);
-                            free(oddCycles[1].cycle);
-                            return true;
-                        }
-                        if(options->verboseFlag) {
-                            fprintf(stderr, "Not deletable: first\n");
-                        }
-                    }
-                    continue;
-                }
-                if(!contains(oddCycles[0].cycleElements, v)) {
-                    int nbrOfU = v;
-                    forEach(nbrOfV, adjacencyList[nbrOfU]) {
-                        if(nbrOfV == u) {
-                            continue;
-                        }
-                        v = next(intersection(adjacencyList[nbrOfV],
-                         oddCycles[1].cycleElements),-1);
-                        if(v == -1) {
-                            continue;
-                        }
-                        int indexOfx1 = findInArray(u, oddCycles[0].cycle,
-                         oddCycles[0].numberOfElements);
-                        int indexOfx2 = findInArray(v, oddCycles[1].cycle,
-                         oddCycles[1].numberOfElements);
-                        getOddCycleMatching(adjacencyList, numberOfVertices,
-                         oddCycles, indexOfx1, indexOfx2, M);
-                        int u1 = oddCycles[0].cycle[(indexOfx1 + 1) %
-                         oddCycles[0].numberOfElements];
-                        int u2 = oddCycles[1].cycle[(indexOfx2 + 1) %
-                         oddCycles[1].numberOfElements];
-                        int v1 = oddCycles[0].cycle[
-                         (oddCycles[0].numberOfElements + indexOfx1 - 1) % 
-                         oddCycles[0].numberOfElements];
-                        int v2 = oddCycles[1].cycle[
-                         (oddCycles[1].numberOfElements + indexOfx2 - 1) %
-                         oddCycles[1].numberOfElements];
-                        int w1 = next(difference(adjacencyList[nbrOfU],
-                         union(singleton(nbrOfV), singleton(F[nbrOfU]))),-1);  
-                        int w2 = next(difference(adjacencyList[nbrOfV],
-                         union(singleton(nbrOfU), singleton(F[nbrOfV]))), -1);     
-                        
-                        //  Orient cycles and check condition
-                        int circuitOrientation[numberOfVertices];
-                        for(int i = 0; i < numberOfVertices; i++) {
-                            circuitOrientation[i] = -1;
-                        }
-
-                        //  Adapt the matching of the even cycle such that M is
-                        //  still maximal in C - {x1,x2,y1,y2}
-                        if(M[nbrOfU] != nbrOfV) {
-                            rematch(adjacencyList, numberOfVertices, M, F,
-                             nbrOfU, nbrOfV);
-                        }
-
-                        //  Check if orientations are consistent
-                        if(circuitOrientationIsConsistent(adjacencyList,
-                         numberOfVertices, M, F, circuitOrientation, u1, v1) && 
-                         circuitOrientationIsConsistent(adjacencyList, 
-                         numberOfVertices, M, F, circuitOrientation, u2, v2) && 
-                         circuitOrientationIsConsistent(adjacencyList, 
-                         numberOfVertices, M, F, circuitOrientation, w1, w2)) {
-                            int edgesBetweenCycles[] = {u, nbrOfU, nbrOfV, v};
-                            if(suppressedEdgesAreDeletable(adjacencyList,
-                             numberOfVertices, circuitOrientation,
-                             edgesBetweenCycles, 2)) {
-                                numberOf->graphsSatisfyingSecondOddness++;
-                                if(options->doublecheckFlag || 
-                                 options->printFlag) {
-                                    verifyOddnessHeuristicOrientations(
-                                     adjacencyList, numberOfVertices, options,
-                                     circuitOrientation, F, M,
-                                     edgesBetweenCycles, 2);
-                                }
-                                free(oddCycles[0].cycle);
-                                free(oddCycles[1].cycle);
-                                return true;
-                            }
-                            if(options->verboseFlag) {
-                                fprintf(stderr, "Not deletable\n");
-                            }
-                        }
-                        continue;
-                    }
-                }
-            }
-        }
+    pthread_mutex_lock(&coordinator->lock);
+    coordinator->connectedWorkers--;
+    pthread_cond_broadcast(&coordinator->changed);
+    pthread_mutex_unlock(&coordinator->lock);
+    return NULL;
+}
 
-        //  None of the configurations were present for this perfect matching.
-        free(oddCycles[0].cycle);
-        free(oddCycles[1].cycle);
+//  Read graphs from stdin and let workers connecting to address check them.
+//  Same bookkeeping as checkGraphsInBatches(). Returns false if address
+//  cannot be used.
+bool coordinateWorkers(struct options *options, char *address, int chunkSize,
+ struct fn_counters *numberOf, long long unsigned int *cachedResults,
+ unsigned long long int *totalGraphs, unsigned long long int *counter,
+ unsigned long long int *skippedGraphs, unsigned long long int *passedGraphs) {
+    struct coordinator coordinator = {.lock = PTHREAD_MUTEX_INITIALIZER,
+     .changed = PTHREAD_COND_INITIALIZER, .options = options,
+     .checkFlags = getCheckFlags(options, false) & ALGORITHM_FLAGS,
+     .chunkSize = chunkSize, .numberOf = numberOf,
+     .cachedResults = cachedResults, .totalGraphs = totalGraphs,
+     .counter = counter, .skippedGraphs = skippedGraphs,
+     .passedGraphs = passedGraphs};
+    coordinator.listeningSocket = openSocket(address, true);
+    if(coordinator.listeningSocket == -1) {
+        fprintf(stderr, "Error: could not listen on %s.\n", address);
         return false;
     }
 
-    //  F is not yet a perfect matching here. 
-    forEach(neighbor, intersection(adjacencyList[nextVertex],
-     remainingVertices)) {
-        F[neighbor] = nextVertex;
-        F[nextVertex] = neighbor;
-        bitset newRemainingVertices = difference(remainingVertices,
-         union(singleton(nextVertex), singleton(neighbor)));
-        if(hasSufficientCondition(adjacencyList, numberOfVertices, options,
-         numberOf, newRemainingVertices, F)) {
-            return true;
+    //  Writing to a worker which is gone should not terminate the coordinator.
+    signal(SIGPIPE, SIG_IGN);
+    fprintf(stderr, "Leasing chunks of %d graphs to workers connecting to "
+     "%s.\n", chunkSize, address);
+
+    //  Without any input, no worker needs to connect.
+    pthread_mutex_lock(&coordinator.lock);
+    if(!readChunk(&coordinator)) {
+        checkIfFinished(&coordinator);
+    }
+    pthread_mutex_unlock(&coordinator.lock);
+
+    int workerSocket;
+    while((workerSocket = accept(coordinator.listeningSocket, NULL, NULL))
+     != -1) {
+        struct workerConnection *connection =
+         malloc(sizeof(struct workerConnection));
+        pthread_t thread;
+        if(connection == NULL) {
+            close(workerSocket);
+            continue;
+        }
+        int enable = 1;
+        setsockopt(workerSocket, SOL_SOCKET, SO_KEEPALIVE, &enable,
+         sizeof(enable));
+        *connection = (struct workerConnection) {.coordinator = &coordinator,
+         .socket = workerSocket};
+        pthread_mutex_lock(&coordinator.lock);
+        coordinator.connectedWorkers++;
+        coordinator.numberOfWorkers++;
+        pthread_mutex_unlock(&coordinator.lock);
+        if(pthread_create(&thread, NULL, handleWorkerConnection, connection)) {
+            pthread_mutex_lock(&coordinator.lock);
+            coordinator.connectedWorkers--;
+            pthread_mutex_unlock(&coordinator.lock);
+            close(workerSocket);
+            free(connection);
+            continue;
         }
+        pthread_detach(thread);
     }
-    return false;
-}
 
-//  Make the concrete orientations for double checking the heuristic algorithm.
-void orient2FactorCyclesInComplementaryOrientations(bitset adjacencyList[],
- int F[], int circuitOrientation[], int startingVertex,
- bitset *uncheckedVertices, struct diGraph *orientation1,
- struct diGraph *orientation2) {
-    int currentVertex = startingVertex;
-
-    //  Currentvertex lies on a cycle of the 2-factor. Circuitorientation
-    //  orients an outgoing edge of this cycle from one of the neighbours of
-    //  currentvertex. We want to orient the cycle in this direction. Hence,
-    //  previousvertex should be oriented in the circuitorientation and
-    //  prev->curr should be the direction we are orienting, hence
-    //  circuitOrientation[prev] should be F[prev];
-    int previousVertex = next(difference(adjacencyList[currentVertex],
-     singleton(F[currentVertex])),-1);
-    if(circuitOrientation[previousVertex] == -1 || 
-     circuitOrientation[previousVertex] != F[previousVertex]) {
-        previousVertex = next(difference(adjacencyList[currentVertex],
-         singleton(F[currentVertex])), previousVertex);
-    }
-    do {
-        removeElement((*uncheckedVertices), currentVertex);
-        int nextVertex = next(adjacencyList[currentVertex], -1);
-        while(nextVertex == previousVertex || nextVertex == F[currentVertex]) {
-            nextVertex = next(adjacencyList[currentVertex], nextVertex);
-        }
-        if(circuitOrientation[nextVertex] == currentVertex) {
-            addArc(orientation2, currentVertex, nextVertex);
-            removeArc(orientation2, nextVertex, currentVertex);
-        }
-        else if(circuitOrientation[currentVertex] != nextVertex && 
-         circuitOrientation[nextVertex] != currentVertex) {
-            addArc(orientation1, currentVertex, nextVertex);
-            addArc(orientation2, currentVertex, nextVertex);
-        }
-        previousVertex = currentVertex;
-        currentVertex = nextVertex;
-    } while(currentVertex != startingVertex);
+    //  Let the remaining workers know that there are no more chunks.
+    pthread_mutex_lock(&coordinator.lock);
+    while(coordinator.connectedWorkers > 0) {
+        pthread_cond_wait(&coordinator.changed, &coordinator.lock);
+    }
+    pthread_mutex_unlock(&coordinator.lock);
+    close(coordinator.listeningSocket);
+    if(strchr(address, '/') != NULL || strchr(address, ':') == NULL) {
+        unlink(address);
+    }
+    fprintf(stderr, "Checked %llu chunks using %d worker%s, %llu chunks were "
+     "leased again after their worker was lost.\n", coordinator.numberOfChunks,
+     coordinator.numberOfWorkers, coordinator.numberOfWorkers == 1 ? "" : "s",
+     coordinator.repeatedLeases);
+    return true;
 }
 
-// Make the concrete orientations for double checking the heuristic algorithm.
-void verifyOddnessHeuristicOrientations(bitset adjacencyList[],
- int numberOfVertices, struct options *options, int circuitOrientation[],
- int F[], int M[], int edgesBetweenCycles[], int numberOfEdgesBetweenCycles) {
-
-    struct diGraph orientation1 = {.numberOfVertices = numberOfVertices, 
-     .numberOfArcs = 0};
-    orientation1.adjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    orientation1.reverseAdjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    emptyGraph(&orientation1);
-    struct diGraph orientation2 = {.numberOfVertices = numberOfVertices, 
-     .numberOfArcs = 0};
-    orientation2.adjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    orientation2.reverseAdjacencyList = malloc(sizeof(bitset)*numberOfVertices);
-    emptyGraph(&orientation2);
-
-    // Add arc between u and v and add endpoints to bitset.
-    bitset endpoints = EMPTY;
-    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
-        addArc(&orientation1, edgesBetweenCycles[2*i], 
-         edgesBetweenCycles[2*i+1]);
-        addArc(&orientation2, edgesBetweenCycles[2*i+1], 
-         edgesBetweenCycles[2*i]);
-        add(endpoints, edgesBetweenCycles[2*i]);
-        add(endpoints, edgesBetweenCycles[2*i+1]);
-    }
-
-    //  Add arcs from the circuitOrientation
-    for(int i = 0; i < numberOfVertices; i++) {
+//  Every thread of a worker process has its own connection to the
+//  coordinator and its own context.
+struct remoteWorker {
+    pthread_t thread;
+    char *address;
+    struct options options;
+    struct fn_context *context;
+    long long unsigned int cachedResults;
+    unsigned long long int checkedChunks;
+    unsigned long long int checkedGraphs;
+    bool failed;
+};
 
-        //  If i is one of the endpoints it does not belong to the circuits.
-        if(contains(endpoints, i)) {
-            continue;
-        }
+//  Use the algorithm selected by the coordinator.
+void applyCheckFlags(struct options *options, int flags) {
+    options->exhaustiveCheckFlag = !(flags & FN_ONLY_HEURISTIC);
+    options->oddCyclesHeuristicFlag = !(flags & FN_ONLY_EXACT);
+    options->bruteForceFlag = flags & FN_BRUTE_FORCE;
+    options->doublecheckFlag = flags & FN_DOUBLE_CHECK;
+}
 
-        //  Some part of the circuits might not yet be oriented. Do this now.
-        if(circuitOrientation[i] == -1) {
-            int takeMaximalMatching = true;
-            int currentVertex = i;
-            do {
-                // fprintf(stderr, "%d\n", currentVertex);
-                int nextVertex = takeMaximalMatching ? M[currentVertex] :
-                 F[currentVertex];
-                circuitOrientation[currentVertex] = nextVertex;
-                currentVertex = nextVertex;
-                takeMaximalMatching = !takeMaximalMatching;
-            } while (currentVertex != i);
+//  Check the graphs of the chunk and send the result line.
+bool checkChunk(struct remoteWorker *worker, FILE *input, FILE *output,
+ unsigned long long int number, int numberOfGraphs) {
+    char *results = malloc(numberOfGraphs + 1);
+    if(results == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    fn_context_reset_counters(worker->context);
+    long long unsigned int cachedResults = 0;
+    char *graphString = NULL;
+    size_t size = 0;
+    int i;
+    for(i = 0; i < numberOfGraphs &&
+     getline(&graphString, &size, input) != -1; i++) {
+        bitset adjacencyList[MAXVERTICES];
+        int numberOfVertices = decodeGraph(graphString, &worker->options,
+         adjacencyList);
+        results[i] = 'i';
+        if(numberOfVertices != -1) {
+            results[i] = checkGraph(graphString, adjacencyList,
+             numberOfVertices, &worker->options, worker->context,
+             &cachedResults, NULL) == 2 ? '2' : '0';
         }
-        addArc(&orientation1, circuitOrientation[i], i);
-        addArc(&orientation2, i, circuitOrientation[i]);
     }
+    free(graphString);
+    if(i < numberOfGraphs) {
+        free(results);
+        return false;
+    }
+    results[numberOfGraphs] = '\0';
+
+    struct fn_counters counters = *fn_context_counters(worker->context);
+    long long unsigned int *fields[NUMBER_OF_COUNTER_FIELDS];
+    getCounterFields(&counters, fields);
+    fprintf(output, "result %llu %s", number, results);
+    for(int j = 0; j < NUMBER_OF_COUNTER_FIELDS; j++) {
+        fprintf(output, " %llu", *fields[j]);
+    }
+    fprintf(output, " %llu\n", cachedResults);
+    free(results);
+    worker->cachedResults += cachedResults;
+    worker->checkedChunks++;
+    worker->checkedGraphs += numberOfGraphs;
+    return fflush(output) != EOF;
+}
 
-    //  Orient 2-factor cycles
-    bitset uncheckedVertices = complement(EMPTY, numberOfVertices);
-
-    // Start orienting cycle at every endpoint of edge on cycle.
-    for(int i = 0; i < 2*numberOfEdgesBetweenCycles; i++) { 
-        if(contains(uncheckedVertices, edgesBetweenCycles[i])) {
-            orient2FactorCyclesInComplementaryOrientations(adjacencyList, F, 
-             circuitOrientation, edgesBetweenCycles[i], &uncheckedVertices,
-             &orientation1, &orientation2);
+void *runRemoteWorker(void *arg) {
+    struct remoteWorker *worker = arg;
+
+    //  The coordinator might not be listening yet.
+    int fd;
+    struct timespec interval = {.tv_nsec = CONNECT_INTERVAL_NS};
+    for(int attempt = 1; (fd = openSocket(worker->address, false)) == -1;
+     attempt++) {
+        if(attempt == CONNECT_ATTEMPTS) {
+            fprintf(stderr, "Error: could not connect to %s.\n",
+             worker->address);
+            worker->failed = true;
+            return NULL;
+        }
+        nanosleep(&interval, NULL);
+    }
+    FILE *input = fdopen(fd, "r");
+    FILE *output = fdopen(dup(fd), "w");
+    worker->failed = true;
+    char *line = NULL;
+    size_t size = 0;
+    while(input != NULL && output != NULL &&
+     getline(&line, &size, input) != -1) {
+        unsigned long long int number;
+        int flags;
+        int numberOfGraphs;
+        if(strcmp(line, "done\n") == 0) {
+            worker->failed = false;
+            break;
+        }
+        if(sscanf(line, "chunk %llu %d %d", &number, &flags,
+         &numberOfGraphs) != 3 || numberOfGraphs < 1) {
+            fprintf(stderr, "Error: invalid message from coordinator.\n");
+            break;
+        }
+        applyCheckFlags(&worker->options, flags);
+        if(!checkChunk(worker, input, output, number, numberOfGraphs)) {
+            break;
         }
     }
-    forEach(element, uncheckedVertices) {
-        orient2FactorCyclesInComplementaryOrientations(adjacencyList, F,
-         circuitOrientation, element, &uncheckedVertices, &orientation1,
-         &orientation2);
+    if(worker->failed) {
+        fprintf(stderr, "Error: lost the connection to %s.\n",
+         worker->address);
     }
-
-    if(!isStronglyConnected(&orientation1) || 
-     !isStronglyConnected(&orientation2)) {
-        fprintf(stderr, 
-         "Error: orientations from oddness 2 heuristic not strongly connected!\n");
-        exit(1);
+    free(line);
+    if(input != NULL) {
+        fclose(input);
     }
-
-    int edgeNumbering[numberOfVertices][numberOfVertices];
-    numberEdges(adjacencyList, numberOfVertices, edgeNumbering);
-    bitset deletableEdges1 = getDeletableEdges(&orientation1, numberOfVertices, 
-     edgeNumbering);
-    bitset deletableEdges2 = getDeletableEdges(&orientation2, numberOfVertices, 
-     edgeNumbering);
-
-    if(options->printFlag) {
-        printDeletableEdges(numberOfVertices, edgeNumbering,
-         orientation1.adjacencyList, deletableEdges1);
-        printDiGraph(&orientation1);
-        printDeletableEdges(numberOfVertices, edgeNumbering, 
-         orientation2.adjacencyList, deletableEdges2);
-        printDiGraph(&orientation2);
+    else {
+        close(fd);
     }
+    if(output != NULL) {
+        fclose(output);
+    }
+    return NULL;
+}
 
-    if(!(equals(union(deletableEdges1, deletableEdges2),
-     complement(EMPTY, 3*numberOfVertices/2)))) {
-        fprintf(stderr, 
-         "Error: orientations from oddness 2 heuristic are not complementary!\n");
+//  Check chunks leased by the coordinator at address using
+//  options->numberOfThreads connections. Returns the exit status of the
+//  program.
+int workForCoordinator(struct options *options, char *address) {
+    signal(SIGPIPE, SIG_IGN);
+    struct remoteWorker *workers = malloc(sizeof(struct remoteWorker)*
+     options->numberOfThreads);
+    if(workers == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
         exit(1);
     }
-
-    free(orientation1.adjacencyList);
-    free(orientation1.reverseAdjacencyList);
-    free(orientation2.adjacencyList);
-    free(orientation2.reverseAdjacencyList);
+    for(int i = 0; i < options->numberOfThreads; i++) {
+        workers[i] = (struct remoteWorker) {.address = address,
+         .options = *options,
+         .context = fn_context_new(fn_max_heuristic_vertices())};
+        if(workers[i].context == NULL ||
+         pthread_create(&workers[i].thread, NULL, runRemoteWorker,
+         &workers[i])) {
+            fprintf(stderr, "Error: could not create worker.\n");
+            exit(1);
+        }
+    }
+    unsigned long long int checkedChunks = 0;
+    unsigned long long int checkedGraphs = 0;
+    long long unsigned int cachedResults = 0;
+    bool failed = false;
+    for(int i = 0; i < options->numberOfThreads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        checkedChunks += workers[i].checkedChunks;
+        checkedGraphs += workers[i].checkedGraphs;
+        cachedResults += workers[i].cachedResults;
+        failed = failed || workers[i].failed;
+        fn_context_free(workers[i].context);
+    }
+    free(workers);
+    fprintf(stderr, "Checked %llu graphs in %llu chunks for %s.\n",
+     checkedGraphs, checkedChunks, address);
+    if(options->cache != NULL) {
+        fprintf(stderr, "Results of %llu graphs were taken from the cache.\n",
+         cachedResults);
+    }
+    return failed ? 1 : 0;
 }
 
+//  Options which only have a long form.
+enum longOption {CACHE_OPTION = 256, DEDUP_OPTION, MAX_REQUEST_OPTION,
+ SERVE_OPTION, TIMEOUT_OPTION, COORDINATE_OPTION, CHUNK_SIZE_OPTION,
+ WORK_FOR_OPTION, CANCEL_FILE_OPTION, STATS_OPTION, SEARCH_PROFILE_OPTION,
+ HARDWARE_COUNTERS_OPTION, TRACE_OPTION, PROGRESS_OPTION,
+ PROGRESS_FILE_OPTION, BUDGET_OPTION, DEFERRED_OPTION, GRAY_CODE_OPTION};
+
+//  Default number of seconds between progress reports.
+#define DEFAULT_PROGRESS_INTERVAL 60
+
+//  Exit status of a shard of -s which was cancelled by another shard.
+#define EXIT_CANCELLED 3
 
 int main(int argc, char ** argv) {
     struct options options = {.bruteForceFlag = false, .complementFlag = false,
      .exhaustiveCheckFlag = true, .doublecheckFlag=false,
      .oddCyclesHeuristicFlag = true, .verboseFlag = false, .printFlag = false, 
      .singleGraphFlag = false, .modulo = 1, .remainder = 0, 
-     .sizeOfArray = 100000};
-    struct counters numberOf = {0};
+     .numberOfThreads = 1, .windowSize = 256};
+    struct fn_counters numberOf = {0};
+    long long unsigned int cachedResults = 0;
+    char *cacheFile = NULL;
+    bool dedupFlag = false;
+    char *socketPath = NULL;
+    size_t maxRequestSize = DEFAULT_MAX_REQUEST_SIZE;
+    long int timeout = 0;
+    char *coordinatorAddress = NULL;
+    int chunkSize = DEFAULT_CHUNK_SIZE;
+    char *workAddress = NULL;
+    char *cancelFile = NULL;
+    struct cancelFlag *cancelFlag = NULL;
+    bool cancelled = false;
+    bool statsFlag = false;
+    bool jsonStatsFlag = false;
+    char *searchProfileFile = NULL;
+    char *traceFile = NULL;
+    bool progressFlag = false;
+    double progressInterval = DEFAULT_PROGRESS_INTERVAL;
+    char *progressFile = NULL;
+    char *deferredFile = NULL;
     int opt;
     while (1) {
         int option_index = 0;
@@ -1532,16 +2172,39 @@ int main(int argc, char ** argv) {
         {   
             {"only-heuristic", no_argument, NULL, '2'},
             {"brute-force", no_argument, NULL, 'b'},
+            {"budget-ms", required_argument, NULL, BUDGET_OPTION},
+            {"cache", required_argument, NULL, CACHE_OPTION},
+            {"cancel-file", required_argument, NULL, CANCEL_FILE_OPTION},
+            {"chunk-size", required_argument, NULL, CHUNK_SIZE_OPTION},
             {"complement", no_argument, NULL, 'c'},
+            {"coordinate", required_argument, NULL, COORDINATE_OPTION},
             {"double-check", no_argument, NULL, 'd'},
+            {"dedup", no_argument, NULL, DEDUP_OPTION},
+            {"deferred", required_argument, NULL, DEFERRED_OPTION},
             {"only-exact", no_argument, NULL, 'e'},
+            {"gray-code", no_argument, NULL, GRAY_CODE_OPTION},
+            {"hardware-counters", no_argument, NULL,
+             HARDWARE_COUNTERS_OPTION},
             {"help", no_argument, NULL, 'h'},
+            {"max-request", required_argument, NULL, MAX_REQUEST_OPTION},
             {"print-orientation", no_argument, NULL, 'p'},
+            {"progress", optional_argument, NULL, PROGRESS_OPTION},
+            {"progress-file", required_argument, NULL, PROGRESS_FILE_OPTION},
+            {"search-profile", required_argument, NULL,
+             SEARCH_PROFILE_OPTION},
+            {"serve", required_argument, NULL, SERVE_OPTION},
             {"single-graph-parallel", no_argument, NULL, 's'},
-            {"verbose", no_argument, NULL, 'v'}
+            {"stats", optional_argument, NULL, STATS_OPTION},
+            {"threads", required_argument, NULL, 't'},
+            {"timeout", required_argument, NULL, TIMEOUT_OPTION},
+            {"trace", required_argument, NULL, TRACE_OPTION},
+            {"verbose", no_argument, NULL, 'v'},
+            {"window", required_argument, NULL, 'w'},
+            {"work-for", required_argument, NULL, WORK_FOR_OPTION},
+            {NULL, 0, NULL, 0}
         };
 
-        opt = getopt_long(argc, argv, "2bcdehpsv", long_options, &option_index);
+        opt = getopt_long(argc, argv, "2bcdehpst:vw:", long_options, &option_index);
         if (opt == -1) break;
         switch(opt) {
             case '2':
@@ -1555,30 +2218,135 @@ int main(int argc, char ** argv) {
                  "Using brute force method where an exact method is used.\n");
                 options.bruteForceFlag = true;
                 break;
+            case BUDGET_OPTION:
+                options.budget = strtol(optarg, NULL, 10);
+                if(options.budget < 1) {
+                    fprintf(stderr, "Error: budget should be at least 1 ms.\n");
+                    return 1;
+                }
+                break;
             case 'c':
                 options.complementFlag = true;
                 break;
+            case CACHE_OPTION:
+                cacheFile = optarg;
+                break;
+            case CANCEL_FILE_OPTION:
+                cancelFile = optarg;
+                break;
+            case CHUNK_SIZE_OPTION:
+                chunkSize = (int) strtol(optarg, NULL, 10);
+                if(chunkSize < 1) {
+                    fprintf(stderr, "Error: chunk size should be at least "
+                     "1.\n");
+                    return 1;
+                }
+                break;
+            case COORDINATE_OPTION:
+                coordinatorAddress = optarg;
+                break;
             case 'd':
                 options.doublecheckFlag = true;
                 break;
+            case DEDUP_OPTION:
+                dedupFlag = true;
+                break;
+            case DEFERRED_OPTION:
+                deferredFile = optarg;
+                break;
             case 'e':
                 fprintf(stderr, "Only using exact method.\n");
                 options.oddCyclesHeuristicFlag = false;
                 break;
+            case GRAY_CODE_OPTION:
+                options.grayCodeFlag = true;
+                break;
+            case HARDWARE_COUNTERS_OPTION:
+                options.hardwareCountersFlag = true;
+                statsFlag = true;
+                break;
             case 'h':
                 fprintf(stderr, "%s\n", USAGE);
                 fprintf(stderr, "%s", HELPTEXT);
                 return 0;
+            case MAX_REQUEST_OPTION:
+                maxRequestSize = (size_t) strtoull(optarg, NULL, 10);
+                if(maxRequestSize < 1) {
+                    fprintf(stderr, "Error: maximal request size should be at "
+                     "least 1.\n");
+                    return 1;
+                }
+                break;
             case 'p':
                 options.printFlag = true;
                 options.verboseFlag = true;
                 break;
+            case PROGRESS_OPTION:
+                progressFlag = true;
+                if(optarg != NULL) {
+                    progressInterval = strtod(optarg, NULL);
+                    if(progressInterval <= 0) {
+                        fprintf(stderr, "Error: progress interval should be "
+                         "positive.\n");
+                        return 1;
+                    }
+                }
+                break;
+            case PROGRESS_FILE_OPTION:
+                progressFlag = true;
+                progressFile = optarg;
+                break;
             case 's':
                 options.singleGraphFlag = true;
                 break;
+            case SEARCH_PROFILE_OPTION:
+                searchProfileFile = optarg;
+                break;
+            case SERVE_OPTION:
+                socketPath = optarg;
+                break;
+            case STATS_OPTION:
+                statsFlag = true;
+                if(optarg != NULL && strcmp(optarg, "json") != 0 &&
+                 strcmp(optarg, "text") != 0) {
+                    fprintf(stderr, "Error: unknown format for --stats: %s.\n",
+                     optarg);
+                    return 1;
+                }
+                jsonStatsFlag = optarg != NULL && strcmp(optarg, "json") == 0;
+                break;
+            case 't':
+                options.numberOfThreads = (int) strtol(optarg, NULL, 10);
+                if(options.numberOfThreads < 1) {
+                    fprintf(stderr, "Error: number of threads should be at "
+                     "least 1.\n");
+                    return 1;
+                }
+                break;
+            case TIMEOUT_OPTION:
+                timeout = strtol(optarg, NULL, 10);
+                if(timeout < 1) {
+                    fprintf(stderr, "Error: timeout should be at least 1 ms.\n");
+                    return 1;
+                }
+                break;
+            case TRACE_OPTION:
+                traceFile = optarg;
+                break;
             case 'v':
                 options.verboseFlag = true;
                 break;
+            case 'w':
+                options.windowSize = (int) strtol(optarg, NULL, 10);
+                if(options.windowSize < 1) {
+                    fprintf(stderr, "Error: window size should be at least "
+                     "1.\n");
+                    return 1;
+                }
+                break;
+            case WORK_FOR_OPTION:
+                workAddress = optarg;
+                break;
             case '?':
                 fprintf(stderr,"Error: Unknown option: %c\n", optopt);
                 fprintf(stderr, "%s\n", USAGE);
@@ -1634,24 +2402,238 @@ int main(int argc, char ** argv) {
          "Warning: no orientations will be printed for the brute force method.\n");
     }
 
+    if(socketPath != NULL && (options.singleGraphFlag || haveModResPair)) {
+        fprintf(stderr,
+         "Error: --serve cannot be combined with -s or a res/mod pair.\n");
+        return 1;
+    }
+    if((socketPath != NULL) + (coordinatorAddress != NULL) +
+     (workAddress != NULL) > 1) {
+        fprintf(stderr, "Error: only one of --serve, --coordinate and "
+         "--work-for can be used.\n");
+        return 1;
+    }
+    if((coordinatorAddress != NULL || workAddress != NULL) &&
+     options.singleGraphFlag) {
+        fprintf(stderr,
+         "Error: -s cannot be combined with --coordinate or --work-for.\n");
+        return 1;
+    }
+    if(workAddress != NULL && haveModResPair) {
+        fprintf(stderr,
+         "Error: the coordinator selects the graphs for --work-for.\n");
+        return 1;
+    }
+    if(coordinatorAddress != NULL && (cacheFile != NULL || dedupFlag ||
+     options.numberOfThreads > 1)) {
+        cacheFile = NULL;
+        dedupFlag = false;
+        options.numberOfThreads = 1;
+        fprintf(stderr, "Warning: --cache, --dedup and -t only apply to the "
+         "workers when using --coordinate.\n");
+    }
+    if(statsFlag && (socketPath != NULL || coordinatorAddress != NULL ||
+     workAddress != NULL)) {
+        statsFlag = false;
+        options.hardwareCountersFlag = false;
+        fprintf(stderr, "Warning: --stats is ignored with --serve, "
+         "--coordinate and --work-for.\n");
+    }
+    if(statsFlag) {
+        options.stats = newRunStats();
+        if(options.stats == NULL) {
+            fprintf(stderr, "Error: out of memory\n");
+            return 1;
+        }
+    }
+    if(options.hardwareCountersFlag) {
+        options.counters = openHardwareCounters();
+        if(options.counters == NULL) {
+            options.hardwareCountersFlag = false;
+            fprintf(stderr, "Warning: no hardware events can be counted, see "
+             "perf_event_open(2).\n");
+        }
+    }
+    if(traceFile != NULL && (socketPath != NULL ||
+     coordinatorAddress != NULL || workAddress != NULL)) {
+        traceFile = NULL;
+        fprintf(stderr, "Warning: --trace is ignored with --serve, "
+         "--coordinate and --work-for.\n");
+    }
+    if(traceFile != NULL) {
+        options.traceFile = openTraceFile(traceFile);
+        if(options.traceFile == NULL) {
+            fprintf(stderr, "Error: could not create %s.\n", traceFile);
+            return 1;
+        }
+        options.trace = newTraceBuffer(options.traceFile, "main");
+    }
+    if((options.budget > 0) != (deferredFile != NULL)) {
+        fprintf(stderr, "Error: --budget-ms and --deferred need to be used "
+         "together.\n");
+        return 1;
+    }
+    if(options.budget > 0 && (options.singleGraphFlag || socketPath != NULL ||
+     coordinatorAddress != NULL || workAddress != NULL)) {
+        fprintf(stderr, "Error: --budget-ms cannot be combined with -s, "
+         "--serve, --coordinate or --work-for.\n");
+        return 1;
+    }
+    if(deferredFile != NULL) {
+        options.deferred = fopen(deferredFile, "w");
+        if(options.deferred == NULL) {
+            fprintf(stderr, "Error: could not create %s.\n", deferredFile);
+            return 1;
+        }
+    }
+    if(progressFlag && (socketPath != NULL || coordinatorAddress != NULL ||
+     workAddress != NULL)) {
+        progressFlag = false;
+        fprintf(stderr, "Warning: --progress and --progress-file are ignored "
+         "with --serve, --coordinate and --work-for.\n");
+    }
+    if(searchProfileFile != NULL && (socketPath != NULL ||
+     coordinatorAddress != NULL || workAddress != NULL)) {
+        searchProfileFile = NULL;
+        fprintf(stderr, "Warning: --search-profile is ignored with --serve, "
+         "--coordinate and --work-for.\n");
+    }
+    if(searchProfileFile != NULL && options.numberOfThreads > 1) {
+        options.numberOfThreads = 1;
+        fprintf(stderr, "Warning: -t is ignored with --search-profile.\n");
+    }
+    if(searchProfileFile != NULL) {
+        struct fn_context *context = fn_context_new(1);
+        bool isProfiled = context != NULL &&
+         fn_context_search_profile(context) != NULL;
+        fn_context_free(context);
+        if(!isProfiled) {
+            fprintf(stderr, "Error: --search-profile needs a library built "
+             "with -DSEARCH_PROFILE, see make searchprofile.\n");
+            return 1;
+        }
+        options.searchProfile = fopen(searchProfileFile, "w");
+        if(options.searchProfile == NULL) {
+            fprintf(stderr, "Error: could not open %s.\n", searchProfileFile);
+            return 1;
+        }
+        fprintf(options.searchProfile, "graph,search,depth,nodes,"
+         "pruned_out_degree,pruned_in_degree,pruned_no_deletable_edge,"
+         "pruned_not_strongly_connected,pruned_contradiction,"
+         "pruned_not_complementary,backtracks\n");
+    }
+    if(options.singleGraphFlag && (cacheFile != NULL || dedupFlag)) {
+        cacheFile = NULL;
+        dedupFlag = false;
+        fprintf(stderr,
+         "Warning: no cache is used when checking a single graph with -s.\n");
+    }
+    if(cacheFile != NULL || dedupFlag) {
+        options.cache = openResultCache(cacheFile);
+        if(options.cache == NULL) {
+            fprintf(stderr, "Error: could not open cache%s%s.\n",
+             cacheFile ? " " : "", cacheFile ? cacheFile : "");
+            return 1;
+        }
+    }
+    if(cancelFile != NULL && !options.singleGraphFlag) {
+        cancelFile = NULL;
+        fprintf(stderr, "Warning: --cancel-file is ignored without -s.\n");
+    }
+    if(cancelFile != NULL) {
+        cancelFlag = openCancelFlag(cancelFile);
+        if(cancelFlag == NULL) {
+            fprintf(stderr, "Error: could not open cancel file %s.\n",
+             cancelFile);
+            return 1;
+        }
+    }
+    if(options.singleGraphFlag && options.numberOfThreads > 1) {
+        options.numberOfThreads = 1;
+        fprintf(stderr,
+         "Warning: -t is ignored when checking a single graph with -s.\n");
+    }
+
     fprintf(stderr, "%s\n", 
      "Assuming graphs to be cubic and 3-edge-connected.");
+
+    if(socketPath != NULL) {
+        int status = serve(&options, socketPath, maxRequestSize, timeout);
+        if(options.cache != NULL) {
+            closeResultCache(options.cache);
+        }
+        return status;
+    }
+    if(workAddress != NULL) {
+        int status = workForCoordinator(&options, workAddress);
+        if(options.cache != NULL) {
+            closeResultCache(options.cache);
+        }
+        return status;
+    }
     
     unsigned long long int totalGraphs = 0;
     unsigned long long int counter = 0;
     unsigned long long int skippedGraphs = 0;
     unsigned long long int passedGraphs = 0;
+    unsigned long long int deferredGraphs = 0;
     clock_t start = clock();
 
+    //  The ETA is based on the part of the input read, which is only known
+    //  if stdin is a file.
+    if(progressFlag) {
+        struct stat input;
+        long long unsigned int inputSize = 0;
+        if(fstat(STDIN_FILENO, &input) == 0 && S_ISREG(input.st_mode)) {
+            inputSize = input.st_size;
+        }
+        options.progress = startProgress(progressFile, progressInterval,
+         inputSize);
+        if(options.progress == NULL) {
+            fprintf(stderr, "Error: could not start progress reports.\n");
+            return 1;
+        }
+    }
+
+    if(coordinatorAddress != NULL) {
+        if(!coordinateWorkers(&options, coordinatorAddress, chunkSize,
+         &numberOf, &cachedResults, &totalGraphs, &counter, &skippedGraphs,
+         &passedGraphs)) {
+            return 1;
+        }
+    }
+    else if(options.numberOfThreads > 1) {
+        checkGraphsInBatches(&options, &numberOf, &cachedResults, &totalGraphs,
+         &counter, &skippedGraphs, &passedGraphs, &deferredGraphs);
+    }
+    struct fn_context *context = NULL;
+    if(options.numberOfThreads == 1 && coordinatorAddress == NULL) {
+        context = fn_context_new(fn_max_heuristic_vertices());
+        if(context == NULL) {
+            fprintf(stderr, "Error: out of memory\n");
+            return 1;
+        }
+        if(options.singleGraphFlag) {
+            fn_context_set_part(context, options.remainder, options.modulo);
+        }
+        if(cancelFlag != NULL) {
+            fn_context_set_cancel_flag(context, getCancelWord(cancelFlag));
+        }
+        if(options.hardwareCountersFlag || options.traceFile != NULL) {
+            fn_context_set_phase_hook(context, handleLibraryPhase, &options);
+        }
+    }
+
     //  Start looping over lines of stdin.
     char * graphString = NULL;
     size_t size;
-    while(getline(&graphString, &size, stdin) != -1) {
+    ssize_t length;
+    while(context != NULL &&
+     (length = getline(&graphString, &size, stdin)) != -1) {
         totalGraphs++;
-        numberOf.generatedOrientations = 0;
-        numberOf.orientationsGivingSubset = 0;
-        numberOf.complementaryBitsets = 0;
-        numberOf.emptyBitsetsStored = 0;
+        if(options.progress != NULL) {
+            addInput(options.progress, length);
+        }
 
         if(options.singleGraphFlag && totalGraphs >= 2) {
             fprintf(stderr, "Warning: do not input two graphs with -s.\n");
@@ -1666,115 +2648,62 @@ int main(int argc, char ** argv) {
             continue;
         }
 
-        int numberOfVertices = getNumberOfVertices(graphString);
-        if(numberOfVertices == -1 || numberOfVertices > MAXVERTICES) {
-            if(options.verboseFlag){
-                fprintf(stderr, "Skipping invalid graph!\n");
-            }
+        struct graphTiming timing = {.counters = options.counters};
+        if(options.stats != NULL) {
+            options.timing = &timing;
+        }
+        bitset adjacencyList[MAXVERTICES];
+        int numberOfVertices = decodeGraph(graphString, &options,
+         adjacencyList);
+        if(numberOfVertices == -1) {
             skippedGraphs++;
             continue;
         }
+        struct checkOutcome outcome = {.wantsCertificate = false};
+        setBudgetDeadline(&options, context);
+        int frankNumber = checkGraph(graphString, adjacencyList,
+         numberOfVertices, &options, context, &cachedResults, &outcome);
 
-        //  MAXVERTICES also indicates the largest size of a bitset, since we
-        //  store edges in a bitset, the number of edges in a cubic graph
-        //  (3*n/2) may not exceed MAXVERTICES.
-        if(numberOfVertices*3/2 > MAXVERTICES) {
-            if(options.verboseFlag){
-                fprintf(stderr, "Skipping invalid graph! Too many edges.\n");
-            }
-            skippedGraphs++;
+        //  The graph has Frank number 2, another shard proved it.
+        if(outcome.cancelled) {
+            cancelled = true;
             continue;
         }
-        bitset adjacencyList[numberOfVertices];
-        if(loadGraph(graphString, numberOfVertices, adjacencyList) == -1) {
-            if(options.verboseFlag){
-                fprintf(stderr, "Skipping invalid graph!\n");
-            }
-            skippedGraphs++;
+
+        //  The budget was exceeded, the graph is checked in a later run.
+        if(outcome.aborted) {
+            deferredGraphs++;
+            fprintf(options.deferred, "%s", graphString);
             continue;
         }
         counter++;
-
-
-        if(options.verboseFlag) {
-            fprintf(stderr, "Looking at:\n%s", graphString);
-        }
-
-        if(options.printFlag) {
-            fprintf(stderr, "Labelling of graph:\n");
-            printGraph(adjacencyList, numberOfVertices);
-        }
-
-        int frankNumber = 0;
-        if(options.oddCyclesHeuristicFlag) {
-            int F[numberOfVertices];
-            if(hasSufficientCondition(adjacencyList, numberOfVertices, &options,
-             &numberOf, complement(EMPTY, numberOfVertices), F)) {
-                numberOf.graphsSatisfyingOddnessCondition++;
-                frankNumber = 2;
-            }
-            else {
-                if(options.verboseFlag) {
-                    fprintf(stderr, 
-                     "\tHeuristic failed. %soing exhaustive check.\n",
-                     options.exhaustiveCheckFlag ? "D" : "Not d");
-                }
-                numberOf.graphsNotSatisfyingOddnessCondition++;
-            }
-        }
-        if(options.exhaustiveCheckFlag && frankNumber == 0) {
-            frankNumber = findFrankNumber(adjacencyList, numberOfVertices, 
-                &options, &numberOf);
-            if(options.verboseFlag) {
-                fprintf(stderr,
-                 "\tStrongly connected orientations generated: %llu\n",
-                 numberOf.generatedOrientations);
-                if(options.bruteForceFlag) {
-                    fprintf(stderr, "\tOrientations giving subsets: %llu\n",
-                     numberOf.orientationsGivingSubset);
-                    fprintf(stderr, "\tOrientations giving supersets: %llu\n",
-                     numberOf.orientationsGivingSuperset);
-                    fprintf(stderr, "\tNumberOfComplementaryBitsets: %llu\n",
-                     numberOf.complementaryBitsets);
-                }
-            }
-        }
-        if(frankNumber == 0) {
-            if(options.verboseFlag) {
-                fprintf(stderr, "\tFrankNumber >= 3.\n\n");
-                fprintf(stderr, "------------------------------------\n\n");
-            }
-            if(!options.complementFlag) {
-                passedGraphs++;
-                printf("%s", graphString);
-            }
+        if(frankNumber == 2 && cancelFlag != NULL) {
+            raiseCancelFlag(cancelFlag, options.remainder);
         }
-        if(frankNumber == 2) {
-            if(options.verboseFlag) {
-                fprintf(stderr, "\tFrankNumber = 2.\n\n");
-                fprintf(stderr, "------------------------------------\n\n");
-            }
-            if(options.complementFlag) {
-                passedGraphs++;
-                printf("%s", graphString);
-            }
+        if(writeGraph(graphString, frankNumber, &options)) {
+            passedGraphs++;
         }
-        if(numberOf.mostGeneratedOrientations < numberOf.generatedOrientations) {
-            numberOf.mostGeneratedOrientations = numberOf.generatedOrientations;
+        if(options.stats != NULL) {
+            recordGraph(options.stats, graphString, &timing);
         }
-        if(numberOf.mostStoredBitsets < numberOf.storedBitsets) {
-            numberOf.mostStoredBitsets = numberOf.storedBitsets;
-        }
-
     }
+    options.timing = NULL;
     free(graphString);
+    if(options.progress != NULL) {
+        stopProgress(options.progress);
+    }
+    if(context != NULL) {
+        mergeCounters(&numberOf, fn_context_counters(context));
+        fn_context_free(context);
+    }
     clock_t end = clock();
     double time_spent = (double)(end - start) / CLOCKS_PER_SEC;
 
     if(options.bruteForceFlag) {
         fprintf(stderr, 
          "Largest size of bitset array is %llu elements (%.2f GB)\n",
-          numberOf.mostStoredBitsets, numberOf.mostStoredBitsets*8/1000000000.0);
+          numberOf.mostStoredBitsets,
+          sizeof(edgeset)*numberOf.mostStoredBitsets/1e9);
     }
     fprintf(stderr,"\rChecked %lld graphs in %f seconds: %llu %s.\n",
      counter, time_spent, passedGraphs, options.complementFlag ? 
@@ -1783,6 +2712,19 @@ int main(int argc, char ** argv) {
      "passed sufficient condition for fn 2") : 
      (options.exhaustiveCheckFlag ? "have fn > 2" : 
      "did not pass sufficient condition for fn 2"));
+    if(options.cache != NULL) {
+        fprintf(stderr, "Results of %llu graphs were taken from the cache.\n",
+         cachedResults);
+        closeResultCache(options.cache);
+    }
+    if(options.deferred != NULL) {
+        fprintf(stderr, "%llu graphs exceeded the budget of %ld ms and were "
+         "written to %s.\n", deferredGraphs, options.budget, deferredFile);
+        if(fclose(options.deferred) != 0) {
+            fprintf(stderr, "Error: could not write %s.\n", deferredFile);
+            return 1;
+        }
+    }
     if(skippedGraphs > 0) {
         fprintf(stderr, "Warning: %lld graphs were skipped.\n", skippedGraphs);
     }
@@ -1795,6 +2737,29 @@ int main(int argc, char ** argv) {
          numberOf.graphsSatisfyingFirstOddness,
          numberOf.graphsSatisfyingSecondOddness);
     }
+    if(cancelFlag != NULL) {
+        if(cancelled) {
+            fprintf(stderr, "Cancelled: shard %d/%d found that the graph has "
+             "Frank number 2.\n", getCancellingShard(cancelFlag),
+             options.modulo);
+        }
+        closeCancelFlag(cancelFlag);
+    }
+    if(options.stats != NULL) {
+        printRunStats(options.stats, stderr, jsonStatsFlag);
+        freeRunStats(options.stats);
+    }
+    closeHardwareCounters(options.counters);
+    if(options.traceFile != NULL) {
+        freeTraceBuffer(options.trace);
+        if(!closeTraceFile(options.traceFile)) {
+            fprintf(stderr, "Warning: could not write the trace to %s.\n",
+             traceFile);
+        }
+    }
+    if(options.searchProfile != NULL) {
+        fclose(options.searchProfile);
+    }
 
-    return 0;
+    return cancelled ? EXIT_CANCELLED : 0;
 }
\ No newline at end of file
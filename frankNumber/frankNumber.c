@@ -0,0 +1,2471 @@
+/**
+ * frankNumber.c
+ * 
+ * Author: Jarne Renders (jarne.renders@kuleuven.be)
+ *
+ *  Heuristic and exact algorithms for deciding whether a cubic graph has
+ *  Frank number 2. See frankNumber.h for the interface.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef FN_WIDTH_PREFIX
+#include "frankNumberWidth.h"
+#endif
+#include "frankNumber.h"
+#include "../bitset.h"
+
+//  Options of the algorithms, derived from the flags of fn_check() and the
+//  settings of the context.
+struct arena;
+
+struct options {
+    bool bruteForceFlag;
+    bool doublecheckFlag;
+    bool exhaustiveCheckFlag;
+    bool oddCyclesHeuristicFlag;
+    bool verboseFlag;
+    bool printFlag;
+    bool singleGraphFlag;
+    bool grayCodeFlag;
+    int modulo;
+    int remainder;
+    unsigned long long int sizeOfArray;
+
+    //  The search stops as soon as aborted is set, which happens when the
+    //  deadline passes or when the cancel flag is raised. In the latter case
+    //  cancelled is set as well.
+    bool hasDeadline;
+    struct timespec deadline;
+    const atomic_int *cancelFlag;
+    int nodesSinceClockCheck;
+    bool aborted;
+    bool cancelled;
+
+    //  Scratch memory of the context, see struct arena.
+    struct arena *arena;
+
+    //  NULL unless the phases are timed.
+    struct fn_timing *timing;
+    fn_phase_hook *phaseHook;
+    void *phaseHookData;
+
+#ifdef SEARCH_PROFILE
+    struct fn_search_profile *profile;
+#endif
+};
+
+//  Reading the clock is relatively expensive, so the deadline and the cancel
+//  flag are only checked once every so many search tree nodes.
+#define CLOCK_CHECK_INTERVAL 1024
+
+//  Called in every node of the search trees. Returns true if the search should
+//  stop.
+static inline bool shouldAbort(struct options *options) {
+    if(options->aborted) {
+        return true;
+    }
+    if((!options->hasDeadline && options->cancelFlag == NULL) ||
+     ++options->nodesSinceClockCheck < CLOCK_CHECK_INTERVAL) {
+        return false;
+    }
+    options->nodesSinceClockCheck = 0;
+    if(options->cancelFlag != NULL &&
+     atomic_load_explicit(options->cancelFlag, memory_order_relaxed) != 0) {
+        options->cancelled = true;
+        options->aborted = true;
+        return true;
+    }
+    if(!options->hasDeadline) {
+        return false;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    options->aborted = now.tv_sec > options->deadline.tv_sec ||
+     (now.tv_sec == options->deadline.tv_sec &&
+     now.tv_nsec >= options->deadline.tv_nsec);
+    return options->aborted;
+}
+
+//  Timestamps taken at the start of a phase.
+struct phaseStart {
+    struct timespec wall;
+    struct timespec cpu;
+};
+
+//  The hook is called outside of the timed interval.
+static inline void startPhase(struct options *options,
+ struct phaseStart *start, enum fn_phase phase) {
+    if(options->phaseHook != NULL) {
+        options->phaseHook(options->phaseHookData, phase, false);
+    }
+    if(options->timing != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &start->wall);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start->cpu);
+    }
+}
+
+static inline void endPhase(struct options *options, struct phaseStart *start,
+ enum fn_phase phase) {
+    if(options->timing != NULL) {
+        struct timespec wall;
+        struct timespec cpu;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+        clock_gettime(CLOCK_MONOTONIC, &wall);
+        options->timing->wallSeconds[phase] +=
+         (wall.tv_sec - start->wall.tv_sec) +
+         (wall.tv_nsec - start->wall.tv_nsec) / 1e9;
+        options->timing->cpuSeconds[phase] +=
+         (cpu.tv_sec - start->cpu.tv_sec) +
+         (cpu.tv_nsec - start->cpu.tv_nsec) / 1e9;
+        options->timing->calls[phase]++;
+    }
+    if(options->phaseHook != NULL) {
+        options->phaseHook(options->phaseHookData, phase, true);
+    }
+}
+
+//  With -DSEARCH_PROFILE the nodes, pruned branches and backtracks of the
+//  search trees are counted per depth. Otherwise these macros are empty.
+#ifdef SEARCH_PROFILE
+#define PROFILE_NODE(options, search, edge) \
+    ((options)->profile->depth[search][edge].nodes++)
+#define PROFILE_PRUNED(options, search, edge, reason) \
+    ((options)->profile->depth[search][edge].pruned[reason]++)
+#define PROFILE_BACKTRACK(options, search, edge) \
+    ((options)->profile->depth[search][edge].backtracks++)
+#else
+#define PROFILE_NODE(options, search, edge)
+#define PROFILE_PRUNED(options, search, edge, reason)
+#define PROFILE_BACKTRACK(options, search, edge)
+#endif
+
+//******************************************************************************
+//
+//                          Dynamic arrays
+//
+//******************************************************************************
+
+typedef struct {
+  edgeset *array;
+  size_t used;
+  size_t size;
+} Array;
+
+//  Edge sets of 256 bits have to be aligned to 32 bytes, which malloc() does
+//  not guarantee.
+static void initArray(Array *a, size_t initialSize) {
+  a->array = aligned_alloc(_Alignof(edgeset), initialSize * sizeof(edgeset));
+  if(a->array == NULL) {
+    fprintf(stderr, "Error: out of memory\n");
+    exit(1);
+  }
+  a->used = 0;
+  a->size = initialSize;
+}
+
+// Double arraysize when too big.
+static void insertArray(Array *a, edgeset element) {
+  if (a->used == a->size) {
+    edgeset *array = a->array;
+    initArray(a, 2 * a->size);
+    memcpy(a->array, array, a->size / 2 * sizeof(edgeset));
+    a->used = a->size / 2;
+    free(array);
+  }
+  a->array[a->used++] = element;
+}
+
+static void insertArrayAtPos(Array *a, edgeset element, size_t index) {
+    if (index > a->size) {
+        fprintf(stderr, "Error: index does not lie in the array.\n");
+        exit(1);
+    }
+  a->array[index] = element;
+}
+
+static void freeArray(Array *a) {
+  free(a->array);
+  a->array = NULL;
+  a->used = a->size = 0;
+}
+
+//******************************************************************************
+//
+//                          Arena
+//
+//******************************************************************************
+
+//  Scratch memory for the digraphs and cycles needed while checking a graph.
+//  It is allocated once per context and handed out by increasing used. A
+//  function gives its scratch memory back by restoring used to the value it
+//  had on entry, and fn_check() empties the arena for every graph.
+struct arena {
+    char *memory;
+    size_t used;
+    size_t size;
+};
+
+//  Every allocation is aligned for the widest bitset or edge set.
+#define ARENA_ALIGNMENT 32
+
+#define roundUpToAlignment(bytes) \
+ (((bytes) + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1))
+
+static bool initArena(struct arena *arena, size_t size) {
+    arena->memory = aligned_alloc(ARENA_ALIGNMENT, roundUpToAlignment(size));
+    arena->used = 0;
+    arena->size = arena->memory == NULL ? 0 : size;
+    return arena->memory != NULL;
+}
+
+static void *arenaAllocate(struct arena *arena, size_t bytes) {
+    void *memory = arena->memory + arena->used;
+    bytes = roundUpToAlignment(bytes);
+    if(arena->size - arena->used < bytes) {
+        fprintf(stderr, "Error: out of scratch memory\n");
+        exit(1);
+    }
+    arena->used += bytes;
+    return memory;
+}
+
+static void freeArena(struct arena *arena) {
+    free(arena->memory);
+    arena->memory = NULL;
+    arena->used = arena->size = 0;
+}
+
+//******************************************************************************
+//
+//                          Cubic graphs
+//
+//******************************************************************************
+
+//  The graph being checked together with everything the algorithms look up
+//  per vertex, computed once per graph. This replaces an n x n matrix of edge
+//  numbers, so that the hot paths only touch a few kilobytes. The neighbours of
+//  a vertex are stored in increasing order, i.e. in the order in which forEach
+//  visits its adjacency list.
+struct cubicGraph {
+    int numberOfVertices;
+    int numberOfEdges;
+    bitset adjacencyList[MAXVERTICES];
+
+    //  neighbours[v][i] is the i-th neighbour of v and edgeIds[v][i] the number
+    //  of the edge between them. positions[v][i] is the index of v among the
+    //  neighbours of neighbours[v][i], so the arc back is known as well.
+    int neighbours[MAXVERTICES][3];
+    int edgeIds[MAXVERTICES][3];
+    int positions[MAXVERTICES][3];
+
+    //  The endpoints of every edge, the smallest first. The edges are numbered
+    //  by their smallest endpoint and then by the other endpoint. Graphs only
+    //  checked by the heuristic algorithm may have more than MAXEDGES edges.
+    int endpoints[3*MAXVERTICES/2][2];
+
+    bitset vertexUniverse;
+    edgeset edgeUniverse;
+};
+
+//  Compute the lookup tables from the adjacency list, which should be that of
+//  a simple cubic graph.
+static void initCubicGraph(struct cubicGraph *graph, int numberOfVertices) {
+    graph->numberOfVertices = numberOfVertices;
+    for(int v = 0; v < numberOfVertices; v++) {
+        int i = 0;
+        forEach(nbr, graph->adjacencyList[v]) {
+            graph->neighbours[v][i++] = nbr;
+        }
+    }
+    int counter = 0;
+    for(int v = 0; v < numberOfVertices; v++) {
+        for(int i = 0; i < 3; i++) {
+            int nbr = graph->neighbours[v][i];
+            if(nbr < v) {
+                continue;
+            }
+            int j = 0;
+            while(graph->neighbours[nbr][j] != v) {
+                j++;
+            }
+            graph->edgeIds[v][i] = counter;
+            graph->edgeIds[nbr][j] = counter;
+            graph->positions[v][i] = j;
+            graph->positions[nbr][j] = i;
+            graph->endpoints[counter][0] = v;
+            graph->endpoints[counter][1] = nbr;
+            counter++;
+        }
+    }
+    graph->numberOfEdges = counter;
+
+    graph->vertexUniverse = complement(EMPTY, numberOfVertices);
+    graph->edgeUniverse = counter <= MAXEDGES ? allEdges(counter) : EMPTY_EDGES;
+}
+
+//  The index of y among the neighbours of x.
+static inline int getPosition(struct cubicGraph *graph, int x, int y) {
+    int i = 0;
+    while(graph->neighbours[x][i] != y) {
+        i++;
+    }
+    return i;
+}
+
+//  The first neighbour of v which is neither a nor b.
+static inline int otherNeighbour(struct cubicGraph *graph, int v, int a,
+ int b) {
+    int i = 0;
+    while(graph->neighbours[v][i] == a || graph->neighbours[v][i] == b) {
+        i++;
+    }
+    return graph->neighbours[v][i];
+}
+
+//******************************************************************************
+//
+//                          Digraphs
+//
+//******************************************************************************
+
+// Digraph structure containing bitset representations.
+struct diGraph {
+    int numberOfVertices;
+    bitset* adjacencyList;
+    bitset* reverseAdjacencyList;
+    int numberOfArcs;
+}; 
+
+//  Initializer for empty graph.
+#define emptyGraph(g) {\
+ (g)->numberOfArcs = 0;\
+ for(int i = 0; i < (g)->numberOfVertices; i++) {\
+    (g)->adjacencyList[i] = EMPTY;\
+    (g)->reverseAdjacencyList[i] = EMPTY;\
+ }\
+}
+
+//  Add one directed edge. numberOfArcs will be incorrect if adding existing
+//  arc.
+#define addArc(g,i,j) {\
+ add((g)->adjacencyList[i], j); (g)->numberOfArcs++;\
+ add((g)->reverseAdjacencyList[j], i);\
+}
+
+//  Remove one undirected edge. numberOfArcs will be incorrect if removing
+//  non-existing arc.
+#define removeArc(g,i,j) {\
+ removeElement((g)->adjacencyList[i], j);(g)->numberOfArcs--;\
+ removeElement((g)->reverseAdjacencyList[j], i);\
+}
+
+//  A digraph whose adjacency lists are taken from the arena. They are not
+//  initialised.
+static struct diGraph allocateDiGraph(struct arena *arena,
+ int numberOfVertices) {
+    return (struct diGraph) {.numberOfVertices = numberOfVertices,
+     .adjacencyList = arenaAllocate(arena, sizeof(bitset)*numberOfVertices),
+     .reverseAdjacencyList = arenaAllocate(arena,
+     sizeof(bitset)*numberOfVertices)};
+}
+
+//  The scratch memory taken by allocateDiGraph().
+static size_t getDiGraphArenaSize(int numberOfVertices) {
+    return 2*roundUpToAlignment(sizeof(bitset)*numberOfVertices);
+}
+
+//  Two orientations with complementary sets of deletable edges, showing that
+//  the Frank number is 2. Stored as adjacency lists of out-neighbours.
+struct certificate {
+    bool found;
+    bitset orientation[2][MAXVERTICES];
+};
+
+//  Print adjacency list of digraph.
+static void printDiGraph(struct diGraph *g) {
+    for(int i = 0; i < g->numberOfVertices; i++) {
+        fprintf(stderr, "%d:", i);
+        forEach(nbr, g->adjacencyList[i]) {
+            fprintf(stderr, " %d", nbr);
+        }
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr,"\n");   
+}
+
+//******************************************************************************
+//
+//                          Orientations
+//
+//******************************************************************************
+
+//  An orientation of some of the edges of a cubic graph, using one bit per
+//  edge. Edge e is oriented if it is in oriented, from endpoints[e][0] to
+//  endpoints[e][1] if it is in direction as well and the other way around
+//  otherwise. Unlike a diGraph it is a value of two edge sets, so taking a
+//  snapshot or comparing orientations is cheap.
+struct orientation {
+    edgeset oriented;
+    edgeset direction;
+};
+
+#define emptyOrientation() \
+ ((struct orientation) {.oriented = EMPTY_EDGES, .direction = EMPTY_EDGES})
+
+//  Orient the i-th edge of v away from v.
+static inline void orientEdge(struct cubicGraph *graph,
+ struct orientation *orientation, int v, int i) {
+    int edge = graph->edgeIds[v][i];
+    addEdge(orientation->oriented, edge);
+    if(v < graph->neighbours[v][i]) {
+        addEdge(orientation->direction, edge);
+    }
+}
+
+//  Is the i-th edge of v oriented away from v?
+static inline bool isOutgoing(struct cubicGraph *graph,
+ struct orientation *orientation, int v, int i) {
+    int edge = graph->edgeIds[v][i];
+    return containsEdge(orientation->oriented, edge) &&
+     (containsEdge(orientation->direction, edge) ?
+     v < graph->neighbours[v][i] : v > graph->neighbours[v][i]);
+}
+
+//  Is the i-th edge of v oriented towards v?
+static inline bool isIncoming(struct cubicGraph *graph,
+ struct orientation *orientation, int v, int i) {
+    return isOutgoing(graph, orientation, graph->neighbours[v][i],
+     graph->positions[v][i]);
+}
+
+//  The outgoing and incoming edges of v as a mask with bit i set if the i-th
+//  edge of v is in it. The size of the mask is the out- or indegree.
+static inline int getOutgoing(struct cubicGraph *graph,
+ struct orientation *orientation, int v) {
+    return isOutgoing(graph, orientation, v, 0) |
+     isOutgoing(graph, orientation, v, 1) << 1 |
+     isOutgoing(graph, orientation, v, 2) << 2;
+}
+
+static inline int getIncoming(struct cubicGraph *graph,
+ struct orientation *orientation, int v) {
+    return isIncoming(graph, orientation, v, 0) |
+     isIncoming(graph, orientation, v, 1) << 1 |
+     isIncoming(graph, orientation, v, 2) << 2;
+}
+
+#define degree(mask) __builtin_popcount(mask)
+
+//  The index of the first edge of a vertex which is not in the mask.
+#define firstOutside(mask) __builtin_ctz(~(mask))
+
+//  Store the arcs of an orientation as adjacency lists, e.g. to check whether
+//  it is strongly connected.
+static void getDiGraph(struct cubicGraph *graph,
+ struct orientation *orientation, struct diGraph *diGraph) {
+    emptyGraph(diGraph);
+    for(int edge = 0; edge < graph->numberOfEdges; edge++) {
+        if(!containsEdge(orientation->oriented, edge)) {
+            continue;
+        }
+        int u = graph->endpoints[edge][0];
+        int v = graph->endpoints[edge][1];
+        if(containsEdge(orientation->direction, edge)) {
+            addArc(diGraph, u, v);
+        }
+        else {
+            addArc(diGraph, v, u);
+        }
+    }
+}
+
+//******************************************************************************
+//
+//                         Strong connectivity check
+//
+//******************************************************************************
+
+static void visit(struct diGraph *g, int vertexToVisit,
+ bitset *unvisitedVertices, int L[], int *lengthOfL) {
+    if(!contains(*unvisitedVertices, vertexToVisit)) {
+        return;
+    }
+    removeElement(*unvisitedVertices, vertexToVisit);
+    forEach(outNeighbour, g->adjacencyList[vertexToVisit]) {
+        visit(g, outNeighbour, unvisitedVertices, L, lengthOfL);
+    }
+    L[*lengthOfL] = vertexToVisit;
+    (*lengthOfL)++;
+}
+
+static void assign(struct diGraph *g, int vertex, bitset *assignedVertices) {
+    if(contains(*assignedVertices, vertex)) {
+        return;
+    }
+    add(*assignedVertices, vertex);
+    forEach(inNeighbour, g->reverseAdjacencyList[vertex]) {
+        assign(g, inNeighbour, assignedVertices);
+    }
+}
+
+static bool isStronglyConnected(struct diGraph *g) {
+    bitset unvisitedVertices = complement(EMPTY, g->numberOfVertices);
+    int L[g->numberOfVertices];
+    int lengthOfL = 0;
+    for(int i = 0; i < g->numberOfVertices ; i++) {
+        visit(g, i, &unvisitedVertices, L, &lengthOfL);
+    }
+    bitset assignedVertices = EMPTY;
+    assign(g, L[lengthOfL-1], &assignedVertices);
+
+    return size(assignedVertices) == g->numberOfVertices;
+}
+
+//******************************************************************************
+//
+//                     Strongly connected partial orientations
+//
+//******************************************************************************
+
+//  A partial orientation is stored as a mixed graph: the arcs which are still
+//  possible, i.e. both arcs of an edge which is not oriented yet and the arc
+//  of an oriented edge. A partial orientation of a bridgeless graph can be
+//  completed to a strong orientation if and only if this mixed graph is
+//  strongly connected (Boesch and Tindell, 1980). generateAllOrientations()
+//  only keeps partial orientations for which this holds, so every complete
+//  orientation it reaches is strong and it never gets stuck.
+
+//  The reachability of the oriented arcs alone, which are only added along a
+//  branch of the search tree. descendants[v] contains the vertices reachable
+//  from v, including v, so u and v lie in the same strongly connected
+//  component if each is a descendant of the other. Adding an arc only lets
+//  sets grow, and every set which grows is pushed on changes, such that
+//  backtracking restores it. A set grows at most n - 1 times along a branch,
+//  so changes needs room for n*(n - 1) entries.
+struct reachabilityChange {
+    bitset descendants;
+    int vertex;
+};
+
+struct orientedReachability {
+    bitset *descendants;
+    struct reachabilityChange *changes;
+    int numberOfChanges;
+};
+
+static struct orientedReachability allocateOrientedReachability(
+ struct arena *arena, int numberOfVertices) {
+    struct orientedReachability reachability = {
+     .descendants = arenaAllocate(arena, sizeof(bitset)*numberOfVertices),
+     .changes = arenaAllocate(arena, sizeof(struct reachabilityChange)*
+     numberOfVertices*numberOfVertices)};
+    for(int v = 0; v < numberOfVertices; v++) {
+        reachability.descendants[v] = singleton(v);
+    }
+    return reachability;
+}
+
+//  The scratch memory taken by allocateOrientedReachability().
+static size_t getOrientedReachabilityArenaSize(int numberOfVertices) {
+    return roundUpToAlignment(sizeof(bitset)*numberOfVertices) +
+     roundUpToAlignment(sizeof(struct reachabilityChange)*
+     numberOfVertices*numberOfVertices);
+}
+
+//  Every vertex reaching tail now also reaches the descendants of head.
+static void addOrientedArc(struct orientedReachability *reachability,
+ int numberOfVertices, int tail, int head) {
+    bitset reachedViaArc = reachability->descendants[head];
+    for(int v = 0; v < numberOfVertices; v++) {
+        bitset descendants = reachability->descendants[v];
+        if(!contains(descendants, tail) ||
+         isEmpty(difference(reachedViaArc, descendants))) {
+            continue;
+        }
+        reachability->changes[reachability->numberOfChanges++] =
+         (struct reachabilityChange) {.descendants = descendants, .vertex = v};
+        reachability->descendants[v] = union(descendants, reachedViaArc);
+    }
+}
+
+//  Undo the arcs added since numberOfChanges was mark.
+static void removeOrientedArcs(struct orientedReachability *reachability,
+ int mark) {
+    while(reachability->numberOfChanges > mark) {
+        struct reachabilityChange *change =
+         &reachability->changes[--reachability->numberOfChanges];
+        reachability->descendants[change->vertex] = change->descendants;
+    }
+}
+
+//  Is to reachable from from in the mixed graph with the given possible
+//  successors? The oriented arcs are possible as well, so all descendants of a
+//  reached vertex are reached at once.
+static bool hasPossiblePath(bitset possibleSuccessors[],
+ struct orientedReachability *reachability, int from, int to) {
+    bitset reached = reachability->descendants[from];
+    bitset frontier = reached;
+    while(!isEmpty(frontier)) {
+        bitset successors = EMPTY;
+        forEach(x, frontier) {
+            successors = union(successors, possibleSuccessors[x]);
+        }
+        forEach(x, difference(successors, reached)) {
+            successors = union(successors, reachability->descendants[x]);
+        }
+        if(contains(successors, to)) {
+            return true;
+        }
+        frontier = difference(successors, reached);
+        reached = union(reached, successors);
+    }
+    return false;
+}
+
+//  Orient the edge between u and w from u to w, by removing the arc from w to
+//  u from the strongly connected mixed graph. Returns whether it is still
+//  strongly connected, which is the case if and only if u can still be reached
+//  from w. Otherwise the arc is added again. No search is needed if the
+//  oriented arcs already lead from w to u, i.e. if the new arc closes a cycle
+//  and u and w end up in the same strongly connected component.
+static bool orientPossibleArc(bitset possibleSuccessors[],
+ struct orientedReachability *reachability, int u, int w) {
+    removeElement(possibleSuccessors[w], u);
+    if(contains(reachability->descendants[w], u) ||
+     hasPossiblePath(possibleSuccessors, reachability, w, u)) {
+        return true;
+    }
+    add(possibleSuccessors[w], u);
+    return false;
+}
+
+//******************************************************************************
+//
+//                     Deletable edges
+//
+//******************************************************************************
+
+//  Used for checking if edge is deletable. Searches a directed path from i to
+//  end through the vertices which are not yet visited. If there is one, its
+//  edges are added to path, otherwise visited ends up holding all vertices
+//  reachable from i.
+static bool containsDirectedPathBetween(struct cubicGraph *graph,
+ struct diGraph *orientation, bitset *visited, int i, int end,
+ edgeset *path) {
+
+    add(*visited, i);
+    for(int k = 0; k < 3; k++) {
+        int nbr = graph->neighbours[i][k];
+        if(!contains(orientation->adjacencyList[i], nbr) ||
+         (nbr != end && contains(*visited, nbr))) {
+            continue;
+        }
+        if(nbr == end || containsDirectedPathBetween(graph, orientation,
+         visited, nbr, end, path)) {
+            addEdge(*path, graph->edgeIds[i][k]);
+            return true;
+        }
+    }
+    return false;
+}
+
+//  We assume that the given orientation is strongly connected.
+static edgeset getDeletableEdges(struct cubicGraph *graph,
+ struct diGraph *orientation) {
+
+    edgeset deletableEdges = EMPTY_EDGES;
+
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        for(int k = 0; k < 3; k++) {
+            int nbr = graph->neighbours[i][k];
+            if(!contains(orientation->adjacencyList[i], nbr)) {
+                continue;
+            }
+            removeArc(orientation, i, nbr);
+            bitset visited = EMPTY;
+            edgeset path = EMPTY_EDGES;
+            if(containsDirectedPathBetween(graph, orientation, &visited, i,
+             nbr, &path)) {
+                addEdge(deletableEdges, graph->edgeIds[i][k]);
+            }
+            addArc(orientation, i, nbr);
+        }
+    }
+
+    return deletableEdges;
+}
+
+//  The deletable edges of the last strong orientation passed to
+//  updateDeletableEdges(), with the reason why each edge is deletable or not.
+//  These reasons mostly survive reversing a few arcs, so only the edges whose
+//  reason was lost are checked again.
+struct deletableEdgesCache {
+    bool isValid;
+    edgeset direction;
+    edgeset deletableEdges;
+
+    //  For a deletable edge the edges of a path from its tail to its head
+    //  avoiding it. For another edge the vertices reachable from its tail
+    //  without it, which do not include its head and have no other arcs
+    //  leaving them.
+    edgeset path[MAXEDGES];
+    bitset reached[MAXEDGES];
+};
+
+//  Get the deletable edges of the strong orientation, which is stored in
+//  diGraph as well, from those of the last one in cache. The path of a
+//  deletable edge remains if none of its edges was reversed, and the vertices
+//  reached from the tail of another edge still cannot reach its head if no
+//  reversed arc leaves them now. The other edges and the reversed edges
+//  themselves are checked as in getDeletableEdges().
+static edgeset updateDeletableEdges(struct cubicGraph *graph,
+ struct deletableEdgesCache *cache, struct orientation *orientation,
+ struct diGraph *diGraph) {
+    edgeset direction = orientation->direction;
+    edgeset reversed = graph->edgeUniverse;
+    if(cache->isValid) {
+        reversed = edgeUnion(edgeDifference(direction, cache->direction),
+         edgeDifference(cache->direction, direction));
+    }
+
+    //  The arcs of the reversed edges in the new orientation.
+    int reversedTails[MAXEDGES];
+    int reversedHeads[MAXEDGES];
+    int numberOfReversed = 0;
+    if(cache->isValid) {
+        for(int edge = 0; edge < graph->numberOfEdges; edge++) {
+            if(!containsEdge(reversed, edge)) {
+                continue;
+            }
+            bool isForward = containsEdge(direction, edge);
+            reversedTails[numberOfReversed] =
+             graph->endpoints[edge][!isForward];
+            reversedHeads[numberOfReversed] =
+             graph->endpoints[edge][isForward];
+            numberOfReversed++;
+        }
+    }
+
+    for(int edge = 0; edge < graph->numberOfEdges; edge++) {
+        bool isDeletable = containsEdge(cache->deletableEdges, edge);
+        bool isKnown = !containsEdge(reversed, edge);
+        if(isKnown && isDeletable) {
+            isKnown = isEmptyEdgeSet(edgeIntersection(cache->path[edge],
+             reversed));
+        }
+        else if(isKnown) {
+            bitset reached = cache->reached[edge];
+            for(int i = 0; i < numberOfReversed && isKnown; i++) {
+                isKnown = !contains(reached, reversedTails[i]) ||
+                 contains(reached, reversedHeads[i]);
+            }
+        }
+        if(isKnown) {
+            continue;
+        }
+
+        bool isForward = containsEdge(direction, edge);
+        int tail = graph->endpoints[edge][!isForward];
+        int head = graph->endpoints[edge][isForward];
+        removeArc(diGraph, tail, head);
+        bitset visited = EMPTY;
+        edgeset path = EMPTY_EDGES;
+        if(containsDirectedPathBetween(graph, diGraph, &visited, tail, head,
+         &path)) {
+            addEdge(cache->deletableEdges, edge);
+            cache->path[edge] = path;
+        }
+        else {
+            removeEdge(cache->deletableEdges, edge);
+            cache->reached[edge] = visited;
+        }
+        addArc(diGraph, tail, head);
+    }
+    cache->direction = direction;
+    cache->isValid = true;
+    return cache->deletableEdges;
+}
+
+static void printDeletableEdges(struct cubicGraph *graph,
+ bitset orientation[], edgeset deletableEdges) {
+    fprintf(stderr, "Deletable edges: ");
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        for(int k = 0; k < 3; k++) {
+            int nbr = graph->neighbours[i][k];
+            if(contains(orientation[i], nbr) &&
+             containsEdge(deletableEdges, graph->edgeIds[i][k])) {
+                fprintf(stderr, "%d--%d ", i, nbr);
+            }
+        }
+    }
+    fprintf(stderr, "\n");
+}
+
+//******************************************************************************
+//
+//                          Exact algorithm
+//
+//******************************************************************************
+
+#define isSubset(set1, set2) isEmptyEdgeSet(edgeDifference((set1), (set2)))
+
+// Brute force approach
+static int getIntermediateFrankNumber(struct options *options,
+ struct fn_counters *numberOf, struct cubicGraph *graph,
+ Array *bitsetsOfDeletableEdges, edgeset deletableEdges) {
+
+    size_t insertPosition = bitsetsOfDeletableEdges->used;
+    edgeset bitsetContainingAllEdges = graph->edgeUniverse;
+    edgeset *array = bitsetsOfDeletableEdges->array;
+
+    // Check if Frank number is 2
+    for(size_t i = 0; i < bitsetsOfDeletableEdges->used; i++) {
+
+        if(!isEmptyEdgeSet(array[i])) {
+
+            //  If the deletable edges of new orientation is a subset of older
+            //  we can dismiss it.
+            if(isSubset(deletableEdges, array[i])) {
+                numberOf->orientationsGivingSubset++;
+                return 0;
+            }
+
+            //  If the deletable edges of new orientation is superset of older
+            //  we can dismiss older. We set it to EMPTY.
+            if(isSubset(array[i], deletableEdges)) {
+                if(insertPosition == bitsetsOfDeletableEdges->used) {
+                    numberOf->orientationsGivingSuperset++;
+                }
+                array[i] = EMPTY_EDGES;
+            }
+
+            //  If union of new and older deletable edges are all edges, Frank
+            //  number is 2.
+            if(edgeSetsEqual(edgeUnion(deletableEdges, array[i]),
+             bitsetContainingAllEdges)) {
+                numberOf->complementaryBitsets++;
+                insertArray(bitsetsOfDeletableEdges, deletableEdges);
+                return 2;
+            }
+        }
+        else {
+
+            //  Prepare to store new deletable edges in first EMPTY position.
+            if(insertPosition == bitsetsOfDeletableEdges->used) {
+                insertPosition = i;
+            }
+        }
+    }
+
+    //  Store new deletable edges at first empty position or at the end of
+    //  the array.
+    if(insertPosition != bitsetsOfDeletableEdges->used) {
+        insertArrayAtPos(bitsetsOfDeletableEdges, deletableEdges,
+         insertPosition);
+    }
+    else {
+        insertArray(bitsetsOfDeletableEdges, deletableEdges);
+    }
+
+    return 0;
+}
+
+//  Check if both of the other edges incident to x, i.e. all but its i-th edge,
+//  are not in deletableEdges.
+static bool otherEdgesAreNonDeletable(struct cubicGraph *graph, int x, int i,
+ edgeset deletableEdges) {
+    for(int k = 0; k < 3; k++) {
+        if(k == i) {
+            continue;
+        }
+        if(containsEdge(deletableEdges, graph->edgeIds[x][k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Add the arc from x to its i-th neighbour y and the arcs it forces according
+// to the three rules, return false if adding leads to contradiction. Arcs are
+// given by their tail and the index of their head among its neighbours, so the
+// edge numbers are looked up in the rows of x and y only.
+static bool canAddNewArc(struct cubicGraph *graph,
+ struct orientation *orientation, int x, int i, edgeset deletableEdges) {
+    int y = graph->neighbours[x][i];
+
+    //  The index of x among the neighbours of y.
+    int j = graph->positions[x][i];
+    
+    //  If the edge already exists, there cannot be any contradictions in the
+    //  orientation
+    if(isOutgoing(graph, orientation, x, i)) {
+        return true;
+    }
+
+    if(isIncoming(graph, orientation, x, i)) {
+        return false;
+    }
+
+    int outgoingOfX = getOutgoing(graph, orientation, x);
+    int incomingOfY = getIncoming(graph, orientation, y);
+    if(degree(outgoingOfX) >= 2) {
+        return false;
+    } 
+    if(degree(incomingOfY) >= 2) {
+        return false;
+    } 
+
+    //  Deletable edges incident to same vertex need to be one incoming, one
+    //  outgoing.
+    bool xyIsDeletable = containsEdge(deletableEdges, graph->edgeIds[x][i]);
+    if(xyIsDeletable) {
+        for(int k = 0; k < 3; k++) {
+            if(k == i) {
+                continue;
+            }
+            if(containsEdge(deletableEdges, graph->edgeIds[x][k])) {
+                if(outgoingOfX & 1 << k) {
+                    return false;
+                }
+            }
+        }
+        for(int k = 0; k < 3; k++) {
+            if(k == j) {
+                continue;
+            }
+            if(containsEdge(deletableEdges, graph->edgeIds[y][k])) {
+                if(incomingOfY & 1 << k) {
+                    return false;
+                }
+            }
+        }
+    }
+    else { // xy is not in deletableEdges
+
+        // If xy was not deletable, it needs to be deletable in the current
+        // orientation, i.e. x needs to have one incoming and one outgoing
+        // apart from xy.
+        if(degree(outgoingOfX) >= 2 || 
+         degree(getIncoming(graph, orientation, x)) >= 2) {
+            return false;
+        }
+        if(degree(getOutgoing(graph, orientation, y)) >= 2 ||
+         degree(incomingOfY) >= 2) {
+            return false;
+        }
+
+        //  If xy is not deletable then it needs the be oriented in opposite
+        //  direction of other non-deletable edge incident to x.
+        for(int k = 0; k < 3; k++) {
+            if(k == i) {
+                continue;
+            }
+            if(!containsEdge(deletableEdges, graph->edgeIds[x][k])) {
+                if(isIncoming(graph, orientation, x, i)) {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        //  If xy is not deletable then it needs the be oriented in opposite
+        //  direction of other non-deletable edge incident to y
+        for(int k = 0; k < 3; k++) {
+            if(k == j) {
+                continue;
+            }
+            if(!containsEdge(deletableEdges, graph->edgeIds[y][k])) {
+                if(isOutgoing(graph, orientation, y, j)) {
+                    return false;
+                }
+                break;
+            }
+        }
+
+    }
+    orientEdge(graph, orientation, x, i);
+
+    //  If x has two outgoing and no incoming, add the final incoming.
+    int outgoing = getOutgoing(graph, orientation, x);
+    if(degree(outgoing) == 2 &&
+     degree(getIncoming(graph, orientation, x)) < 1) {
+        int last = firstOutside(outgoing);
+        if(!canAddNewArc(graph, orientation, graph->neighbours[x][last],
+         graph->positions[x][last], deletableEdges)) {
+            return false;
+        }
+    }
+
+    //  If y has no outgoing and two incoming, add the final outgoing.
+    int incoming = getIncoming(graph, orientation, y);
+    if(degree(getOutgoing(graph, orientation, y)) == 0 &&
+     degree(incoming) == 2) {
+        int last = firstOutside(incoming);
+        if(!canAddNewArc(graph, orientation, y, last, deletableEdges)) {
+            return false;
+        }
+    }
+
+    //  Deletable edges incident to same vertex need to be one incoming, one
+    //  outgoing
+    if(xyIsDeletable) {
+        for(int k = 0; k < 3; k++) {
+            if(k == i) {
+                continue;
+            }
+            if(containsEdge(deletableEdges, graph->edgeIds[x][k])) {
+                if(!canAddNewArc(graph, orientation, graph->neighbours[x][k],
+                 graph->positions[x][k], deletableEdges)) {
+                    return false;
+                }
+            }
+        }
+        for(int k = 0; k < 3; k++) {
+            if(k == j) {
+                continue;
+            }
+            if(containsEdge(deletableEdges, graph->edgeIds[y][k])) {
+                if(!canAddNewArc(graph, orientation, y, k, deletableEdges)) {
+                    return false;
+                }
+            }
+        }
+
+        //  If one deletable edge and two nondeletable, the nondeletable need to
+        //  be opposite of deletable.
+        if(otherEdgesAreNonDeletable(graph, x, i, deletableEdges)) {
+            for(int k = 0; k < 3; k++) {
+                if(k == i) {
+                    continue;
+                }
+                if(!canAddNewArc(graph, orientation, graph->neighbours[x][k],
+                 graph->positions[x][k], deletableEdges)) {
+                    return false;
+                }
+            }
+        }
+
+        if(otherEdgesAreNonDeletable(graph, y, j, deletableEdges)) {
+            for(int k = 0; k < 3; k++) {
+                if(k == j) {
+                    continue;
+                }
+                if(!canAddNewArc(graph, orientation, y, k, deletableEdges)) {
+                    return false;
+                }
+            }
+        }
+    }
+    else { // xy is not in deletableEdges
+
+        // xy needs to be deletable, so if we have two incoming of y, we need an
+        // outgoing.
+        outgoing = getOutgoing(graph, orientation, y);
+        incoming = getIncoming(graph, orientation, y);
+        if(degree(outgoing) == 0 && degree(incoming) == 2) {
+            int last = firstOutside(outgoing);
+            if(!canAddNewArc(graph, orientation, y, last, deletableEdges)) {
+                return false;
+            }
+            outgoing = getOutgoing(graph, orientation, y);
+            incoming = getIncoming(graph, orientation, y);
+        }
+
+        // xy needs to be deletable, so if we have one outgoing, one incoming to
+        // y, we need an incoming.
+        if(degree(outgoing) == 1 && degree(incoming) == 1) {
+            int last = firstOutside(outgoing | incoming);
+            if(!canAddNewArc(graph, orientation, graph->neighbours[y][last],
+             graph->positions[y][last], deletableEdges)) {
+                return false;
+            }
+        }
+
+        //  If xy is not deletable then it needs the be oriented in opposite
+        //  direction of other non-deletable edge incident to x
+        for(int k = 0; k < 3; k++) {
+            if(k == i) {
+                continue;
+            }
+            if(!containsEdge(deletableEdges, graph->edgeIds[x][k])) {
+                if(!canAddNewArc(graph, orientation, x, k, deletableEdges)) {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        //  If xy is not deletable then it needs the be oriented in opposite
+        //  direction of other non-deletable edge incident to y
+        for(int k = 0; k < 3; k++) {
+            if(k == j) {
+                continue;
+            }
+            if(!containsEdge(deletableEdges, graph->edgeIds[y][k])) {
+                if(!canAddNewArc(graph, orientation, graph->neighbours[y][k],
+                 graph->positions[y][k], deletableEdges)) {
+                    return false;
+                }
+                break;
+            }
+        }
+
+    }
+    return true;
+}
+
+#ifdef SEARCH_PROFILE
+//  Reason why canAddNewArc() rejected the arc from x to its i-th neighbour,
+//  given the orientation before the call. Only the degree checks of the arc
+//  itself are distinguished.
+static enum fn_prune_reason getRejectionReason(struct cubicGraph *graph,
+ struct orientation *orientation, int x, int i) {
+    if(degree(getOutgoing(graph, orientation, x)) >= 2) {
+        return FN_PRUNED_OUT_DEGREE;
+    }
+    if(degree(getIncoming(graph, orientation, graph->neighbours[x][i])) >= 2) {
+        return FN_PRUNED_IN_DEGREE;
+    }
+    return FN_PRUNED_CONTRADICTION;
+}
+#endif
+
+//  Loop over all edges and try orienting them in both directions. Complete
+//  orientations are written to diGraph to compute their deletable edges.
+static bool canCompleteCompOrientation(struct cubicGraph *graph,
+ struct options *options, struct orientation *orientation,
+ edgeset deletableEdges, int edge, struct diGraph *diGraph,
+ struct certificate *certificate) {
+
+    if(shouldAbort(options)) {
+        return false;
+    }
+
+    //  We have oriented all edges.
+    if(edge == graph->numberOfEdges) {
+        PROFILE_NODE(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge);
+        if(!edgeSetsEqual(orientation->oriented, graph->edgeUniverse)) {
+            fprintf(stderr, "%s\n", "Something went wrong");
+        }
+
+        //  Check if formed orientation actually is complementary.
+        getDiGraph(graph, orientation, diGraph);
+        edgeset complementDeletableEdges = getDeletableEdges(graph, diGraph);
+        if(edgeSetsEqual(edgeUnion(deletableEdges, complementDeletableEdges),
+         graph->edgeUniverse)) {
+            if(options->printFlag) {
+                printDeletableEdges(graph, diGraph->adjacencyList,
+                 complementDeletableEdges);
+                printDiGraph(diGraph);
+            }
+            if(certificate != NULL) {
+                memcpy(certificate->orientation[1], diGraph->adjacencyList,
+                 sizeof(bitset)*graph->numberOfVertices);
+            }
+            return true;
+        }
+        PROFILE_PRUNED(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge,
+         FN_PRUNED_NOT_COMPLEMENTARY);
+        return false;
+    }
+
+    //  If already oriented, go to next edge.
+    if(containsEdge(orientation->oriented, edge)) {
+        return canCompleteCompOrientation(graph, options, orientation,
+         deletableEdges, edge + 1, diGraph, certificate);
+    }
+
+    PROFILE_NODE(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge);
+    int endpoint1 = graph->endpoints[edge][0];
+    int endpoint2 = graph->endpoints[edge][1];
+    int position = getPosition(graph, endpoint1, endpoint2);
+
+    //  Make copy of orientation
+    struct orientation orientationCopy = *orientation;
+
+    //  Try adding endpoint1->endpoint2
+    if(canAddNewArc(graph, orientation, endpoint1, position,
+     deletableEdges)) {
+
+        //  Continue with next edge.
+        if(canCompleteCompOrientation(graph, options, orientation,
+         deletableEdges, edge + 1, diGraph, certificate)) {
+            return true;
+       }
+    }
+#ifdef SEARCH_PROFILE
+    else {
+        PROFILE_PRUNED(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge,
+         getRejectionReason(graph, &orientationCopy, endpoint1, position));
+    }
+#endif
+
+    //  Put orientation back to before we added endpoint1->endpoint2.
+    *orientation = orientationCopy;
+
+    //  Try adding endpoint2->endpoint1.
+    if(canAddNewArc(graph, orientation, endpoint2,
+     graph->positions[endpoint1][position], deletableEdges)) {
+
+        //  Continue with next edge.
+        if(canCompleteCompOrientation(graph, options, orientation,
+         deletableEdges, edge + 1, diGraph, certificate)) {
+            return true;
+        }
+    }
+#ifdef SEARCH_PROFILE
+    else {
+        PROFILE_PRUNED(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge,
+         getRejectionReason(graph, &orientationCopy, endpoint2,
+         graph->positions[endpoint1][position]));
+    }
+#endif
+
+    //  Both orientations lead to contradiction.
+    PROFILE_BACKTRACK(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, edge);
+    return false;
+}
+
+//  The scratch memory taken by hasComplementaryOrientation().
+static size_t getComplementaryOrientationArenaSize(int numberOfVertices) {
+    return getDiGraphArenaSize(numberOfVertices);
+}
+
+static bool hasComplementaryOrientation(struct cubicGraph *graph,
+ struct options *options, edgeset deletableEdgesOfOrientationTocomplement,
+ struct certificate *certificate) {
+
+    //  This will complement the given orientation.
+    struct orientation orientation = emptyOrientation();
+    size_t arenaUsed = options->arena->used;
+    struct diGraph diGraph = allocateDiGraph(options->arena,
+     graph->numberOfVertices);
+
+    //  Fix a first arc, does not matter which or in what direction.
+    //  (Orientation with opposite arcs has same deletable edges.)
+    PROFILE_NODE(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, 0);
+    bool hasCompOrientation = false;
+    if(canAddNewArc(graph, &orientation, 0, 0,
+     deletableEdgesOfOrientationTocomplement)) {
+        hasCompOrientation = canCompleteCompOrientation(graph, options,
+         &orientation, deletableEdgesOfOrientationTocomplement, 0, &diGraph,
+         certificate);
+    }
+    else {
+        PROFILE_PRUNED(options, FN_SEARCH_COMPLEMENTARY_ORIENTATION, 0,
+         FN_PRUNED_CONTRADICTION);
+    }
+
+    options->arena->used = arenaUsed;
+    return hasCompOrientation;
+}
+
+//  Perform one of the exact methods on a strong orientation, stored in
+//  diGraph, with the given deletable edges.
+static int checkStrongOrientation(struct cubicGraph *graph,
+ struct options *options, struct fn_counters *numberOf,
+ Array *bitsetsOfDeletableEdges, struct diGraph *diGraph,
+ edgeset deletableEdges, struct certificate *certificate) {
+
+    //  Check if there is a vertex with three non-deletable incident edges. In
+    //  this case orientation has no complementary orientation giving fn=2.
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        bool noIncidentEdgesDeletable = true;
+        for(int k = 0; k < 3; k++) {
+            if(containsEdge(deletableEdges, graph->edgeIds[i][k])) {
+                noIncidentEdgesDeletable = false;
+            }
+        }
+        if(noIncidentEdgesDeletable) {
+            PROFILE_PRUNED(options, FN_SEARCH_ORIENTATIONS,
+             graph->numberOfEdges, FN_PRUNED_NO_DELETABLE_EDGE);
+            return 0;
+        }
+    }
+
+    numberOf->generatedOrientations++;
+
+    //  Try finding a complement to the current orientation.
+    if(!options->bruteForceFlag) {
+        struct phaseStart start;
+        startPhase(options, &start, FN_PHASE_COMPLEMENTARY_ORIENTATION);
+        bool hasCompOrientation = hasComplementaryOrientation(graph, options,
+         deletableEdges, certificate);
+        endPhase(options, &start, FN_PHASE_COMPLEMENTARY_ORIENTATION);
+        if(hasCompOrientation) {
+            if(options->printFlag) {
+                printDeletableEdges(graph, diGraph->adjacencyList,
+                 deletableEdges);
+                printDiGraph(diGraph);
+            }
+            if(certificate != NULL) {
+                memcpy(certificate->orientation[0], diGraph->adjacencyList,
+                 sizeof(bitset)*graph->numberOfVertices);
+                certificate->found = true;
+            }
+            return 2;
+        } 
+        return 0;
+    }
+
+    //  If not complementFlag, try using the bruteforce method of comparing
+    //  all orientations pairwise.
+    return getIntermediateFrankNumber(options, numberOf, graph,
+     bitsetsOfDeletableEdges, deletableEdges);
+}
+
+//  Generate strong orientations of graph, get deletable edges and perform one
+//  of the exact methods. possibleSuccessors holds orientation as a strongly
+//  connected mixed graph, see orientPossibleArc(), so every complete
+//  orientation is strong. reachability holds the reachability of its oriented
+//  arcs. It is written to diGraph to compute its deletable
+//  edges from those of the previous one in cache. lastLeaf is the last
+//  complete orientation generated, which gives the Gray code order.
+static int generateAllOrientations(struct cubicGraph *graph,
+ struct options *options, struct fn_counters *numberOf,
+ Array *bitsetsOfDeletableEdges, struct orientation *orientation, int edge,
+ bitset possibleSuccessors[], struct orientedReachability *reachability,
+ struct orientation *lastLeaf, struct diGraph *diGraph,
+ struct deletableEdgesCache *cache, struct certificate *certificate) {
+
+    if(shouldAbort(options)) {
+        return 0;
+    }
+
+    //  All edges are oriented.
+    if(edge == graph->numberOfEdges) {
+
+        numberOf->totalOrientationsGenerated++;
+        *lastLeaf = *orientation;
+
+        //  Skip orientations which do not have correct remainder.
+        if(options->singleGraphFlag) {
+            if(numberOf->totalOrientationsGenerated % options->modulo != 
+             options->remainder) {
+               return 0; 
+            }
+        }
+
+        PROFILE_NODE(options, FN_SEARCH_ORIENTATIONS, edge);
+        getDiGraph(graph, orientation, diGraph);
+        struct phaseStart start;
+        startPhase(options, &start, FN_PHASE_DELETABLE_EDGES);
+        edgeset deletableEdges = updateDeletableEdges(graph, cache,
+         orientation, diGraph);
+        endPhase(options, &start, FN_PHASE_DELETABLE_EDGES);
+        return checkStrongOrientation(graph, options, numberOf,
+         bitsetsOfDeletableEdges, diGraph, deletableEdges, certificate);
+    }
+
+    //  Orient edge both ways and continue with next edge. In Gray code order
+    //  the edge is first oriented as in the last complete orientation, such
+    //  that consecutive complete orientations differ in few edges. This is the
+    //  last one generated rather than checked, so that all parts of a graph
+    //  split by the remainder generate the orientations in the same order.
+    int frankNumberUpperBound = 0;
+    int endpoint1 = graph->endpoints[edge][0];
+    int endpoint2 = graph->endpoints[edge][1];
+    int position = getPosition(graph, endpoint1, endpoint2);
+    bool isReversedFirst = options->grayCodeFlag &&
+     containsEdge(lastLeaf->oriented, edge) &&
+     !containsEdge(lastLeaf->direction, edge);
+    struct orientation snapshot = *orientation;
+    PROFILE_NODE(options, FN_SEARCH_ORIENTATIONS, edge);
+    for(int i = 0; i < 2 && !frankNumberUpperBound; i++) {
+        bool isReversed = (i == 1) != isReversedFirst;
+        int tail = isReversed ? endpoint2 : endpoint1;
+        int head = isReversed ? endpoint1 : endpoint2;
+        orientEdge(graph, orientation, tail,
+         isReversed ? graph->positions[endpoint1][position] : position);
+        int outDegree = degree(getOutgoing(graph, orientation, tail));
+        if(outDegree != 3 &&
+         degree(getIncoming(graph, orientation, head)) != 3) {
+            if(orientPossibleArc(possibleSuccessors, reachability, tail,
+             head)) {
+                int mark = reachability->numberOfChanges;
+                addOrientedArc(reachability, graph->numberOfVertices, tail,
+                 head);
+                frankNumberUpperBound = generateAllOrientations(graph,
+                 options, numberOf, bitsetsOfDeletableEdges, orientation,
+                 edge + 1, possibleSuccessors, reachability, lastLeaf,
+                 diGraph, cache, certificate);
+                removeOrientedArcs(reachability, mark);
+                add(possibleSuccessors[head], tail);
+            }
+            else {
+                PROFILE_PRUNED(options, FN_SEARCH_ORIENTATIONS, edge,
+                 FN_PRUNED_NOT_STRONGLY_CONNECTED);
+            }
+        }
+        else {
+            PROFILE_PRUNED(options, FN_SEARCH_ORIENTATIONS, edge,
+             outDegree == 3 ? FN_PRUNED_OUT_DEGREE : FN_PRUNED_IN_DEGREE);
+        }
+        *orientation = snapshot;
+    }
+
+    if(frankNumberUpperBound) {
+        return frankNumberUpperBound;
+    }
+
+    //  None of the orientations of this edge led to an orientation of the graph
+    //  which has a second orientation giving fn=2.
+    PROFILE_BACKTRACK(options, FN_SEARCH_ORIENTATIONS, edge);
+    return 0;
+}
+
+//  The scratch memory taken by findFrankNumber() itself, i.e. without that of
+//  hasComplementaryOrientation().
+static size_t getFindFrankNumberArenaSize(int numberOfVertices) {
+    return roundUpToAlignment(sizeof(bitset)*numberOfVertices) +
+     getOrientedReachabilityArenaSize(numberOfVertices) +
+     getDiGraphArenaSize(numberOfVertices) +
+     roundUpToAlignment(sizeof(struct deletableEdgesCache));
+}
+
+//  The array used by the brute force method is only allocated once and reused
+//  for every graph.
+static int findFrankNumber(struct cubicGraph *graph, struct options *options,
+ struct fn_counters *numberOf, Array *bitsetsOfDeletableEdges,
+ struct certificate *certificate) {
+    if(options->bruteForceFlag && bitsetsOfDeletableEdges->array == NULL) {
+        initArray(bitsetsOfDeletableEdges, options->sizeOfArray);
+    }
+    bitsetsOfDeletableEdges->used = 0;
+
+    struct orientation orientation = emptyOrientation();
+    struct orientation lastLeaf = emptyOrientation();
+    size_t arenaUsed = options->arena->used;
+    bitset *possibleSuccessors = arenaAllocate(options->arena,
+     sizeof(bitset)*graph->numberOfVertices);
+    memcpy(possibleSuccessors, graph->adjacencyList,
+     sizeof(bitset)*graph->numberOfVertices);
+    struct orientedReachability reachability =
+     allocateOrientedReachability(options->arena, graph->numberOfVertices);
+    struct diGraph diGraph = allocateDiGraph(options->arena,
+     graph->numberOfVertices);
+    struct deletableEdgesCache *cache = arenaAllocate(options->arena,
+     sizeof(struct deletableEdgesCache));
+    cache->isValid = false;
+    cache->deletableEdges = EMPTY_EDGES;
+
+    struct phaseStart start;
+    startPhase(options, &start, FN_PHASE_ORIENTATIONS);
+    int frankNumber = generateAllOrientations(graph, options, numberOf,
+     bitsetsOfDeletableEdges, &orientation, 0, possibleSuccessors,
+     &reachability, &lastLeaf, &diGraph, cache, certificate);
+    endPhase(options, &start, FN_PHASE_ORIENTATIONS);
+
+    //  In bruteforce case, we now have a list of bitsets corresponding to
+    //  deletable edges of (all) orientations.
+    if(options->bruteForceFlag) {
+        numberOf->storedBitsets = bitsetsOfDeletableEdges->used;
+        if(numberOf->storedBitsets > options->sizeOfArray) {
+            options->sizeOfArray = bitsetsOfDeletableEdges->size;
+        }
+        if(options->verboseFlag) {
+            fprintf(stderr, "\tBitsets stored: %llu, size of array %llu\n", 
+             numberOf->storedBitsets, options->sizeOfArray);
+        }
+
+        //  Count empty bitsets stored and check that there are enough
+        //  orientations for the Frank number to make sense. (This should of
+        //  course always be the case.)
+        edgeset universe = EMPTY_EDGES;
+        for(size_t i = 0; i < bitsetsOfDeletableEdges->used; i++) {
+            if(isEmptyEdgeSet(bitsetsOfDeletableEdges->array[i])) {
+                numberOf->emptyBitsetsStored++;
+            }
+            universe = edgeUnion(universe, bitsetsOfDeletableEdges->array[i]);
+        }
+        if(options->verboseFlag) {
+            fprintf(stderr, "\tEmpty bitsets stored: %llu \n", 
+             numberOf->emptyBitsetsStored);
+        }
+        if(!options->aborted &&
+         !edgeSetsEqual(universe, graph->edgeUniverse)) {
+            fprintf(stderr, "%s\n",
+             "Error: Not enough orientations for Frank number to make sense.");
+        }
+    }
+
+    options->arena->used = arenaUsed;
+    return frankNumber;
+}
+
+//******************************************************************************
+//
+//                              Heuristic algorithm
+//
+//******************************************************************************
+
+//  Array and bitset representation of a cycle.
+struct cycle {
+    bitset cycleElements;
+    int numberOfElements;
+    int *cycle;
+};
+
+//  Count the odd cycles in a complement of the perfect F F. Assuming
+//  graphs to be cubic and bridgeless. We also store for each even cycle a
+//  maximal F in M.
+static bool containsTwoOddCycles(struct cubicGraph *graph, int F[],
+ struct cycle oddCycles[], int M[]) {
+
+    for(int i = 0; i < graph->numberOfVertices; i++) {
+        M[i] = -1;
+    }
+    int numberOfOddCycles = 0;
+    bitset uncheckedVertices = graph->vertexUniverse;
+
+    //  Loop over all cycles and check parity
+    //  Store the odd edges of each cycle in M
+    while(!isEmpty(uncheckedVertices)) {
+        int element = first(uncheckedVertices);
+        int currentVertex = element;
+        int previousVertex = -1;
+        bool cycleIsOdd = false;
+        bitset cycle = EMPTY;
+        if(numberOfOddCycles < 2) {
+            oddCycles[numberOfOddCycles].numberOfElements = 0;
+        }
+        do {
+            removeElement(uncheckedVertices, currentVertex);
+            add(cycle, currentVertex);
+            if(numberOfOddCycles < 2) {
+                oddCycles[numberOfOddCycles].cycle[
+                 oddCycles[numberOfOddCycles].numberOfElements++] = 
+                 currentVertex;
+            }
+            int nextVertex = otherNeighbour(graph, currentVertex,
+             previousVertex, F[currentVertex]);
+            if(M[currentVertex] == -1) {
+                M[currentVertex] = nextVertex;
+                M[nextVertex] = currentVertex;
+            }
+            previousVertex = currentVertex;
+            currentVertex = nextVertex;
+            cycleIsOdd = !cycleIsOdd;
+        } while(currentVertex != element);
+
+        if(cycleIsOdd) {
+            if(numberOfOddCycles < 2) {
+                oddCycles[numberOfOddCycles].cycleElements = cycle;
+            }
+            numberOfOddCycles++;
+            if(numberOfOddCycles > 2) {
+                return false;
+            }
+        }   
+    }
+    return numberOfOddCycles == 2;
+}
+
+//  Add maximal F of odd cycles - x1 - x2 to M.
+static void getOddCycleMatching(struct cycle oddCycles[], int indexOfx1,
+ int indexOfx2, int M[]) {
+
+    int currentIndex = indexOfx1;
+    bool addToMatching = false;
+    do { 
+        int nextIndex = (currentIndex + 1) % oddCycles[0].numberOfElements;
+        if(addToMatching) {
+            M[oddCycles[0].cycle[nextIndex]] = oddCycles[0].cycle[currentIndex];
+            M[oddCycles[0].cycle[currentIndex]] = oddCycles[0].cycle[nextIndex];
+        }
+        addToMatching = !addToMatching;
+        currentIndex = nextIndex;
+    } while(currentIndex != indexOfx1);
+
+    currentIndex = indexOfx2;
+    addToMatching = false;
+    do { 
+        int nextIndex = (currentIndex + 1) % oddCycles[1].numberOfElements;
+        if(addToMatching) {
+            M[oddCycles[1].cycle[nextIndex]] = oddCycles[1].cycle[currentIndex];
+            M[oddCycles[1].cycle[currentIndex]] = oddCycles[1].cycle[nextIndex];
+        }
+        addToMatching = !addToMatching;
+        currentIndex = nextIndex;
+    } while(currentIndex != indexOfx2);
+}
+
+//  Find the index of u in arr[].
+static int findInArray(int u, int arr[], int arrLength) {
+    for(int i = 0; i < arrLength; i++) {
+        if(arr[i] == u) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Check if orientation of F - {x1,x2,(y1,y2)} is consistent on the cycle
+// containing u and v.
+static bool circuitOrientationIsConsistent(int M[], int F[],
+ int circuitOrientation[], int u, int v) {
+
+    //  If circuit containing u of F - {x1,x2,(y1,y2)} not yet oriented, orient
+    //  it.
+    if(circuitOrientation[u] == -1) {
+
+        //  Orient the edges incident to u such that they are consistent with
+        //  the edges incident to v on the cycle containing u and v. If
+        //  circuitOrientation[v] is still -1, the direction we orient the
+        //  edges incident with u does not matter. 
+        int takeMaximalMatching = (circuitOrientation[v] == F[v]);
+        int currentVertex = u;
+        do {
+            int nextVertex = takeMaximalMatching ? M[currentVertex] : 
+             F[currentVertex];
+            circuitOrientation[currentVertex] = nextVertex;
+            currentVertex = nextVertex;
+            takeMaximalMatching = !takeMaximalMatching;
+        } while (currentVertex != u);
+    }
+
+    if(circuitOrientation[v] == -1) {
+        int takeMaximalMatching = (circuitOrientation[u] == F[u]);
+        int currentVertex = v;
+        do {
+            int nextVertex = takeMaximalMatching ? M[currentVertex] :
+             F[currentVertex];
+            circuitOrientation[currentVertex] = nextVertex;
+            currentVertex = nextVertex;
+            takeMaximalMatching = !takeMaximalMatching;
+        } while (currentVertex != v);
+    }
+    return (circuitOrientation[u] == F[u]) == (circuitOrientation[v] == M[v]);
+}
+
+//  If we are checking the heuristic with the even cycle, M might not be a
+//  correct maximal matching of this even cycle. Redo it.
+static void rematch(struct cubicGraph *graph, int M[], int F[], int y1,
+ int y2) {
+    int previousVertex = y2;
+    int currentVertex = y1;
+    bool addToMaximalMatching = false;
+    do {
+        int nextVertex = otherNeighbour(graph, currentVertex, F[currentVertex],
+         previousVertex);
+        if(addToMaximalMatching) {
+            M[currentVertex] =  nextVertex;
+            M[nextVertex] = currentVertex;
+        }
+        previousVertex = currentVertex;
+        currentVertex = nextVertex;
+        addToMaximalMatching = !addToMaximalMatching; 
+    } while(currentVertex != y2);
+
+    M[y1] = y2;
+    M[y2] = y1;
+}
+
+//  For checking cyclic connectivity.
+static void DFS(bitset adjacencyList[], bitset *component,
+ bitset *uncheckedVertices, int v, int parent, bool *cycleFound) {
+
+    //  If checked before: cycle found.
+    if(contains(*component, v)) {
+        *cycleFound = true;
+        return;
+    }
+    removeElement(*uncheckedVertices, v);
+    add(*component, v);
+
+    //  Do not go back to parent.
+    forEach(nbr, difference(adjacencyList[v], singleton(parent))) {
+        DFS(adjacencyList, component, uncheckedVertices, nbr, v, cycleFound);
+    } 
+}
+
+//  The adjacency list of the graph may have edges removed.
+static bool isCyclicallyConnected(struct cubicGraph *graph) {
+    bitset uncheckedVertices = graph->vertexUniverse;
+    int numberOfComponents = 0;
+    int numberOfComponentsWithCycle = 0;
+    bitset components[graph->numberOfVertices];
+    while(!isEmpty(uncheckedVertices)) {
+        int v = first(uncheckedVertices);
+        numberOfComponents++;
+        components[numberOfComponents - 1] = EMPTY;
+        bool cycleFound = false;
+        DFS(graph->adjacencyList, &components[numberOfComponents - 1],
+         &uncheckedVertices, v, -1, &cycleFound);
+        if(cycleFound) {
+            numberOfComponentsWithCycle++;
+        }
+        if(numberOfComponentsWithCycle >= 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define removeEdgeFromAdjList(adjacencyList, endpoint1, endpoint2) {\
+    removeElement(adjacencyList[endpoint1], endpoint2);\
+    removeElement(adjacencyList[endpoint2],endpoint1);\
+}
+#define addEdgeToAdjList(adjacencyList, endpoint1, endpoint2) {\
+    add(adjacencyList[endpoint1], endpoint2);\
+    add(adjacencyList[endpoint2],endpoint1);\
+}
+
+//  Check if edge is a strong 2-edge under the assumption it is valuated 2 in
+//  the flow. Hence, we only check it is not part of some cycle-separating
+//  3-edge-set containing two other edges from circuitOrientation (This is a
+//  sufficient condition.)
+static bool edgeIsStrong2Edge(struct cubicGraph *graph, int endpoint1,
+ int endpoint2, int circuitOrientation[]) {
+    bitset *adjacencyList = graph->adjacencyList;
+    int numberOfVertices = graph->numberOfVertices;
+    bool hasCyclic211cut = false;
+    removeEdgeFromAdjList(adjacencyList, endpoint1, endpoint2);
+
+    //  Loop over all pairs of edges in the perfect F.
+    for(int i = 0; i < numberOfVertices; i++) {
+
+        //  Should not look at edge we already suppressed.
+        if(circuitOrientation[i] == -1) {
+            continue;
+        }
+        removeEdgeFromAdjList(adjacencyList, i, circuitOrientation[i]);
+
+        for(int j = i+1; j < numberOfVertices; j++) {
+            if(circuitOrientation[j] == -1) {
+                continue;
+            }
+            removeEdgeFromAdjList(adjacencyList, j, circuitOrientation[j]);
+
+            if(!isCyclicallyConnected(graph)) {
+                hasCyclic211cut = true;
+            }
+            addEdgeToAdjList(adjacencyList, j, circuitOrientation[j]);
+
+            if(hasCyclic211cut) {
+                break;
+            }
+        }
+
+        addEdgeToAdjList(adjacencyList, i, circuitOrientation[i]);
+        if(hasCyclic211cut) {
+            break;
+        }
+    }
+    addEdgeToAdjList(adjacencyList, endpoint1, endpoint2);
+    return !hasCyclic211cut;
+}
+
+//  Are the suppressed strong 2-edges in the nz 4-flow deletable?
+static bool suppressedEdgesAreDeletable(struct cubicGraph *graph,
+ int circuitOrientation[], int edgesBetweenCycles[],
+ int numberOfEdgesBetweenCycles) {
+    bitset *adjacencyList = graph->adjacencyList;
+    bool edgesAreDeletable = true;
+    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
+        removeEdgeFromAdjList(adjacencyList, edgesBetweenCycles[2*i],
+         edgesBetweenCycles[2*i+1]);
+    }
+    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
+        if(!edgeIsStrong2Edge(graph,
+         edgesBetweenCycles[2*i], first(adjacencyList[edgesBetweenCycles[2*i]]),
+         circuitOrientation)){
+            edgesAreDeletable = false;
+            break;
+        }
+        if(!edgeIsStrong2Edge(graph,
+         edgesBetweenCycles[2*i+1], first(
+         adjacencyList[edgesBetweenCycles[2*i+1]]), circuitOrientation)){
+            edgesAreDeletable = false;
+            break;
+        }
+    }
+    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
+        addEdgeToAdjList(adjacencyList, edgesBetweenCycles[2*i],
+         edgesBetweenCycles[2*i+1]);
+    }
+    return edgesAreDeletable;
+}
+
+//  Used for double checking heuristic algorithm.
+static void verifyOddnessHeuristicOrientations(struct cubicGraph *graph,
+ struct options *options, int circuitOrientation[], int F[], int M[],
+ int edgesBetweenCycles[], int numberOfEdgesBetweenCycles,
+ struct certificate *certificate); 
+
+//  The scratch memory taken by hasSufficientCondition() itself, i.e. without
+//  that of verifyOddnessHeuristicOrientations().
+static size_t getSufficientConditionArenaSize(int numberOfVertices) {
+    return 2*roundUpToAlignment(sizeof(int)*numberOfVertices);
+}
+
+//  The scratch memory taken by verifyOddnessHeuristicOrientations().
+static size_t getVerifyOddnessArenaSize(int numberOfVertices) {
+    return 2*getDiGraphArenaSize(numberOfVertices);
+}
+
+// Generate all perfect matchings of the graph and check for each of the
+// complementary 2-factors whether one of the configurations for the sufficient
+// conditions are present.
+static bool hasSufficientCondition(struct cubicGraph *graph,
+ struct options *options, struct fn_counters *numberOf,
+ bitset remainingVertices, int F[], struct certificate *certificate) {
+
+    if(shouldAbort(options)) {
+        return false;
+    }
+
+    //  If this holds, F is a perfect matching.
+    int nextVertex = next(remainingVertices, -1);
+    if(nextVertex == -1) {
+
+        int numberOfVertices = graph->numberOfVertices;
+        size_t arenaUsed = options->arena->used;
+        struct cycle oddCycles[2];
+        oddCycles[0].cycle = arenaAllocate(options->arena,
+         sizeof(int)*numberOfVertices);
+        oddCycles[1].cycle = arenaAllocate(options->arena,
+         sizeof(int)*numberOfVertices);
+        int M[numberOfVertices];
+        if(containsTwoOddCycles(graph, F, oddCycles, M)) {
+
+            //  Check if odd cycles are connected via an edge uv
+            forEach(u, oddCycles[0].cycleElements) {
+                int v = F[u];
+                if(contains(oddCycles[1].cycleElements, v)) {
+                    int indexOfx1 = findInArray(u, oddCycles[0].cycle,
+                     oddCycles[0].numberOfElements);
+                    int indexOfx2 = findInArray(v, oddCycles[1].cycle,
+                     oddCycles[1].numberOfElements);
+
+                    //  Add a maximal matching of the odd cycles to the maximal
+                    //  matching M of G - F
+                    getOddCycleMatching(oddCycles, indexOfx1, indexOfx2, M);
+
+                    int u1 = oddCycles[0].cycle[
+                        (indexOfx1 + 1) % oddCycles[0].numberOfElements];
+                    int u2 = oddCycles[1].cycle[
+                        (indexOfx2 + 1) % oddCycles[1].numberOfElements];
+                    int v1 = oddCycles[0].cycle[
+                        (oddCycles[0].numberOfElements + indexOfx1 - 1) % 
+                        oddCycles[0].numberOfElements];
+                    int v2 = oddCycles[1].cycle[
+                        (oddCycles[1].numberOfElements + indexOfx2 - 1) % 
+                        oddCycles[1].numberOfElements];                    
+                    
+                    //  Orient cycles of F and check condition
+                    int circuitOrientation[numberOfVertices];
+                    //  Can be optimized!
+                    for(int i = 0; i < numberOfVertices; i++) {
+                        circuitOrientation[i] = -1;
+                    }
+                    if(circuitOrientationIsConsistent(M, F,
+                     circuitOrientation, u1, v1) && 
+                     circuitOrientationIsConsistent(M, F,
+                     circuitOrientation, u2, v2)) {
+                        int edgesBetweenCycles[] = {u,v};
+                        if(suppressedEdgesAreDeletable(graph,
+                         circuitOrientation, edgesBetweenCycles, 1)) {
+                            numberOf->graphsSatisfyingFirstOddness++;
+                            if(options->doublecheckFlag || options->printFlag
+                             || certificate != NULL) {
+                                verifyOddnessHeuristicOrientations(graph,
+                                 options, circuitOrientation, F, M,
+                                 edgesBetweenCycles, 1, certificate);
+                            }
+                            options->arena->used = arenaUsed;
+                            return true;
+                        }
+                        if(options->verboseFlag) {
+                            fprintf(stderr, "Not deletable: first\n");
+                        }
+                    }
+                    continue;
+                }
+                if(!contains(oddCycles[0].cycleElements, v)) {
+                    int nbrOfU = v;
+                    for(int k = 0; k < 3; k++) {
+                        int nbrOfV = graph->neighbours[nbrOfU][k];
+                        if(nbrOfV == u) {
+                            continue;
+                        }
+                        v = next(intersection(graph->adjacencyList[nbrOfV],
+                         oddCycles[1].cycleElements),-1);
+                        if(v == -1) {
+                            continue;
+                        }
+                        int indexOfx1 = findInArray(u, oddCycles[0].cycle,
+                         oddCycles[0].numberOfElements);
+                        int indexOfx2 = findInArray(v, oddCycles[1].cycle,
+                         oddCycles[1].numberOfElements);
+                        getOddCycleMatching(oddCycles, indexOfx1, indexOfx2,
+                         M);
+                        int u1 = oddCycles[0].cycle[(indexOfx1 + 1) %
+                         oddCycles[0].numberOfElements];
+                        int u2 = oddCycles[1].cycle[(indexOfx2 + 1) %
+                         oddCycles[1].numberOfElements];
+                        int v1 = oddCycles[0].cycle[
+                         (oddCycles[0].numberOfElements + indexOfx1 - 1) % 
+                         oddCycles[0].numberOfElements];
+                        int v2 = oddCycles[1].cycle[
+                         (oddCycles[1].numberOfElements + indexOfx2 - 1) %
+                         oddCycles[1].numberOfElements];
+                        int w1 = otherNeighbour(graph, nbrOfU, nbrOfV,
+                         F[nbrOfU]);
+                        int w2 = otherNeighbour(graph, nbrOfV, nbrOfU,
+                         F[nbrOfV]);
+                        
+                        //  Orient cycles and check condition
+                        int circuitOrientation[numberOfVertices];
+                        for(int i = 0; i < numberOfVertices; i++) {
+                            circuitOrientation[i] = -1;
+                        }
+
+                        //  Adapt the matching of the even cycle such that M is
+                        //  still maximal in C - {x1,x2,y1,y2}
+                        if(M[nbrOfU] != nbrOfV) {
+                            rematch(graph, M, F, nbrOfU, nbrOfV);
+                        }
+
+                        //  Check if orientations are consistent
+                        if(circuitOrientationIsConsistent(M, F,
+                         circuitOrientation, u1, v1) && 
+                         circuitOrientationIsConsistent(M, F,
+                         circuitOrientation, u2, v2) && 
+                         circuitOrientationIsConsistent(M, F,
+                         circuitOrientation, w1, w2)) {
+                            int edgesBetweenCycles[] = {u, nbrOfU, nbrOfV, v};
+                            if(suppressedEdgesAreDeletable(graph,
+                             circuitOrientation, edgesBetweenCycles, 2)) {
+                                numberOf->graphsSatisfyingSecondOddness++;
+                                if(options->doublecheckFlag || 
+                                 options->printFlag || certificate != NULL) {
+                                    verifyOddnessHeuristicOrientations(graph,
+                                     options, circuitOrientation, F, M,
+                                     edgesBetweenCycles, 2, certificate);
+                                }
+                                options->arena->used = arenaUsed;
+                                return true;
+                            }
+                            if(options->verboseFlag) {
+                                fprintf(stderr, "Not deletable\n");
+                            }
+                        }
+                        continue;
+                    }
+                }
+            }
+        }
+
+        //  None of the configurations were present for this perfect matching.
+        options->arena->used = arenaUsed;
+        return false;
+    }
+
+    //  F is not yet a perfect matching here. 
+    forEach(neighbor, intersection(graph->adjacencyList[nextVertex],
+     remainingVertices)) {
+        F[neighbor] = nextVertex;
+        F[nextVertex] = neighbor;
+        bitset newRemainingVertices = difference(remainingVertices,
+         union(singleton(nextVertex), singleton(neighbor)));
+        if(hasSufficientCondition(graph, options, numberOf,
+         newRemainingVertices, F, certificate)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//  Make the concrete orientations for double checking the heuristic algorithm.
+static void orient2FactorCyclesInComplementaryOrientations(
+ struct cubicGraph *graph, int F[], int circuitOrientation[],
+ int startingVertex, bitset *uncheckedVertices, struct diGraph *orientation1,
+ struct diGraph *orientation2) {
+    int currentVertex = startingVertex;
+
+    //  Currentvertex lies on a cycle of the 2-factor. Circuitorientation
+    //  orients an outgoing edge of this cycle from one of the neighbours of
+    //  currentvertex. We want to orient the cycle in this direction. Hence,
+    //  previousvertex should be oriented in the circuitorientation and
+    //  prev->curr should be the direction we are orienting, hence
+    //  circuitOrientation[prev] should be F[prev];
+    int previousVertex = otherNeighbour(graph, currentVertex,
+     F[currentVertex], -1);
+    if(circuitOrientation[previousVertex] == -1 || 
+     circuitOrientation[previousVertex] != F[previousVertex]) {
+        previousVertex = otherNeighbour(graph, currentVertex, F[currentVertex],
+         previousVertex);
+    }
+    do {
+        removeElement((*uncheckedVertices), currentVertex);
+        int nextVertex = otherNeighbour(graph, currentVertex, previousVertex,
+         F[currentVertex]);
+        if(circuitOrientation[nextVertex] == currentVertex) {
+            addArc(orientation2, currentVertex, nextVertex);
+            removeArc(orientation2, nextVertex, currentVertex);
+        }
+        else if(circuitOrientation[currentVertex] != nextVertex && 
+         circuitOrientation[nextVertex] != currentVertex) {
+            addArc(orientation1, currentVertex, nextVertex);
+            addArc(orientation2, currentVertex, nextVertex);
+        }
+        previousVertex = currentVertex;
+        currentVertex = nextVertex;
+    } while(currentVertex != startingVertex);
+}
+
+// Make the concrete orientations for double checking the heuristic algorithm.
+static void verifyOddnessHeuristicOrientations(struct cubicGraph *graph,
+ struct options *options, int circuitOrientation[], int F[], int M[],
+ int edgesBetweenCycles[], int numberOfEdgesBetweenCycles,
+ struct certificate *certificate) {
+
+    int numberOfVertices = graph->numberOfVertices;
+    size_t arenaUsed = options->arena->used;
+    struct diGraph orientation1 = allocateDiGraph(options->arena,
+     numberOfVertices);
+    emptyGraph(&orientation1);
+    struct diGraph orientation2 = allocateDiGraph(options->arena,
+     numberOfVertices);
+    emptyGraph(&orientation2);
+
+    // Add arc between u and v and add endpoints to bitset.
+    bitset endpoints = EMPTY;
+    for(int i = 0; i < numberOfEdgesBetweenCycles; i++) {
+        addArc(&orientation1, edgesBetweenCycles[2*i], 
+         edgesBetweenCycles[2*i+1]);
+        addArc(&orientation2, edgesBetweenCycles[2*i+1], 
+         edgesBetweenCycles[2*i]);
+        add(endpoints, edgesBetweenCycles[2*i]);
+        add(endpoints, edgesBetweenCycles[2*i+1]);
+    }
+
+    //  Add arcs from the circuitOrientation
+    for(int i = 0; i < numberOfVertices; i++) {
+
+        //  If i is one of the endpoints it does not belong to the circuits.
+        if(contains(endpoints, i)) {
+            continue;
+        }
+
+        //  Some part of the circuits might not yet be oriented. Do this now.
+        if(circuitOrientation[i] == -1) {
+            int takeMaximalMatching = true;
+            int currentVertex = i;
+            do {
+                // fprintf(stderr, "%d\n", currentVertex);
+                int nextVertex = takeMaximalMatching ? M[currentVertex] :
+                 F[currentVertex];
+                circuitOrientation[currentVertex] = nextVertex;
+                currentVertex = nextVertex;
+                takeMaximalMatching = !takeMaximalMatching;
+            } while (currentVertex != i);
+        }
+        addArc(&orientation1, circuitOrientation[i], i);
+        addArc(&orientation2, i, circuitOrientation[i]);
+    }
+
+    //  Orient 2-factor cycles
+    bitset uncheckedVertices = graph->vertexUniverse;
+
+    // Start orienting cycle at every endpoint of edge on cycle.
+    for(int i = 0; i < 2*numberOfEdgesBetweenCycles; i++) { 
+        if(contains(uncheckedVertices, edgesBetweenCycles[i])) {
+            orient2FactorCyclesInComplementaryOrientations(graph, F, 
+             circuitOrientation, edgesBetweenCycles[i], &uncheckedVertices,
+             &orientation1, &orientation2);
+        }
+    }
+    while(!isEmpty(uncheckedVertices)) {
+        orient2FactorCyclesInComplementaryOrientations(graph, F,
+         circuitOrientation, first(uncheckedVertices), &uncheckedVertices,
+         &orientation1, &orientation2);
+    }
+
+    //  Only report errors if the double check was asked for. Otherwise no
+    //  certificate is stored. (The heuristic can fail for graphs which are not
+    //  cyclically 4-edge-connected.)
+    bool reportErrors = options->doublecheckFlag || options->printFlag;
+    bool isCertificate = isStronglyConnected(&orientation1) &&
+     isStronglyConnected(&orientation2);
+    if(!isCertificate && reportErrors) {
+        fprintf(stderr, 
+         "Error: orientations from oddness 2 heuristic not strongly connected!\n");
+        exit(1);
+    }
+
+    if(isCertificate) {
+        edgeset deletableEdges1 = getDeletableEdges(graph, &orientation1);
+        edgeset deletableEdges2 = getDeletableEdges(graph, &orientation2);
+
+        if(options->printFlag) {
+            printDeletableEdges(graph, orientation1.adjacencyList,
+             deletableEdges1);
+            printDiGraph(&orientation1);
+            printDeletableEdges(graph, orientation2.adjacencyList,
+             deletableEdges2);
+            printDiGraph(&orientation2);
+        }
+
+        isCertificate = edgeSetsEqual(edgeUnion(deletableEdges1,
+         deletableEdges2), graph->edgeUniverse);
+        if(!isCertificate && reportErrors) {
+            fprintf(stderr, 
+             "Error: orientations from oddness 2 heuristic are not complementary!\n");
+            exit(1);
+        }
+    }
+
+    if(isCertificate && certificate != NULL) {
+        memcpy(certificate->orientation[0], orientation1.adjacencyList,
+         sizeof(bitset)*numberOfVertices);
+        memcpy(certificate->orientation[1], orientation2.adjacencyList,
+         sizeof(bitset)*numberOfVertices);
+        certificate->found = true;
+    }
+
+    options->arena->used = arenaUsed;
+}
+
+//******************************************************************************
+//
+//                              Library interface
+//
+//******************************************************************************
+
+struct fn_context {
+    int maxVertices;
+    struct options options;
+    struct fn_counters numberOf;
+    struct fn_timing timing;
+#ifdef SEARCH_PROFILE
+    struct fn_search_profile profile;
+#endif
+
+    //  Scratch memory reused for every graph.
+    Array bitsetsOfDeletableEdges;
+    struct arena arena;
+    struct cubicGraph graph;
+    struct certificate certificate;
+    bool (*orientation[2])[3];
+};
+
+//  The most scratch memory in use at once is either that of findFrankNumber()
+//  together with hasComplementaryOrientation(), which it calls for every strong
+//  orientation, or that of hasSufficientCondition() together with
+//  verifyOddnessHeuristicOrientations(). The sizes only grow with the number of
+//  vertices, so this suffices for every graph with at most maxVertices.
+static size_t getArenaSize(int maxVertices) {
+    size_t exact = getFindFrankNumberArenaSize(maxVertices) +
+     getComplementaryOrientationArenaSize(maxVertices);
+    size_t heuristic = getSufficientConditionArenaSize(maxVertices) +
+     getVerifyOddnessArenaSize(maxVertices);
+    return exact > heuristic ? exact : heuristic;
+}
+
+//  Sets of edges are stored in an edgeset, so the number of edges of a cubic
+//  graph (3*n/2) may not exceed MAXEDGES.
+int fn_max_vertices(void) {
+    return MAXVERTICES < 2*MAXEDGES/3 ? MAXVERTICES : 2*MAXEDGES/3;
+}
+
+int fn_max_heuristic_vertices(void) {
+    return MAXVERTICES;
+}
+
+struct fn_context *fn_context_new(int maxVertices) {
+    if(maxVertices < 1 || maxVertices > fn_max_heuristic_vertices()) {
+        return NULL;
+    }
+    //  The context contains edge sets, see initArray().
+    struct fn_context *context = aligned_alloc(_Alignof(struct fn_context),
+     sizeof(struct fn_context));
+    if(context == NULL) {
+        return NULL;
+    }
+    memset(context, 0, sizeof(struct fn_context));
+    context->maxVertices = maxVertices;
+    context->options = (struct options) {.exhaustiveCheckFlag = true,
+     .oddCyclesHeuristicFlag = true, .modulo = 1, .remainder = 0,
+     .sizeOfArray = 100000, .arena = &context->arena};
+    if(!initArena(&context->arena, getArenaSize(maxVertices))) {
+        fn_context_free(context);
+        return NULL;
+    }
+    for(int k = 0; k < 2; k++) {
+        context->orientation[k] = malloc(sizeof(bool[3])*maxVertices);
+        if(context->orientation[k] == NULL) {
+            fn_context_free(context);
+            return NULL;
+        }
+    }
+#ifdef SEARCH_PROFILE
+    context->options.profile = &context->profile;
+    for(int i = 0; i < FN_NUMBER_OF_SEARCHES; i++) {
+        context->profile.depth[i] = calloc(3*maxVertices/2 + 1,
+         sizeof(struct fn_search_depth));
+        if(context->profile.depth[i] == NULL) {
+            fn_context_free(context);
+            return NULL;
+        }
+    }
+#endif
+    return context;
+}
+
+void fn_context_free(struct fn_context *context) {
+    if(context == NULL) {
+        return;
+    }
+    freeArray(&context->bitsetsOfDeletableEdges);
+    freeArena(&context->arena);
+    free(context->orientation[0]);
+    free(context->orientation[1]);
+#ifdef SEARCH_PROFILE
+    for(int i = 0; i < FN_NUMBER_OF_SEARCHES; i++) {
+        free(context->profile.depth[i]);
+    }
+#endif
+    free(context);
+}
+
+void fn_context_set_part(struct fn_context *context, int remainder,
+ int modulo) {
+    context->options.singleGraphFlag = modulo > 1;
+    context->options.remainder = remainder;
+    context->options.modulo = modulo;
+}
+
+void fn_context_set_deadline(struct fn_context *context,
+ const struct timespec *deadline) {
+    context->options.hasDeadline = deadline != NULL;
+    if(deadline != NULL) {
+        context->options.deadline = *deadline;
+    }
+}
+
+void fn_context_set_cancel_flag(struct fn_context *context,
+ const atomic_int *flag) {
+    context->options.cancelFlag = flag;
+}
+
+void fn_context_set_phase_hook(struct fn_context *context,
+ fn_phase_hook *hook, void *data) {
+    context->options.phaseHook = hook;
+    context->options.phaseHookData = data;
+}
+
+const struct fn_counters *fn_context_counters(struct fn_context *context) {
+    return &context->numberOf;
+}
+
+const struct fn_timing *fn_context_timing(struct fn_context *context) {
+    return &context->timing;
+}
+
+const struct fn_search_profile *fn_context_search_profile(
+ struct fn_context *context) {
+#ifdef SEARCH_PROFILE
+    return &context->profile;
+#else
+    (void) context;
+    return NULL;
+#endif
+}
+
+void fn_context_reset_counters(struct fn_context *context) {
+    context->numberOf = (struct fn_counters) {0};
+}
+
+//  Store the adjacency lists as bitsets. Returns false if the graph is not a
+//  simple cubic graph.
+static bool loadAdjacencyList(const int adjacency[][3], int numberOfVertices,
+ bitset adjacencyList[]) {
+    for(int v = 0; v < numberOfVertices; v++) {
+        adjacencyList[v] = EMPTY;
+        for(int i = 0; i < 3; i++) {
+            int w = adjacency[v][i];
+            if(w < 0 || w >= numberOfVertices || w == v ||
+             contains(adjacencyList[v], w)) {
+                return false;
+            }
+            add(adjacencyList[v], w);
+        }
+    }
+    for(int v = 0; v < numberOfVertices; v++) {
+        forEach(w, adjacencyList[v]) {
+            if(!contains(adjacencyList[w], v)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void setOptions(struct options *options, int flags) {
+    options->oddCyclesHeuristicFlag = !(flags & FN_ONLY_EXACT);
+    options->exhaustiveCheckFlag = !(flags & FN_ONLY_HEURISTIC);
+    options->bruteForceFlag = flags & FN_BRUTE_FORCE;
+    options->doublecheckFlag = flags & FN_DOUBLE_CHECK;
+    options->printFlag = flags & FN_PRINT_ORIENTATIONS;
+    options->grayCodeFlag = flags & FN_GRAY_CODE;
+    options->verboseFlag = flags & (FN_VERBOSE | FN_PRINT_ORIENTATIONS);
+}
+
+//  Run the heuristic and/or exact algorithm. Returns 2 if the graph is
+//  determined to have Frank number 2 and 0 otherwise.
+static int computeFrankNumber(struct fn_context *context,
+ struct certificate *certificate) {
+    struct cubicGraph *graph = &context->graph;
+    struct options *options = &context->options;
+    struct fn_counters *numberOf = &context->numberOf;
+    int frankNumber = 0;
+    if(options->oddCyclesHeuristicFlag) {
+        int F[graph->numberOfVertices];
+        struct phaseStart start;
+        startPhase(options, &start, FN_PHASE_SUFFICIENT_CONDITION);
+        bool satisfiesCondition = hasSufficientCondition(graph, options,
+         numberOf, graph->vertexUniverse, F, certificate);
+        endPhase(options, &start, FN_PHASE_SUFFICIENT_CONDITION);
+
+        //  An interrupted heuristic has not failed, so it is not counted.
+        //  fn_check() reports the abort.
+        if(options->aborted) {
+            return 0;
+        }
+        if(satisfiesCondition) {
+            numberOf->graphsSatisfyingOddnessCondition++;
+            frankNumber = 2;
+        }
+        else {
+            if(options->verboseFlag) {
+                fprintf(stderr, 
+                 "\tHeuristic failed. %soing exhaustive check.\n",
+                 options->exhaustiveCheckFlag ? "D" : "Not d");
+            }
+            numberOf->graphsNotSatisfyingOddnessCondition++;
+        }
+    }
+    if(options->exhaustiveCheckFlag && frankNumber == 0) {
+        frankNumber = findFrankNumber(graph, options, numberOf,
+         &context->bitsetsOfDeletableEdges, certificate);
+        if(options->verboseFlag) {
+            fprintf(stderr,
+             "\tStrongly connected orientations generated: %llu\n",
+             numberOf->generatedOrientations);
+            if(options->bruteForceFlag) {
+                fprintf(stderr, "\tOrientations giving subsets: %llu\n",
+                 numberOf->orientationsGivingSubset);
+                fprintf(stderr, "\tOrientations giving supersets: %llu\n",
+                 numberOf->orientationsGivingSuperset);
+                fprintf(stderr, "\tNumberOfComplementaryBitsets: %llu\n",
+                 numberOf->complementaryBitsets);
+            }
+        }
+    }
+    return frankNumber;
+}
+
+int fn_check(struct fn_context *context, const int adjacency[][3],
+ int numberOfVertices, int flags, struct fn_result *result) {
+    if(numberOfVertices > context->maxVertices ||
+     (numberOfVertices > fn_max_vertices() &&
+     (flags & (FN_ONLY_HEURISTIC | FN_DOUBLE_CHECK)) != FN_ONLY_HEURISTIC)) {
+        return FN_ERROR_TOO_LARGE;
+    }
+    setOptions(&context->options, flags);
+    context->timing = (struct fn_timing) {0};
+    context->options.timing = flags & FN_TIMING ? &context->timing : NULL;
+    struct phaseStart start;
+    startPhase(&context->options, &start, FN_PHASE_VALIDATION);
+    bool isValid = numberOfVertices >= 1 && loadAdjacencyList(adjacency,
+     numberOfVertices, context->graph.adjacencyList);
+    if(isValid) {
+        initCubicGraph(&context->graph, numberOfVertices);
+    }
+    endPhase(&context->options, &start, FN_PHASE_VALIDATION);
+    if(!isValid) {
+        return FN_ERROR_INVALID_GRAPH;
+    }
+    context->options.aborted = false;
+    context->options.cancelled = false;
+    context->options.nodesSinceClockCheck = CLOCK_CHECK_INTERVAL - 1;
+    context->arena.used = 0;
+#ifdef SEARCH_PROFILE
+    context->profile.numberOfDepths = 3*numberOfVertices/2 + 1;
+    for(int i = 0; i < FN_NUMBER_OF_SEARCHES; i++) {
+        memset(context->profile.depth[i], 0,
+         sizeof(struct fn_search_depth)*context->profile.numberOfDepths);
+    }
+#endif
+    struct fn_counters *numberOf = &context->numberOf;
+    numberOf->generatedOrientations = 0;
+    numberOf->orientationsGivingSubset = 0;
+    numberOf->complementaryBitsets = 0;
+    numberOf->emptyBitsetsStored = 0;
+
+    struct certificate *certificate = NULL;
+    if(flags & FN_CERTIFICATE) {
+        certificate = &context->certificate;
+        certificate->found = false;
+    }
+    result->frankNumber = computeFrankNumber(context, certificate);
+    if(context->options.aborted) {
+        result->frankNumber = 0;
+    }
+    result->hasCertificate = !context->options.aborted &&
+     certificate != NULL && certificate->found;
+    for(int k = 0; k < 2; k++) {
+        result->orientation[k] = NULL;
+        if(!result->hasCertificate) {
+            continue;
+        }
+        for(int v = 0; v < numberOfVertices; v++) {
+            for(int i = 0; i < 3; i++) {
+                context->orientation[k][v][i] =
+                 contains(certificate->orientation[k][v], adjacency[v][i]);
+            }
+        }
+        result->orientation[k] = context->orientation[k];
+    }
+
+    if(numberOf->mostGeneratedOrientations < numberOf->generatedOrientations) {
+        numberOf->mostGeneratedOrientations = numberOf->generatedOrientations;
+    }
+    if(numberOf->mostStoredBitsets < numberOf->storedBitsets) {
+        numberOf->mostStoredBitsets = numberOf->storedBitsets;
+    }
+    if(context->options.cancelled) {
+        return FN_CANCELLED;
+    }
+    return context->options.aborted ? FN_ABORTED : FN_OK;
+}
+
+void fn_print_orientation(const int adjacency[][3], int numberOfVertices,
+ bool orientation[][3]) {
+    struct cubicGraph graph;
+    bitset arcs[numberOfVertices];
+    bitset reverseArcs[numberOfVertices];
+    struct diGraph diGraph = {.numberOfVertices = numberOfVertices,
+     .adjacencyList = arcs, .reverseAdjacencyList = reverseArcs};
+    emptyGraph(&diGraph);
+    for(int v = 0; v < numberOfVertices; v++) {
+        graph.adjacencyList[v] = EMPTY;
+        for(int i = 0; i < 3; i++) {
+            add(graph.adjacencyList[v], adjacency[v][i]);
+            if(orientation[v][i]) {
+                addArc(&diGraph, v, adjacency[v][i]);
+            }
+        }
+    }
+    initCubicGraph(&graph, numberOfVertices);
+    edgeset deletableEdges = getDeletableEdges(&graph, &diGraph);
+    printDeletableEdges(&graph, diGraph.adjacencyList, deletableEdges);
+    printDiGraph(&diGraph);
+}
@@ -0,0 +1,209 @@
+#ifndef FRANK_NUMBER
+#define FRANK_NUMBER
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+
+//  Reentrant interface to the heuristic and exact algorithms. All state lives
+//  in a context; different threads can check graphs at the same time as long
+//  as every thread uses its own context. The interface does not depend on the
+//  bitset width the library was compiled with, but the largest graph which can
+//  be checked does, see fn_max_vertices().
+
+//  Flags for fn_check(). By default the heuristic algorithm is tried first and
+//  the exact algorithm is used if it fails.
+enum fn_flags {
+    FN_ONLY_HEURISTIC = 1 << 0,     //  Do not use the exact algorithm.
+    FN_ONLY_EXACT = 1 << 1,         //  Do not use the heuristic algorithm.
+    FN_BRUTE_FORCE = 1 << 2,        //  Compare all strong orientations.
+    FN_DOUBLE_CHECK = 1 << 3,       //  Verify results of the heuristic.
+    FN_CERTIFICATE = 1 << 4,        //  Return the two orientations.
+    FN_VERBOSE = 1 << 5,            //  Report details on stderr.
+    FN_PRINT_ORIENTATIONS = 1 << 6, //  Print the orientations on stderr.
+    FN_TIMING = 1 << 7,             //  Time the phases, see fn_timing.
+    FN_GRAY_CODE = 1 << 8           //  Orient edges in Gray code order.
+};
+
+//  Return values of fn_check().
+enum fn_status {
+    FN_OK = 0,
+    FN_ERROR_TOO_LARGE = -1,        //  More vertices than allowed.
+    FN_ERROR_INVALID_GRAPH = -2,    //  Not a simple cubic graph.
+    FN_ABORTED = -3,                //  The deadline passed, no result.
+    FN_CANCELLED = -4               //  The cancel flag was raised, no result.
+};
+
+//  Statistics accumulated over all graphs checked with a context. The first
+//  five counters only concern the last graph.
+struct fn_counters {
+    long long unsigned int generatedOrientations;
+    long long unsigned int storedBitsets;
+    long long unsigned int orientationsGivingSubset;
+    long long unsigned int complementaryBitsets;
+    long long unsigned int emptyBitsetsStored;
+    long long unsigned int orientationsGivingSuperset;
+    long long unsigned int mostGeneratedOrientations;
+    long long unsigned int mostStoredBitsets;
+    long long unsigned int graphsSatisfyingOddnessCondition;
+    long long unsigned int graphsNotSatisfyingOddnessCondition;
+    long long unsigned int graphsSatisfyingFirstOddness;
+    long long unsigned int graphsSatisfyingSecondOddness;
+    long long unsigned int totalOrientationsGenerated;
+};
+
+//  Phases of fn_check() which are timed with FN_TIMING. The deletable edges
+//  and complementary orientation phases concern the orientations generated by
+//  the exact algorithm and are part of the orientations phase.
+enum fn_phase {
+    FN_PHASE_VALIDATION,            //  Loading and checking the input.
+    FN_PHASE_SUFFICIENT_CONDITION,  //  The heuristic algorithm.
+    FN_PHASE_ORIENTATIONS,          //  The exact algorithm.
+    FN_PHASE_DELETABLE_EDGES,
+    FN_PHASE_COMPLEMENTARY_ORIENTATION,
+    FN_NUMBER_OF_PHASES
+};
+
+//  Time spent in every phase during the last call of fn_check() with
+//  FN_TIMING, measured with CLOCK_MONOTONIC and CLOCK_THREAD_CPUTIME_ID, and
+//  how often the phase was entered.
+struct fn_timing {
+    double wallSeconds[FN_NUMBER_OF_PHASES];
+    double cpuSeconds[FN_NUMBER_OF_PHASES];
+    long long unsigned int calls[FN_NUMBER_OF_PHASES];
+};
+
+//  The two search trees of the exact algorithm: the strong orientations of the
+//  graph and, for every such orientation, the search for a complementary one.
+enum fn_search {
+    FN_SEARCH_ORIENTATIONS,
+    FN_SEARCH_COMPLEMENTARY_ORIENTATION,
+    FN_NUMBER_OF_SEARCHES
+};
+
+//  Reasons for cutting off a branch of a search tree.
+enum fn_prune_reason {
+    FN_PRUNED_OUT_DEGREE,           //  A vertex would get out-degree 3.
+    FN_PRUNED_IN_DEGREE,            //  A vertex would get in-degree 3.
+    FN_PRUNED_NO_DELETABLE_EDGE,    //  A vertex has no deletable edge.
+    FN_PRUNED_NOT_STRONGLY_CONNECTED,
+    FN_PRUNED_CONTRADICTION,        //  The forced arcs contradict each other.
+    FN_PRUNED_NOT_COMPLEMENTARY,    //  Some edge is deletable in neither.
+    FN_NUMBER_OF_PRUNE_REASONS
+};
+
+//  Counts for the nodes of a search tree in which the edge with the given
+//  index is oriented. The leaves, where all edges are oriented, have depth
+//  equal to the number of edges.
+struct fn_search_depth {
+    long long unsigned int nodes;
+    long long unsigned int pruned[FN_NUMBER_OF_PRUNE_REASONS];
+    long long unsigned int backtracks;
+};
+
+//  Search tree profile of the last call of fn_check(). depth[search] has
+//  numberOfDepths elements, one more than the number of edges of the graph.
+struct fn_search_profile {
+    int numberOfDepths;
+    struct fn_search_depth *depth[FN_NUMBER_OF_SEARCHES];
+};
+
+struct fn_result {
+
+    //  2 if the graph has Frank number 2, 0 if it does not or if the
+    //  heuristic failed with FN_ONLY_HEURISTIC.
+    int frankNumber;
+
+    //  Only set with FN_CERTIFICATE. orientation[k][v][i] is true if the edge
+    //  between v and adjacency[v][i] is oriented away from v in the k-th
+    //  orientation. The arrays belong to the context and are overwritten by
+    //  the next call of fn_check().
+    bool hasCertificate;
+    bool (*orientation[2])[3];
+};
+
+struct fn_context;
+
+//  Largest number of vertices supported by this build of the library.
+int fn_max_vertices(void);
+
+//  Largest number of vertices of a graph which can be checked with
+//  FN_ONLY_HEURISTIC and without FN_DOUBLE_CHECK. The heuristic algorithm
+//  does not store sets of edges, so this can exceed fn_max_vertices().
+int fn_max_heuristic_vertices(void);
+
+//  Create a context for graphs with at most maxVertices vertices, which may be
+//  up to fn_max_heuristic_vertices(). Returns NULL if maxVertices is not
+//  supported or if memory runs out.
+struct fn_context *fn_context_new(int maxVertices);
+
+void fn_context_free(struct fn_context *context);
+
+//  Only generate the leaves of the search tree of the exact algorithm whose
+//  number is remainder modulo modulo, such that one graph can be split over
+//  several runs. Use modulo 1 to undo.
+void fn_context_set_part(struct fn_context *context, int remainder,
+ int modulo);
+
+//  Stop checking a graph when the CLOCK_MONOTONIC time deadline passes, in
+//  which case fn_check() returns FN_ABORTED. Use NULL to remove the deadline.
+void fn_context_set_deadline(struct fn_context *context,
+ const struct timespec *deadline);
+
+//  Stop checking a graph as soon as *flag becomes non-zero, in which case
+//  fn_check() returns FN_CANCELLED. The flag is polled as often as the
+//  deadline, so it may live in memory shared with other processes. Use NULL
+//  to remove it.
+void fn_context_set_cancel_flag(struct fn_context *context,
+ const atomic_int *flag);
+
+//  Called by fn_check() in the calling thread at the start (end is false) and
+//  at the end (end is true) of every phase listed in enum fn_phase, e.g. to
+//  read hardware performance counters. This does not depend on FN_TIMING. Use
+//  NULL to remove the hook.
+typedef void fn_phase_hook(void *data, enum fn_phase phase, bool end);
+
+void fn_context_set_phase_hook(struct fn_context *context,
+ fn_phase_hook *hook, void *data);
+
+const struct fn_counters *fn_context_counters(struct fn_context *context);
+
+//  Timings of the last call of fn_check(). All zero without FN_TIMING.
+const struct fn_timing *fn_context_timing(struct fn_context *context);
+
+//  Profile of the search trees of the last call of fn_check(). Profiling costs
+//  time in every node, so it is only compiled in if the library is built with
+//  -DSEARCH_PROFILE. Returns NULL otherwise.
+const struct fn_search_profile *fn_context_search_profile(
+ struct fn_context *context);
+
+//  Set all counters of the context to zero, e.g. to obtain the counters of a
+//  part of the input.
+void fn_context_reset_counters(struct fn_context *context);
+
+//  Check whether the cubic graph with adjacency lists adjacency has Frank
+//  number 2. Returns FN_OK or an error from enum fn_status, in particular
+//  FN_ERROR_TOO_LARGE for a graph with more than fn_max_vertices() vertices
+//  unless only the heuristic algorithm is used without FN_DOUBLE_CHECK.
+int fn_check(struct fn_context *context, const int adjacency[][3],
+ int numberOfVertices, int flags, struct fn_result *result);
+
+//  A filter with the same semantics as findFrankNumber, meant to be called from
+//  the output hook of a graph generator. A graph is accepted if it does not
+//  have Frank number 2 according to the algorithms selected by flags, or if it
+//  does when complement is true (option -c). Invalid graphs are rejected.
+struct fn_filter;
+
+struct fn_filter *fn_filter_new(int maxVertices, int flags, bool complement);
+
+void fn_filter_free(struct fn_filter *filter);
+
+bool fn_filter_accept(struct fn_filter *filter, const int adjacency[][3],
+ int numberOfVertices);
+
+//  Print the deletable edges and the arcs of an orientation in the format used
+//  by FN_PRINT_ORIENTATIONS. The orientation should be strongly connected.
+void fn_print_orientation(const int adjacency[][3], int numberOfVertices,
+ bool orientation[][3]);
+
+#endif
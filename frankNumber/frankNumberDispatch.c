@@ -0,0 +1,256 @@
+/**
+ * frankNumberDispatch.c
+ *
+ *  The interface of frankNumber.h on top of several builds of frankNumber.c,
+ *  each using another bitset width, see frankNumberWidth.h. Every graph is
+ *  checked by the narrowest width which fits its 3n/2 edges, such that small
+ *  graphs are checked at the speed of the 64-bit version while larger graphs
+ *  are still supported.
+ */
+
+#include <stdlib.h>
+#include "frankNumber.h"
+
+struct fn_width_context;
+
+//  Declare the interface of frankNumber.h with the given prefix.
+#define DECLARE_WIDTH(prefix) \
+int prefix##max_vertices(void); \
+struct fn_width_context *prefix##context_new(int maxVertices); \
+void prefix##context_free(struct fn_width_context *context); \
+void prefix##context_set_part(struct fn_width_context *context, \
+ int remainder, int modulo); \
+void prefix##context_set_deadline(struct fn_width_context *context, \
+ const struct timespec *deadline); \
+void prefix##context_set_cancel_flag(struct fn_width_context *context, \
+ const atomic_int *flag); \
+void prefix##context_set_phase_hook(struct fn_width_context *context, \
+ fn_phase_hook *hook, void *data); \
+const struct fn_counters *prefix##context_counters( \
+ struct fn_width_context *context); \
+const struct fn_timing *prefix##context_timing( \
+ struct fn_width_context *context); \
+const struct fn_search_profile *prefix##context_search_profile( \
+ struct fn_width_context *context); \
+void prefix##context_reset_counters(struct fn_width_context *context); \
+int prefix##check(struct fn_width_context *context, \
+ const int adjacency[][3], int numberOfVertices, int flags, \
+ struct fn_result *result); \
+void prefix##print_orientation(const int adjacency[][3], \
+ int numberOfVertices, bool orientation[][3]);
+
+DECLARE_WIDTH(fn64_)
+DECLARE_WIDTH(fn128_)
+
+//  The interface of one width.
+struct width {
+    int (*maxVertices)(void);
+    struct fn_width_context *(*contextNew)(int maxVertices);
+    void (*contextFree)(struct fn_width_context *context);
+    void (*setPart)(struct fn_width_context *context, int remainder,
+     int modulo);
+    void (*setDeadline)(struct fn_width_context *context,
+     const struct timespec *deadline);
+    void (*setCancelFlag)(struct fn_width_context *context,
+     const atomic_int *flag);
+    void (*setPhaseHook)(struct fn_width_context *context,
+     fn_phase_hook *hook, void *data);
+    const struct fn_counters *(*counters)(struct fn_width_context *context);
+    const struct fn_timing *(*timing)(struct fn_width_context *context);
+    const struct fn_search_profile *(*searchProfile)(
+     struct fn_width_context *context);
+    void (*resetCounters)(struct fn_width_context *context);
+    int (*check)(struct fn_width_context *context, const int adjacency[][3],
+     int numberOfVertices, int flags, struct fn_result *result);
+    void (*printOrientation)(const int adjacency[][3], int numberOfVertices,
+     bool orientation[][3]);
+};
+
+#define WIDTH(prefix) {prefix##max_vertices, prefix##context_new, \
+ prefix##context_free, prefix##context_set_part, \
+ prefix##context_set_deadline, prefix##context_set_cancel_flag, \
+ prefix##context_set_phase_hook, prefix##context_counters, \
+ prefix##context_timing, prefix##context_search_profile, \
+ prefix##context_reset_counters, prefix##check, prefix##print_orientation}
+
+//  From narrow to wide.
+static const struct width widths[] = {WIDTH(fn64_), WIDTH(fn128_)};
+
+#define NUMBER_OF_WIDTHS (int) (sizeof(widths)/sizeof(widths[0]))
+
+//  A context for every width up to the one needed for maxVertices. The
+//  settings are passed on to all of them.
+struct fn_context {
+    int maxVertices;
+    struct fn_width_context *contexts[NUMBER_OF_WIDTHS];
+
+    //  The width which checked the last graph, whose counters, timing and
+    //  search profile concern that graph.
+    int last;
+
+    //  The counters of all widths together, see updateCounters(). They are
+    //  kept up to date like those of a single width, so a pointer returned by
+    //  fn_context_counters() stays valid across fn_check().
+    struct fn_counters numberOf;
+};
+
+int fn_max_vertices(void) {
+    return widths[NUMBER_OF_WIDTHS - 1].maxVertices();
+}
+
+//  The widest width checks every graph it supports with both algorithms, so
+//  the heuristic algorithm does not allow larger graphs.
+int fn_max_heuristic_vertices(void) {
+    return fn_max_vertices();
+}
+
+struct fn_context *fn_context_new(int maxVertices) {
+    if(maxVertices < 1 || maxVertices > fn_max_vertices()) {
+        return NULL;
+    }
+    struct fn_context *context = calloc(1, sizeof(struct fn_context));
+    if(context == NULL) {
+        return NULL;
+    }
+    context->maxVertices = maxVertices;
+    for(int w = 0; w < NUMBER_OF_WIDTHS; w++) {
+        int widthMaxVertices = widths[w].maxVertices();
+        context->contexts[w] = widths[w].contextNew(
+         maxVertices < widthMaxVertices ? maxVertices : widthMaxVertices);
+        if(context->contexts[w] == NULL) {
+            fn_context_free(context);
+            return NULL;
+        }
+        if(maxVertices <= widthMaxVertices) {
+            break;
+        }
+    }
+    return context;
+}
+
+void fn_context_free(struct fn_context *context) {
+    if(context == NULL) {
+        return;
+    }
+    for(int w = 0; w < NUMBER_OF_WIDTHS; w++) {
+        if(context->contexts[w] != NULL) {
+            widths[w].contextFree(context->contexts[w]);
+        }
+    }
+    free(context);
+}
+
+//  Loop over the widths for which the context has a context.
+#define forEachWidth(w, context) \
+ for(int w = 0; w < NUMBER_OF_WIDTHS && (context)->contexts[w] != NULL; w++)
+
+void fn_context_set_part(struct fn_context *context, int remainder,
+ int modulo) {
+    forEachWidth(w, context) {
+        widths[w].setPart(context->contexts[w], remainder, modulo);
+    }
+}
+
+void fn_context_set_deadline(struct fn_context *context,
+ const struct timespec *deadline) {
+    forEachWidth(w, context) {
+        widths[w].setDeadline(context->contexts[w], deadline);
+    }
+}
+
+void fn_context_set_cancel_flag(struct fn_context *context,
+ const atomic_int *flag) {
+    forEachWidth(w, context) {
+        widths[w].setCancelFlag(context->contexts[w], flag);
+    }
+}
+
+void fn_context_set_phase_hook(struct fn_context *context,
+ fn_phase_hook *hook, void *data) {
+    forEachWidth(w, context) {
+        widths[w].setPhaseHook(context->contexts[w], hook, data);
+    }
+}
+
+//  The counters concerning the last graph are taken from the width which
+//  checked it, the maxima are the largest of all widths and the other counters
+//  are added.
+static void updateCounters(struct fn_context *context) {
+    struct fn_counters *numberOf = &context->numberOf;
+    *numberOf = *widths[context->last].counters(
+     context->contexts[context->last]);
+    forEachWidth(w, context) {
+        if(w == context->last) {
+            continue;
+        }
+        const struct fn_counters *other =
+         widths[w].counters(context->contexts[w]);
+        numberOf->orientationsGivingSuperset +=
+         other->orientationsGivingSuperset;
+        if(numberOf->mostGeneratedOrientations <
+         other->mostGeneratedOrientations) {
+            numberOf->mostGeneratedOrientations =
+             other->mostGeneratedOrientations;
+        }
+        if(numberOf->mostStoredBitsets < other->mostStoredBitsets) {
+            numberOf->mostStoredBitsets = other->mostStoredBitsets;
+        }
+        numberOf->graphsSatisfyingOddnessCondition +=
+         other->graphsSatisfyingOddnessCondition;
+        numberOf->graphsNotSatisfyingOddnessCondition +=
+         other->graphsNotSatisfyingOddnessCondition;
+        numberOf->graphsSatisfyingFirstOddness +=
+         other->graphsSatisfyingFirstOddness;
+        numberOf->graphsSatisfyingSecondOddness +=
+         other->graphsSatisfyingSecondOddness;
+        numberOf->totalOrientationsGenerated +=
+         other->totalOrientationsGenerated;
+    }
+}
+
+const struct fn_counters *fn_context_counters(struct fn_context *context) {
+    return &context->numberOf;
+}
+
+const struct fn_timing *fn_context_timing(struct fn_context *context) {
+    return widths[context->last].timing(context->contexts[context->last]);
+}
+
+const struct fn_search_profile *fn_context_search_profile(
+ struct fn_context *context) {
+    return widths[context->last].searchProfile(
+     context->contexts[context->last]);
+}
+
+void fn_context_reset_counters(struct fn_context *context) {
+    forEachWidth(w, context) {
+        widths[w].resetCounters(context->contexts[w]);
+    }
+    updateCounters(context);
+}
+
+int fn_check(struct fn_context *context, const int adjacency[][3],
+ int numberOfVertices, int flags, struct fn_result *result) {
+    if(numberOfVertices > context->maxVertices) {
+        return FN_ERROR_TOO_LARGE;
+    }
+    int w = 0;
+    while(numberOfVertices > widths[w].maxVertices()) {
+        w++;
+    }
+    context->last = w;
+    int status = widths[w].check(context->contexts[w], adjacency,
+     numberOfVertices, flags, result);
+    updateCounters(context);
+    return status;
+}
+
+void fn_print_orientation(const int adjacency[][3], int numberOfVertices,
+ bool orientation[][3]) {
+    int w = 0;
+    while(w < NUMBER_OF_WIDTHS - 1 &&
+     numberOfVertices > widths[w].maxVertices()) {
+        w++;
+    }
+    widths[w].printOrientation(adjacency, numberOfVertices, orientation);
+}
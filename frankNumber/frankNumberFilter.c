@@ -0,0 +1,47 @@
+/**
+ * frankNumberFilter.c
+ *
+ *  The in-process filter of frankNumber.h. It only uses the public interface,
+ *  so it is shared by all builds of the library.
+ */
+
+#include <stdlib.h>
+#include "frankNumber.h"
+
+struct fn_filter {
+    struct fn_context *context;
+    int flags;
+    bool complement;
+};
+
+struct fn_filter *fn_filter_new(int maxVertices, int flags, bool complement) {
+    struct fn_filter *filter = malloc(sizeof(struct fn_filter));
+    if(filter == NULL) {
+        return NULL;
+    }
+    *filter = (struct fn_filter) {.context = fn_context_new(maxVertices),
+     .flags = flags & ~FN_CERTIFICATE, .complement = complement};
+    if(filter->context == NULL) {
+        free(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+void fn_filter_free(struct fn_filter *filter) {
+    if(filter == NULL) {
+        return;
+    }
+    fn_context_free(filter->context);
+    free(filter);
+}
+
+bool fn_filter_accept(struct fn_filter *filter, const int adjacency[][3],
+ int numberOfVertices) {
+    struct fn_result result;
+    if(fn_check(filter->context, adjacency, numberOfVertices, filter->flags,
+     &result) != FN_OK) {
+        return false;
+    }
+    return (result.frankNumber == 2) == filter->complement;
+}
@@ -0,0 +1,32 @@
+#ifndef FRANK_NUMBER_WIDTH
+#define FRANK_NUMBER_WIDTH
+
+//  Included by frankNumber.c when it is compiled with -DFN_WIDTH_PREFIX=..., in
+//  which case the interface of frankNumber.h gets that prefix instead of fn_,
+//  e.g. fn64_check() instead of fn_check(). This way the library can be
+//  compiled once for every bitset width and linked into a single binary, with
+//  frankNumberDispatch.c implementing the interface on top of them.
+
+#define FN_PASTE(prefix, name) prefix ## name
+#define FN_EXPAND(prefix, name) FN_PASTE(prefix, name)
+#define FN_WIDTH_NAME(name) FN_EXPAND(FN_WIDTH_PREFIX, name)
+
+//  The context is opaque to the dispatcher, so all widths can use the same tag.
+#define fn_context fn_width_context
+
+#define fn_max_vertices FN_WIDTH_NAME(max_vertices)
+#define fn_max_heuristic_vertices FN_WIDTH_NAME(max_heuristic_vertices)
+#define fn_context_new FN_WIDTH_NAME(context_new)
+#define fn_context_free FN_WIDTH_NAME(context_free)
+#define fn_context_set_part FN_WIDTH_NAME(context_set_part)
+#define fn_context_set_deadline FN_WIDTH_NAME(context_set_deadline)
+#define fn_context_set_cancel_flag FN_WIDTH_NAME(context_set_cancel_flag)
+#define fn_context_set_phase_hook FN_WIDTH_NAME(context_set_phase_hook)
+#define fn_context_counters FN_WIDTH_NAME(context_counters)
+#define fn_context_timing FN_WIDTH_NAME(context_timing)
+#define fn_context_search_profile FN_WIDTH_NAME(context_search_profile)
+#define fn_context_reset_counters FN_WIDTH_NAME(context_reset_counters)
+#define fn_check FN_WIDTH_NAME(check)
+#define fn_print_orientation FN_WIDTH_NAME(print_orientation)
+
+#endif
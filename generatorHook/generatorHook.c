@@ -0,0 +1,174 @@
+/**
+ * generatorHook.c
+ *
+ * Example of filtering graphs in-process from the output hook of a cubic graph
+ * generator instead of piping graph6 strings to findFrankNumber. The graphs of
+ * a graph6 file are first decoded into neighbour lists, as a generator would
+ * have them in memory, and are then passed one by one to outputHook(), which
+ * writes the accepted graphs to stdout.
+ *
+ */
+
+#define USAGE \
+"\nUsage: `./generatorHook [-2|-e] [-c] FILE`\n"
+#define HELPTEXT \
+"Filter the cubic graphs in the graph6 file FILE in the same way as\n\
+findFrankNumber, using the in-process filter of libfranknumber.\n\
+\n\
+  -2, --only-heuristic          Only perform the heuristic algorithm\n\
+  -c, --complement              Output the graphs having Frank number 2\n\
+  -e, --only-exact              Only perform the exact algorithm\n\
+  -h, --help                    Print this help text\n\
+"
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+#include "../readGraph/readGraph6.h"
+#include "../frankNumber/frankNumber.h"
+#include "../bitset.h"
+
+//  A graph as a generator would store it.
+struct generatedGraph {
+    char *graphString;
+    int numberOfVertices;
+    int (*adjacency)[3];
+};
+
+//  The part which would be added to the output routine of a generator.
+//  Returns whether the graph was written.
+bool outputHook(struct fn_filter *filter, struct generatedGraph *graph) {
+    if(!fn_filter_accept(filter, (const int (*)[3]) graph->adjacency,
+     graph->numberOfVertices)) {
+        return false;
+    }
+    printf("%s", graph->graphString);
+    return true;
+}
+
+//  Read all graphs of the file. Graphs which are not cubic or have more than
+//  maxVertices vertices are skipped.
+struct generatedGraph *readGraphs(FILE *file, int maxVertices,
+ int *numberOfGraphs) {
+    struct generatedGraph *graphs = NULL;
+    int capacity = 0;
+    *numberOfGraphs = 0;
+    char *graphString = NULL;
+    size_t size;
+    while(getline(&graphString, &size, file) != -1) {
+        int numberOfVertices = getNumberOfVertices(graphString);
+        bitset adjacencyList[MAXVERTICES];
+        if(numberOfVertices < 1 || numberOfVertices > maxVertices ||
+         loadGraph(graphString, numberOfVertices, adjacencyList) == -1) {
+            continue;
+        }
+        int (*adjacency)[3] = malloc(sizeof(int[3])*numberOfVertices);
+        bool isCubic = adjacency != NULL;
+        for(int v = 0; isCubic && v < numberOfVertices; v++) {
+            isCubic = size(adjacencyList[v]) == 3;
+            int i = 0;
+            forEach(w, adjacencyList[v]) {
+                if(i < 3) {
+                    adjacency[v][i++] = w;
+                }
+            }
+        }
+        if(!isCubic) {
+            free(adjacency);
+            continue;
+        }
+        if(*numberOfGraphs == capacity) {
+            capacity = capacity == 0 ? 1024 : 2*capacity;
+            graphs = realloc(graphs, sizeof(struct generatedGraph)*capacity);
+            if(graphs == NULL) {
+                fprintf(stderr, "Error: out of memory\n");
+                exit(1);
+            }
+        }
+        graphs[(*numberOfGraphs)++] = (struct generatedGraph)
+         {.graphString = graphString, .numberOfVertices = numberOfVertices,
+         .adjacency = adjacency};
+        graphString = NULL;
+    }
+    free(graphString);
+    return graphs;
+}
+
+int main(int argc, char **argv) {
+    int flags = 0;
+    bool complementFlag = false;
+    int opt;
+    while (1) {
+        int option_index = 0;
+        static struct option long_options[] = 
+        {   
+            {"only-heuristic", no_argument, NULL, '2'},
+            {"complement", no_argument, NULL, 'c'},
+            {"only-exact", no_argument, NULL, 'e'},
+            {"help", no_argument, NULL, 'h'},
+            {NULL, 0, NULL, 0}
+        };
+
+        opt = getopt_long(argc, argv, "2ceh", long_options, &option_index);
+        if (opt == -1) break;
+        switch(opt) {
+            case '2':
+                flags |= FN_ONLY_HEURISTIC;
+                break;
+            case 'c':
+                complementFlag = true;
+                break;
+            case 'e':
+                flags |= FN_ONLY_EXACT;
+                break;
+            case 'h':
+                fprintf(stderr, "%s\n", USAGE);
+                fprintf(stderr, "%s", HELPTEXT);
+                return 0;
+            case '?':
+                fprintf(stderr, "%s\n", USAGE);
+                return 1;
+        }
+    }
+    if(optind != argc - 1) {
+        fprintf(stderr, "Error: give exactly one graph file.\n");
+        fprintf(stderr, "%s\n", USAGE);
+        return 1;
+    }
+    FILE *file = fopen(argv[optind], "r");
+    if(file == NULL) {
+        fprintf(stderr, "Error: could not open %s.\n", argv[optind]);
+        return 1;
+    }
+    int maxVertices = flags & FN_ONLY_HEURISTIC ? fn_max_heuristic_vertices() :
+     fn_max_vertices();
+    int numberOfGraphs;
+    struct generatedGraph *graphs = readGraphs(file, maxVertices,
+     &numberOfGraphs);
+    fclose(file);
+
+    struct fn_filter *filter = fn_filter_new(maxVertices, flags,
+     complementFlag);
+    if(filter == NULL) {
+        fprintf(stderr, "Error: could not create filter.\n");
+        return 1;
+    }
+    int passedGraphs = 0;
+    clock_t start = clock();
+    for(int i = 0; i < numberOfGraphs; i++) {
+        if(outputHook(filter, &graphs[i])) {
+            passedGraphs++;
+        }
+    }
+    double timeSpent = (double)(clock() - start) / CLOCKS_PER_SEC;
+    fprintf(stderr, "Filtered %d graphs in %f seconds: %d passed.\n",
+     numberOfGraphs, timeSpent, passedGraphs);
+
+    fn_filter_free(filter);
+    for(int i = 0; i < numberOfGraphs; i++) {
+        free(graphs[i].graphString);
+        free(graphs[i].adjacency);
+    }
+    free(graphs);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <math.h>
+#include "graphFeatures.h"
+#include "../canonicalForm/canonicalForm.h"
+
+//  Constants of the cost model in predictCost(). They were chosen such that
+//  the ordering of graphs is sensible, the absolute values mean nothing.
+#define EXACT_COST_EXPONENT 0.5
+#define COLOURABLE_EXACT_FACTOR 0.1
+#define HEURISTIC_MISS_FACTOR 0.25
+
+//******************************************************************************
+//
+//                                  Girth
+//
+//******************************************************************************
+
+//  Breadth first search from every vertex. Returns 0 if the graph is acyclic.
+static int computeGirth(bitset adjacencyList[], int numberOfVertices) {
+    int girth = numberOfVertices + 1;
+    int distance[numberOfVertices];
+    int parent[numberOfVertices];
+    int queue[numberOfVertices];
+    for(int root = 0; root < numberOfVertices; root++) {
+        for(int i = 0; i < numberOfVertices; i++) {
+            distance[i] = -1;
+        }
+        distance[root] = 0;
+        parent[root] = -1;
+        int head = 0;
+        int tail = 0;
+        queue[tail++] = root;
+        while(head < tail) {
+            int v = queue[head++];
+
+            //  Cycles found from here on cannot be shorter.
+            if(2*distance[v] + 1 >= girth) {
+                break;
+            }
+            forEach(nbr, adjacencyList[v]) {
+                if(nbr == parent[v]) {
+                    continue;
+                }
+                if(distance[nbr] == -1) {
+                    distance[nbr] = distance[v] + 1;
+                    parent[nbr] = v;
+                    queue[tail++] = nbr;
+                }
+                else if(distance[v] + distance[nbr] + 1 < girth) {
+                    girth = distance[v] + distance[nbr] + 1;
+                }
+            }
+        }
+    }
+    return girth > numberOfVertices ? 0 : girth;
+}
+
+//******************************************************************************
+//
+//                      Perfect matchings and oddness
+//
+//******************************************************************************
+
+//  Count the odd cycles of the 2-factor which is the complement of the perfect
+//  matching F.
+static int countOddCyclesOfComplement(bitset adjacencyList[],
+ int numberOfVertices, int F[]) {
+    int numberOfOddCycles = 0;
+    bitset uncheckedVertices = complement(EMPTY, numberOfVertices);
+    while(!isEmpty(uncheckedVertices)) {
+        int start = first(uncheckedVertices);
+        int previousVertex = -1;
+        int currentVertex = start;
+        int length = 0;
+        do {
+            removeElement(uncheckedVertices, currentVertex);
+            int nextVertex = previousVertex == -1 ?
+             first(difference(adjacencyList[currentVertex],
+             singleton(F[currentVertex]))) :
+             otherOfThree(adjacencyList[currentVertex], F[currentVertex],
+             previousVertex);
+            previousVertex = currentVertex;
+            currentVertex = nextVertex;
+            length++;
+        } while(currentVertex != start);
+        if(length % 2 == 1) {
+            numberOfOddCycles++;
+        }
+    }
+    return numberOfOddCycles;
+}
+
+//  Always branch on the remaining vertex with the fewest remaining neighbours,
+//  such that dead ends are detected immediately.
+static void enumeratePerfectMatchings(bitset adjacencyList[],
+ int numberOfVertices, bitset remainingVertices, int F[],
+ struct graphFeatures *features) {
+    if(features->perfectMatchings >= FEATURE_ENUMERATION_CAP) {
+        return;
+    }
+    int nextVertex = -1;
+    int fewestNeighbours = 4;
+    forEach(v, remainingVertices) {
+        int numberOfNeighbours = size(intersection(adjacencyList[v],
+         remainingVertices));
+        if(numberOfNeighbours < fewestNeighbours) {
+            fewestNeighbours = numberOfNeighbours;
+            nextVertex = v;
+        }
+    }
+    if(fewestNeighbours == 0) {
+        return;
+    }
+    if(nextVertex == -1) {
+        features->perfectMatchings++;
+        int numberOfOddCycles = countOddCyclesOfComplement(adjacencyList,
+         numberOfVertices, F);
+        if(features->oddnessBound == -1 ||
+         numberOfOddCycles < features->oddnessBound) {
+            features->oddnessBound = numberOfOddCycles;
+        }
+        return;
+    }
+    forEach(neighbor, intersection(adjacencyList[nextVertex],
+     remainingVertices)) {
+        F[neighbor] = nextVertex;
+        F[nextVertex] = neighbor;
+        enumeratePerfectMatchings(adjacencyList, numberOfVertices,
+         difference(remainingVertices, union(singleton(nextVertex),
+         singleton(neighbor))), F, features);
+    }
+}
+
+//******************************************************************************
+//
+//                              Features
+//
+//******************************************************************************
+
+void computeGraphFeatures(bitset adjacencyList[], int numberOfVertices,
+ struct graphFeatures *features) {
+    *features = (struct graphFeatures) {.numberOfVertices = numberOfVertices,
+     .oddnessBound = -1, .automorphisms = 1};
+    features->girth = computeGirth(adjacencyList, numberOfVertices);
+
+    //  The enumerations below assume the graph to be cubic.
+    for(int i = 0; i < numberOfVertices; i++) {
+        if(size(adjacencyList[i]) != 3) {
+            return;
+        }
+    }
+
+    int F[numberOfVertices];
+    enumeratePerfectMatchings(adjacencyList, numberOfVertices,
+     complement(EMPTY, numberOfVertices), F, features);
+
+    struct canonicalForm form;
+    features->automorphismsCapped = !computeCanonicalForm(adjacencyList,
+     numberOfVertices, FEATURE_ENUMERATION_CAP, &form);
+    features->automorphisms = form.automorphisms;
+    features->hasHash = !features->automorphismsCapped;
+    if(features->hasHash) {
+        features->hash[0] = form.hash[0];
+        features->hash[1] = form.hash[1];
+    }
+}
+
+//  The heuristic algorithm loops over all perfect matchings. The number of
+//  orientations visited by the exact algorithm grows exponentially in the
+//  number of edges; it stops early if a complementary pair is found, which
+//  happens sooner for colourable and for very symmetric graphs and later if
+//  there are no short cycles.
+double predictCost(struct graphFeatures *features, bool usesHeuristic,
+ bool usesExactAlgorithm) {
+    int numberOfVertices = features->numberOfVertices;
+    double cost = numberOfVertices;
+    if(usesHeuristic) {
+        cost += (double) features->perfectMatchings * numberOfVertices *
+         numberOfVertices;
+    }
+    if(usesExactAlgorithm) {
+        double exactCost = exp2(EXACT_COST_EXPONENT * 3*numberOfVertices/2) *
+         (features->girth + 1) / sqrt((double) features->automorphisms);
+        if(features->oddnessBound == 0) {
+            exactCost *= COLOURABLE_EXACT_FACTOR;
+        }
+
+        //  The heuristic can only succeed if there is a 2-factor with exactly
+        //  two odd cycles.
+        if(usesHeuristic && features->oddnessBound == 2) {
+            exactCost *= HEURISTIC_MISS_FACTOR;
+        }
+        cost += exactCost;
+    }
+    return cost;
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPH_FEATURES
+#define GRAPH_FEATURES
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../bitset.h"
+
+//  Enumerations performed by the feature extractor stop after this many
+//  perfect matchings or search tree leaves.
+#define FEATURE_ENUMERATION_CAP 1024
+
+//  Cheap invariants of a cubic graph used to estimate how long the Frank
+//  number computation will take.
+struct graphFeatures {
+    int numberOfVertices;
+    int girth;
+
+    //  Number of perfect matchings, at most FEATURE_ENUMERATION_CAP.
+    int perfectMatchings;
+
+    //  Smallest number of odd cycles in the complementary 2-factor of one of
+    //  the enumerated perfect matchings. Upper bound for the oddness.
+    int oddnessBound;
+
+    //  Order of the automorphism group. Lower bound if automorphismsCapped.
+    long long unsigned int automorphisms;
+    bool automorphismsCapped;
+
+    //  Hash of the canonical form as used by the result cache, if hasHash.
+    bool hasHash;
+    uint64_t hash[2];
+
+    double predictedCost;
+};
+
+//  Compute all features of the graph. The predicted cost is left at 0.
+void computeGraphFeatures(bitset adjacencyList[], int numberOfVertices,
+ struct graphFeatures *features);
+
+//  Estimate the relative cost of checking a graph with the given features.
+//  Only the ordering of the returned values is meaningful.
+double predictCost(struct graphFeatures *features, bool usesHeuristic,
+ bool usesExactAlgorithm);
+
+#endif
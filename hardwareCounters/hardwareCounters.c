@@ -0,0 +1,145 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include "hardwareCounters.h"
+
+static const char *eventNames[NUMBER_OF_HARDWARE_EVENTS] = {
+    [CYCLES_EVENT] = "cycles",
+    [INSTRUCTIONS_EVENT] = "instructions",
+    [BRANCH_MISSES_EVENT] = "branchMisses",
+    [L1D_MISSES_EVENT] = "l1dMisses",
+    [LLC_MISSES_EVENT] = "llcMisses"
+};
+
+const char *getHardwareEventName(enum hardwareEvent event) {
+    return eventNames[event];
+}
+
+//  The first counter which could be opened leads the group. events lists the
+//  counted events in the order in which they were added to the group, which
+//  is the order in which a read of the leader returns their values.
+struct hardwareCounters {
+    int fileDescriptors[NUMBER_OF_HARDWARE_EVENTS];
+    enum hardwareEvent events[NUMBER_OF_HARDWARE_EVENTS];
+    int numberOfEvents;
+};
+
+#ifdef __linux__
+
+static void setEventType(enum hardwareEvent event,
+ struct perf_event_attr *attributes) {
+    uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes->type = PERF_TYPE_HARDWARE;
+    switch(event) {
+        case CYCLES_EVENT:
+            attributes->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case INSTRUCTIONS_EVENT:
+            attributes->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case BRANCH_MISSES_EVENT:
+            attributes->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case L1D_MISSES_EVENT:
+            attributes->type = PERF_TYPE_HW_CACHE;
+            attributes->config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        default:
+            attributes->type = PERF_TYPE_HW_CACHE;
+            attributes->config = PERF_COUNT_HW_CACHE_LL | readMiss;
+            break;
+    }
+}
+
+struct hardwareCounters *openHardwareCounters(void) {
+    struct hardwareCounters *counters =
+     calloc(1, sizeof(struct hardwareCounters));
+    if(counters == NULL) {
+        return NULL;
+    }
+    for(int event = 0; event < NUMBER_OF_HARDWARE_EVENTS; event++) {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        setEventType(event, &attributes);
+        attributes.read_format = PERF_FORMAT_GROUP;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        int leader = counters->numberOfEvents == 0 ? -1 :
+         counters->fileDescriptors[0];
+        attributes.disabled = leader == -1;
+        int fileDescriptor = (int) syscall(SYS_perf_event_open, &attributes,
+         0, -1, leader, PERF_FLAG_FD_CLOEXEC);
+        if(fileDescriptor == -1) {
+            continue;
+        }
+        counters->fileDescriptors[counters->numberOfEvents] = fileDescriptor;
+        counters->events[counters->numberOfEvents] = event;
+        counters->numberOfEvents++;
+    }
+    if(counters->numberOfEvents == 0) {
+        free(counters);
+        return NULL;
+    }
+    ioctl(counters->fileDescriptors[0], PERF_EVENT_IOC_ENABLE,
+     PERF_IOC_FLAG_GROUP);
+    return counters;
+}
+
+bool readHardwareCounters(struct hardwareCounters *counters,
+ long long unsigned int values[NUMBER_OF_HARDWARE_EVENTS]) {
+
+    //  The number of events followed by their values.
+    uint64_t buffer[NUMBER_OF_HARDWARE_EVENTS + 1];
+    memset(values, 0, sizeof(long long unsigned int)*NUMBER_OF_HARDWARE_EVENTS);
+    ssize_t length = read(counters->fileDescriptors[0], buffer,
+     sizeof(buffer));
+    if(length < (ssize_t) sizeof(uint64_t) ||
+     buffer[0] != (uint64_t) counters->numberOfEvents) {
+        return false;
+    }
+    for(int i = 0; i < counters->numberOfEvents; i++) {
+        values[counters->events[i]] = buffer[i + 1];
+    }
+    return true;
+}
+
+#else
+
+struct hardwareCounters *openHardwareCounters(void) {
+    return NULL;
+}
+
+bool readHardwareCounters(struct hardwareCounters *counters,
+ long long unsigned int values[NUMBER_OF_HARDWARE_EVENTS]) {
+    (void) counters;
+    memset(values, 0, sizeof(long long unsigned int)*NUMBER_OF_HARDWARE_EVENTS);
+    return false;
+}
+
+#endif
+
+unsigned int getCountedEvents(struct hardwareCounters *counters) {
+    unsigned int countedEvents = 0;
+    for(int i = 0; i < counters->numberOfEvents; i++) {
+        countedEvents |= 1U << counters->events[i];
+    }
+    return countedEvents;
+}
+
+void closeHardwareCounters(struct hardwareCounters *counters) {
+    if(counters == NULL) {
+        return;
+    }
+    for(int i = 0; i < counters->numberOfEvents; i++) {
+        close(counters->fileDescriptors[i]);
+    }
+    free(counters);
+}
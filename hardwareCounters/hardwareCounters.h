@@ -0,0 +1,39 @@
+#ifndef HARDWARE_COUNTERS
+#define HARDWARE_COUNTERS
+
+#include <stdbool.h>
+
+//  Hardware events counted with perf_event_open(2).
+enum hardwareEvent {
+    CYCLES_EVENT,
+    INSTRUCTIONS_EVENT,
+    BRANCH_MISSES_EVENT,
+    L1D_MISSES_EVENT,       //  Read misses of the level 1 data cache.
+    LLC_MISSES_EVENT,       //  Read misses of the last level cache.
+    NUMBER_OF_HARDWARE_EVENTS
+};
+
+//  A group of counters for the user space events of the thread which opened
+//  it. All counters of the group are scheduled together, so they always
+//  cover the same instructions.
+struct hardwareCounters;
+
+//  Open the counters for the calling thread. Events which the processor or
+//  the kernel do not support are left out. Returns NULL if none of the events
+//  can be counted, e.g. because of /proc/sys/kernel/perf_event_paranoid or
+//  because the program runs in a virtual machine without a virtual PMU.
+struct hardwareCounters *openHardwareCounters(void);
+
+//  Bit i is set if event i is counted.
+unsigned int getCountedEvents(struct hardwareCounters *counters);
+
+//  Store the current value of every event in values. Events which are not
+//  counted are 0. Returns false if the counters could not be read.
+bool readHardwareCounters(struct hardwareCounters *counters,
+ long long unsigned int values[NUMBER_OF_HARDWARE_EVENTS]);
+
+void closeHardwareCounters(struct hardwareCounters *counters);
+
+const char *getHardwareEventName(enum hardwareEvent event);
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * libraryTest.c
+ *
+ * Checks libfranknumber on the graphs of a corpus file whose Frank numbers
+ * are known, e.g. bench/corpus.txt, in which every line contains a name, the
+ * Frank number and the graph6 string of a graph, or starts with # for a
+ * comment. Every graph is checked with a context and a filter created for
+ * exactly its number of vertices, the smallest they allow, in the modes of
+ * fn_check(). For graphs with Frank number 3 it is also checked that every
+ * strong orientation is checked in exactly one part when the graph is split
+ * with fn_context_set_part(). The
+ * counters returned by fn_context_counters() must show the effect of later
+ * checks, and a check interrupted by its deadline must not count as a result.
+ *
+ * Exits with status 1 if an answer is wrong.
+ *
+ */
+
+#define USAGE \
+"\nUsage: `./libraryTest [-h] FILE`\n"
+#define HELPTEXT \
+"Check the graphs of the corpus file FILE with libfranknumber in several modes,\n\
+using contexts of the smallest size allowed by every graph.\n\
+\n\
+  -h, --help                    Print this help text\n\
+"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "../readGraph/readGraph6.h"
+#include "../frankNumber/frankNumber.h"
+#include "../bitset.h"
+
+//  The modes of fn_check() which are tested. Those with FN_ONLY_HEURISTIC
+//  only have to answer 0 for graphs with Frank number 3. FN_BRUTE_FORCE takes
+//  too long on the larger graphs and uses the scratch memory in the same way
+//  as FN_ONLY_EXACT.
+static const int modes[] = {0, FN_ONLY_EXACT, FN_ONLY_EXACT | FN_GRAY_CODE,
+ FN_ONLY_EXACT | FN_CERTIFICATE, FN_ONLY_HEURISTIC,
+ FN_ONLY_HEURISTIC | FN_DOUBLE_CHECK};
+
+#define NUMBER_OF_MODES ((int) (sizeof(modes)/sizeof(modes[0])))
+
+//  Reads a graph6 string into neighbour lists. Returns the number of vertices
+//  or -1 if the graph is not cubic or too large.
+static int readCubicGraph(const char *graphString, int (**adjacency)[3]) {
+    int numberOfVertices = getNumberOfVertices(graphString);
+    bitset adjacencyList[MAXVERTICES];
+    if(numberOfVertices < 1 || numberOfVertices > fn_max_vertices() ||
+     loadGraph(graphString, numberOfVertices, adjacencyList) == -1) {
+        return -1;
+    }
+    *adjacency = malloc(sizeof(int[3])*numberOfVertices);
+    if(*adjacency == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        exit(1);
+    }
+    for(int v = 0; v < numberOfVertices; v++) {
+        if(size(adjacencyList[v]) != 3) {
+            free(*adjacency);
+            return -1;
+        }
+        int i = 0;
+        forEach(w, adjacencyList[v]) {
+            (*adjacency)[v][i++] = w;
+        }
+    }
+    return numberOfVertices;
+}
+
+//  Every strong orientation of a graph with Frank number 3 is checked by the
+//  exact algorithm. Splitting it into parts with fn_context_set_part() must
+//  check each of them in exactly one part, also in Gray code order. Returns
+//  the number of failed checks.
+static int checkParts(const char *name, struct fn_context *context,
+ const int adjacency[][3], int numberOfVertices) {
+    int failures = 0;
+    const int numberOfParts = 3;
+    for(int gray = 0; gray < 2; gray++) {
+        int flags = FN_ONLY_EXACT | (gray ? FN_GRAY_CODE : 0);
+        struct fn_result result;
+        fn_context_set_part(context, 0, 1);
+        fn_check(context, adjacency, numberOfVertices, flags, &result);
+        long long unsigned int orientations =
+         fn_context_counters(context)->generatedOrientations;
+        long long unsigned int orientationsOfParts = 0;
+        for(int part = 0; part < numberOfParts; part++) {
+            fn_context_set_part(context, part, numberOfParts);
+            fn_check(context, adjacency, numberOfVertices, flags, &result);
+            orientationsOfParts +=
+             fn_context_counters(context)->generatedOrientations;
+        }
+        fn_context_set_part(context, 0, 1);
+        if(orientationsOfParts != orientations) {
+            fprintf(stderr, "%s: flags %#x checked %llu orientations, but "
+             "%llu in %d parts\n", name, flags, orientations,
+             orientationsOfParts, numberOfParts);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+//  The counters returned before a check show its effect afterwards, as the
+//  interface promises for every build, including the one dispatching to
+//  several widths: the default mode either succeeds or fails with the
+//  heuristic. Returns the number of failed checks.
+static int checkCounters(const char *name, struct fn_context *context,
+ const int adjacency[][3], int numberOfVertices) {
+    const struct fn_counters *numberOf = fn_context_counters(context);
+    struct fn_counters before = *numberOf;
+    struct fn_result result;
+    fn_check(context, adjacency, numberOfVertices, 0, &result);
+    long long unsigned int heuristics =
+     numberOf->graphsSatisfyingOddnessCondition -
+     before.graphsSatisfyingOddnessCondition +
+     numberOf->graphsNotSatisfyingOddnessCondition -
+     before.graphsNotSatisfyingOddnessCondition;
+    if(heuristics != 1) {
+        fprintf(stderr, "%s: the counters show %llu heuristics for one "
+         "check\n", name, heuristics);
+        return 1;
+    }
+    return 0;
+}
+
+//  A check interrupted by a deadline which already passed returns FN_ABORTED
+//  without a result, and the heuristic it interrupted is not counted as
+//  failed. Returns the number of failed checks.
+static int checkAbort(const char *name, struct fn_context *context,
+ const int adjacency[][3], int numberOfVertices) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec--;
+    fn_context_set_deadline(context, &deadline);
+    struct fn_counters before = *fn_context_counters(context);
+    struct fn_result result;
+    int status = fn_check(context, adjacency, numberOfVertices, 0, &result);
+    const struct fn_counters *after = fn_context_counters(context);
+    fn_context_set_deadline(context, NULL);
+    if(status != FN_ABORTED || result.frankNumber != 0 ||
+     after->graphsSatisfyingOddnessCondition !=
+     before.graphsSatisfyingOddnessCondition ||
+     after->graphsNotSatisfyingOddnessCondition !=
+     before.graphsNotSatisfyingOddnessCondition) {
+        fprintf(stderr, "%s: passed deadline gave status %d and %d, the "
+         "heuristic was counted\n", name, status, result.frankNumber);
+        return 1;
+    }
+    return 0;
+}
+
+//  Checks one graph in every mode and with a filter. Returns the number of
+//  failed checks.
+static int checkGraph(const char *name, int expectedFrankNumber,
+ const int adjacency[][3], int numberOfVertices) {
+    int failures = 0;
+    struct fn_context *context = fn_context_new(numberOfVertices);
+    if(context == NULL) {
+        fprintf(stderr, "%s: could not create context for %d vertices\n",
+         name, numberOfVertices);
+        return 1;
+    }
+    for(int i = 0; i < NUMBER_OF_MODES; i++) {
+        struct fn_result result;
+        int status = fn_check(context, adjacency, numberOfVertices, modes[i],
+         &result);
+        bool isCorrect = modes[i] & FN_ONLY_HEURISTIC ?
+         expectedFrankNumber == 2 || result.frankNumber == 0 :
+         result.frankNumber == (expectedFrankNumber == 2 ? 2 : 0);
+        if(status != FN_OK || !isCorrect) {
+            fprintf(stderr, "%s: flags %#x gave status %d and %d\n", name,
+             modes[i], status, result.frankNumber);
+            failures++;
+        }
+    }
+    if(expectedFrankNumber != 2) {
+        failures += checkParts(name, context, adjacency, numberOfVertices);
+    }
+    failures += checkCounters(name, context, adjacency, numberOfVertices);
+    failures += checkAbort(name, context, adjacency, numberOfVertices);
+    fn_context_free(context);
+
+    struct fn_filter *filter = fn_filter_new(numberOfVertices, FN_ONLY_EXACT,
+     false);
+    if(filter == NULL) {
+        fprintf(stderr, "%s: could not create filter for %d vertices\n",
+         name, numberOfVertices);
+        return failures + 1;
+    }
+    if(fn_filter_accept(filter, adjacency, numberOfVertices) !=
+     (expectedFrankNumber != 2)) {
+        fprintf(stderr, "%s: wrongly %s by the filter\n", name,
+         expectedFrankNumber != 2 ? "rejected" : "accepted");
+        failures++;
+    }
+    fn_filter_free(filter);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while (1) {
+        int option_index = 0;
+        static struct option long_options[] =
+        {
+            {"help", no_argument, NULL, 'h'},
+            {NULL, 0, NULL, 0}
+        };
+
+        opt = getopt_long(argc, argv, "h", long_options, &option_index);
+        if (opt == -1) break;
+        switch(opt) {
+            case 'h':
+                fprintf(stderr, "%s\n", USAGE);
+                fprintf(stderr, "%s", HELPTEXT);
+                return 0;
+            case '?':
+                fprintf(stderr, "%s\n", USAGE);
+                return 1;
+        }
+    }
+    if(optind != argc - 1) {
+        fprintf(stderr, "Error: give exactly one corpus file.\n");
+        fprintf(stderr, "%s\n", USAGE);
+        return 1;
+    }
+    FILE *file = fopen(argv[optind], "r");
+    if(file == NULL) {
+        fprintf(stderr, "Error: could not open %s.\n", argv[optind]);
+        return 1;
+    }
+
+    int checkedGraphs = 0;
+    int failures = 0;
+    char *line = NULL;
+    size_t lineSize;
+    while(getline(&line, &lineSize, file) != -1) {
+        char name[256];
+        char graphString[1025];
+        int expectedFrankNumber;
+        if(line[0] == '#' || sscanf(line, "%255s %d %1023s", name, &expectedFrankNumber,
+         graphString) != 3) {
+            continue;
+        }
+        strcat(graphString, "\n");
+        int (*adjacency)[3];
+        int numberOfVertices = readCubicGraph(graphString, &adjacency);
+        if(numberOfVertices == -1) {
+            continue;
+        }
+        failures += checkGraph(name, expectedFrankNumber,
+         (const int (*)[3]) adjacency, numberOfVertices);
+        checkedGraphs++;
+        free(adjacency);
+    }
+    free(line);
+    fclose(file);
+
+    fprintf(stderr, "Checked %d graphs: %d checks failed.\n", checkedGraphs,
+     failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,272 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "progress.h"
+
+struct progress {
+    pthread_t thread;
+    char *fileName;
+    double interval;
+    long long unsigned int inputSize;
+    struct timespec start;
+    atomic_bool stopping;
+
+    atomic_ullong bytesRead;
+    atomic_ullong checkedGraphs;
+    atomic_ullong heuristicAttempts;
+    atomic_ullong heuristicSuccesses;
+
+    //  The slowest graph checked so far, protected by lock.
+    pthread_mutex_t lock;
+    double slowestSeconds;
+    char *slowestGraph;
+};
+
+//  A consistent copy of the state of the run at the moment of a report.
+struct report {
+    double elapsedSeconds;
+    long long unsigned int bytesRead;
+    long long unsigned int checkedGraphs;
+    long long unsigned int heuristicAttempts;
+    long long unsigned int heuristicSuccesses;
+    double slowestSeconds;
+    char *slowestGraph;
+};
+
+static double secondsSince(struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//  Remaining seconds assuming the rest of the input is read at the same rate,
+//  or -1 if this cannot be estimated.
+static double getETA(struct progress *progress, struct report *report) {
+    if(progress->inputSize == 0 || report->bytesRead == 0) {
+        return -1;
+    }
+    double remainingBytes = report->bytesRead < progress->inputSize ?
+     (double) (progress->inputSize - report->bytesRead) : 0;
+    return report->elapsedSeconds * remainingBytes / report->bytesRead;
+}
+
+static void formatSeconds(double seconds, char *buffer, size_t size) {
+    long long int total = (long long int) seconds;
+    if(total >= 3600) {
+        snprintf(buffer, size, "%lldh%02lldm", total / 3600,
+         total / 60 % 60);
+    }
+    else if(total >= 60) {
+        snprintf(buffer, size, "%lldm%02llds", total / 60, total % 60);
+    }
+    else {
+        snprintf(buffer, size, "%.1fs", seconds);
+    }
+}
+
+static void writeLine(struct progress *progress, struct report *report) {
+    char buffers[2][32];
+    double rate = report->elapsedSeconds > 0 ?
+     report->checkedGraphs / report->elapsedSeconds : 0;
+    formatSeconds(report->elapsedSeconds, buffers[0], 32);
+    fprintf(stderr, "Progress: %llu graphs checked in %s, %.1f graphs/s",
+     report->checkedGraphs, buffers[0], rate);
+    double eta = getETA(progress, report);
+    if(eta >= 0) {
+        formatSeconds(eta, buffers[1], 32);
+        fprintf(stderr, ", %.1f%% of input, ETA %s",
+         100.0 * report->bytesRead / progress->inputSize, buffers[1]);
+    }
+    if(report->heuristicAttempts > 0) {
+        fprintf(stderr, ", heuristic succeeded for %.1f%%",
+         100.0 * report->heuristicSuccesses / report->heuristicAttempts);
+    }
+    if(report->slowestGraph != NULL) {
+        fprintf(stderr, ", slowest %.3fs %s", report->slowestSeconds,
+         report->slowestGraph);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void writeMetric(FILE *file, const char *name, const char *type,
+ const char *help, double value) {
+    fprintf(file, "# HELP findfranknumber_%s %s\n", name, help);
+    fprintf(file, "# TYPE findfranknumber_%s %s\n", name, type);
+    fprintf(file, "findfranknumber_%s %.17g\n", name, value);
+}
+
+//  Label values escape backslashes, which graph6 strings can contain.
+static void writeLabelValue(FILE *file, const char *value) {
+    for(; *value != '\0'; value++) {
+        if(*value == '\\' || *value == '"') {
+            fputc('\\', file);
+        }
+        fputc(*value, file);
+    }
+}
+
+//  The file is written next to fileName and renamed, such that a collector
+//  never reads a partial file.
+static void writeTextfile(struct progress *progress, struct report *report) {
+    size_t length = strlen(progress->fileName) + 32;
+    char temporaryName[length];
+    snprintf(temporaryName, length, "%s.%d.tmp", progress->fileName,
+     (int) getpid());
+    FILE *file = fopen(temporaryName, "w");
+    if(file == NULL) {
+        return;
+    }
+    writeMetric(file, "elapsed_seconds", "gauge",
+     "Seconds since the run started.", report->elapsedSeconds);
+    writeMetric(file, "graphs_checked_total", "counter",
+     "Graphs checked so far.", report->checkedGraphs);
+    writeMetric(file, "graphs_per_second", "gauge",
+     "Average number of graphs checked per second.",
+     report->elapsedSeconds > 0 ?
+     report->checkedGraphs / report->elapsedSeconds : 0);
+    writeMetric(file, "input_read_bytes_total", "counter",
+     "Bytes of the input read so far.", report->bytesRead);
+    if(progress->inputSize > 0) {
+        writeMetric(file, "input_bytes", "gauge",
+         "Size of the input in bytes.", progress->inputSize);
+        double eta = getETA(progress, report);
+        if(eta >= 0) {
+            writeMetric(file, "eta_seconds", "gauge",
+             "Estimated number of seconds until the input is finished.", eta);
+        }
+    }
+    writeMetric(file, "heuristic_attempts_total", "counter",
+     "Graphs for which the heuristic algorithm was tried.",
+     report->heuristicAttempts);
+    writeMetric(file, "heuristic_successes_total", "counter",
+     "Graphs for which the heuristic algorithm decided the Frank number.",
+     report->heuristicSuccesses);
+    if(report->slowestGraph != NULL) {
+        fprintf(file, "# HELP findfranknumber_slowest_graph_seconds Seconds "
+         "spent on the slowest graph so far.\n");
+        fprintf(file, "# TYPE findfranknumber_slowest_graph_seconds gauge\n");
+        fprintf(file, "findfranknumber_slowest_graph_seconds{graph=\"");
+        writeLabelValue(file, report->slowestGraph);
+        fprintf(file, "\"} %.17g\n", report->slowestSeconds);
+    }
+    writeMetric(file, "last_report_timestamp_seconds", "gauge",
+     "Unix time of this report.", (double) time(NULL));
+    bool failed = ferror(file);
+    if(fclose(file) != 0 || failed ||
+     rename(temporaryName, progress->fileName) != 0) {
+        unlink(temporaryName);
+    }
+}
+
+static void writeReport(struct progress *progress) {
+    struct report report = {.elapsedSeconds = secondsSince(&progress->start),
+     .bytesRead = atomic_load(&progress->bytesRead),
+     .checkedGraphs = atomic_load(&progress->checkedGraphs),
+     .heuristicAttempts = atomic_load(&progress->heuristicAttempts),
+     .heuristicSuccesses = atomic_load(&progress->heuristicSuccesses)};
+    pthread_mutex_lock(&progress->lock);
+    report.slowestSeconds = progress->slowestSeconds;
+    if(progress->slowestGraph != NULL) {
+        report.slowestGraph = strdup(progress->slowestGraph);
+    }
+    pthread_mutex_unlock(&progress->lock);
+    if(progress->fileName != NULL) {
+        writeTextfile(progress, &report);
+    }
+    else {
+        writeLine(progress, &report);
+    }
+    free(report.slowestGraph);
+}
+
+//  Wait for the interval to pass or for SIGUSR1, which stopProgress() also
+//  uses to wake this thread.
+static void *reportProgress(void *arg) {
+    struct progress *progress = arg;
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    struct timespec interval = {.tv_sec = (time_t) progress->interval,
+     .tv_nsec = (long) ((progress->interval - (time_t) progress->interval) *
+     1e9)};
+    while(!atomic_load(&progress->stopping)) {
+        int signal = sigtimedwait(&signals, NULL, &interval);
+        if(signal == -1 && errno == EINTR) {
+            continue;
+        }
+        if(!atomic_load(&progress->stopping)) {
+            writeReport(progress);
+        }
+    }
+    return NULL;
+}
+
+struct progress *startProgress(const char *fileName, double interval,
+ long long unsigned int inputSize) {
+    struct progress *progress = calloc(1, sizeof(struct progress));
+    if(progress == NULL) {
+        return NULL;
+    }
+    progress->fileName = fileName != NULL ? strdup(fileName) : NULL;
+    progress->interval = interval;
+    progress->inputSize = inputSize;
+    pthread_mutex_init(&progress->lock, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &progress->start);
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    if((fileName != NULL && progress->fileName == NULL) ||
+     pthread_create(&progress->thread, NULL, reportProgress, progress)) {
+        free(progress->fileName);
+        free(progress);
+        return NULL;
+    }
+    return progress;
+}
+
+void addInput(struct progress *progress, size_t bytes) {
+    atomic_fetch_add_explicit(&progress->bytesRead, bytes,
+     memory_order_relaxed);
+}
+
+void addCheckedGraph(struct progress *progress, const char *graphString,
+ double seconds, bool triedHeuristic, bool heuristicSucceeded) {
+    atomic_fetch_add_explicit(&progress->checkedGraphs, 1,
+     memory_order_relaxed);
+    if(triedHeuristic) {
+        atomic_fetch_add_explicit(&progress->heuristicAttempts, 1,
+         memory_order_relaxed);
+    }
+    if(heuristicSucceeded) {
+        atomic_fetch_add_explicit(&progress->heuristicSuccesses, 1,
+         memory_order_relaxed);
+    }
+    pthread_mutex_lock(&progress->lock);
+    if(progress->slowestGraph == NULL || seconds > progress->slowestSeconds) {
+        char *copy = strndup(graphString, strcspn(graphString, "\r\n"));
+        if(copy != NULL) {
+            free(progress->slowestGraph);
+            progress->slowestGraph = copy;
+            progress->slowestSeconds = seconds;
+        }
+    }
+    pthread_mutex_unlock(&progress->lock);
+}
+
+void stopProgress(struct progress *progress) {
+    atomic_store(&progress->stopping, true);
+    pthread_kill(progress->thread, SIGUSR1);
+    pthread_join(progress->thread, NULL);
+    writeReport(progress);
+    pthread_mutex_destroy(&progress->lock);
+    free(progress->slowestGraph);
+    free(progress->fileName);
+    free(progress);
+}
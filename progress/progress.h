@@ -0,0 +1,32 @@
+#ifndef PROGRESS
+#define PROGRESS
+
+#include <stdbool.h>
+#include <stddef.h>
+
+//  Reports on the progress of a long run, written periodically by a separate
+//  thread and immediately when the process receives SIGUSR1.
+struct progress;
+
+//  Start the reporting thread, which writes a report every interval seconds.
+//  If fileName is NULL, a line is written to stderr. Otherwise fileName is
+//  replaced by a file in the Prometheus textfile format. inputSize is the
+//  number of bytes of the input, or 0 if it is unknown, in which case no ETA
+//  is given. SIGUSR1 is blocked in the calling thread and in the threads it
+//  creates afterwards, so this should be called before any other thread is
+//  started. Returns NULL on failure.
+struct progress *startProgress(const char *fileName, double interval,
+ long long unsigned int inputSize);
+
+//  Count bytes read from the input. Can be called from any thread.
+void addInput(struct progress *progress, size_t bytes);
+
+//  Count a checked graph which took the given number of seconds. Can be called
+//  from any thread.
+void addCheckedGraph(struct progress *progress, const char *graphString,
+ double seconds, bool triedHeuristic, bool heuristicSucceeded);
+
+//  Write a final report and stop the reporting thread.
+void stopProgress(struct progress *progress);
+
+#endif
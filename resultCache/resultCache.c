@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "resultCache.h"
+
+#define CACHE_MAGIC "FNCACHE"
+#define CACHE_VERSION 1
+#define INITIAL_CAPACITY 4096
+
+//  The file consists of this header followed by header.capacity entries. The
+//  capacity is a power of two and the table is kept at most half full.
+struct cacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t capacity;
+    uint64_t numberOfEntries;
+    uint8_t padding[32];
+};
+
+struct resultCache {
+    int fd;
+    pthread_mutex_t lock;
+    struct cacheHeader *header;
+    struct cacheEntry *entries;
+    uint64_t capacity;
+    size_t mappedSize;
+};
+
+#define cacheFileSize(capacity) (sizeof(struct cacheHeader) + \
+ (capacity)*sizeof(struct cacheEntry))
+
+//  Map the cache with the given capacity. The file should already be large
+//  enough.
+static bool mapCache(struct resultCache *cache, uint64_t capacity) {
+    size_t mappedSize = cacheFileSize(capacity);
+    void *map = cache->fd == -1 ?
+     mmap(NULL, mappedSize, PROT_READ | PROT_WRITE,
+     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) :
+     mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0);
+    if(map == MAP_FAILED) {
+        return false;
+    }
+    cache->header = map;
+    cache->entries = (struct cacheEntry *) (cache->header + 1);
+    cache->capacity = capacity;
+    cache->mappedSize = mappedSize;
+    return true;
+}
+
+//  Lock the cache for this thread and process. Another process might have
+//  grown the file in the meantime.
+static void lockCache(struct resultCache *cache, int operation) {
+    pthread_mutex_lock(&cache->lock);
+    if(cache->fd == -1) {
+        return;
+    }
+    flock(cache->fd, operation);
+    if(cache->header->capacity != cache->capacity) {
+        uint64_t capacity = cache->header->capacity;
+        munmap(cache->header, cache->mappedSize);
+        if(!mapCache(cache, capacity)) {
+            fprintf(stderr, "Error: could not map cache.\n");
+            exit(1);
+        }
+    }
+}
+
+static void unlockCache(struct resultCache *cache) {
+    if(cache->fd != -1) {
+        flock(cache->fd, LOCK_UN);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+#define keysAreEqual(entry1, entry2) (\
+ (entry1)->hash[0] == (entry2)->hash[0] &&\
+ (entry1)->hash[1] == (entry2)->hash[1] &&\
+ (entry1)->numberOfVertices == (entry2)->numberOfVertices &&\
+ (entry1)->mode == (entry2)->mode)
+
+//  Linear probing. Returns the slot containing the key or the empty slot where
+//  it should be inserted.
+static struct cacheEntry *findSlot(struct resultCache *cache,
+ struct cacheEntry *entry) {
+    uint64_t mask = cache->capacity - 1;
+    uint64_t i = (entry->hash[0] ^ entry->mode) & mask;
+    for(;; i = (i+1) & mask) {
+        struct cacheEntry *slot = &cache->entries[i];
+        if(slot->mode == CACHE_MODE_EMPTY || keysAreEqual(slot, entry)) {
+            return slot;
+        }
+    }
+}
+
+//  Double the capacity and rehash all entries.
+static bool growCache(struct resultCache *cache) {
+    uint64_t oldCapacity = cache->capacity;
+    struct cacheEntry *oldEntries =
+     malloc(oldCapacity*sizeof(struct cacheEntry));
+    if(oldEntries == NULL) {
+        return false;
+    }
+    memcpy(oldEntries, cache->entries, oldCapacity*sizeof(struct cacheEntry));
+    struct cacheHeader header = *cache->header;
+
+    if(cache->fd != -1 &&
+     ftruncate(cache->fd, cacheFileSize(2*oldCapacity)) == -1) {
+        free(oldEntries);
+        return false;
+    }
+    munmap(cache->header, cache->mappedSize);
+    if(!mapCache(cache, 2*oldCapacity)) {
+        fprintf(stderr, "Error: could not map cache.\n");
+        exit(1);
+    }
+    *cache->header = header;
+    cache->header->capacity = cache->capacity;
+    memset(cache->entries, 0, cache->capacity*sizeof(struct cacheEntry));
+    for(uint64_t i = 0; i < oldCapacity; i++) {
+        if(oldEntries[i].mode != CACHE_MODE_EMPTY) {
+            *findSlot(cache, &oldEntries[i]) = oldEntries[i];
+        }
+    }
+    free(oldEntries);
+    return true;
+}
+
+struct resultCache *openResultCache(const char *fileName) {
+    struct resultCache *cache = malloc(sizeof(struct resultCache));
+    if(cache == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->fd = -1;
+    if(fileName == NULL) {
+        if(!mapCache(cache, INITIAL_CAPACITY)) {
+            free(cache);
+            return NULL;
+        }
+        cache->header->capacity = INITIAL_CAPACITY;
+        return cache;
+    }
+
+    cache->fd = open(fileName, O_RDWR | O_CREAT, 0644);
+    if(cache->fd == -1) {
+        free(cache);
+        return NULL;
+    }
+    flock(cache->fd, LOCK_EX);
+    struct stat fileStatus;
+    struct cacheHeader header = {.magic = CACHE_MAGIC,
+     .version = CACHE_VERSION, .entrySize = sizeof(struct cacheEntry),
+     .capacity = INITIAL_CAPACITY};
+    bool isValid = fstat(cache->fd, &fileStatus) == 0;
+
+    //  New file: write the header and make room for the entries.
+    if(isValid && fileStatus.st_size == 0) {
+        isValid = write(cache->fd, &header, sizeof(header)) == sizeof(header) &&
+         ftruncate(cache->fd, cacheFileSize(INITIAL_CAPACITY)) == 0;
+    }
+    else if(isValid) {
+        struct cacheHeader existingHeader;
+        isValid = pread(cache->fd, &existingHeader, sizeof(existingHeader), 0)
+         == sizeof(existingHeader) &&
+         memcmp(existingHeader.magic, header.magic, sizeof(header.magic)) == 0
+         && existingHeader.version == CACHE_VERSION &&
+         existingHeader.entrySize == sizeof(struct cacheEntry) &&
+         (uint64_t) fileStatus.st_size >=
+         cacheFileSize(existingHeader.capacity);
+        header = existingHeader;
+    }
+    isValid = isValid && mapCache(cache, header.capacity);
+    flock(cache->fd, LOCK_UN);
+    if(!isValid) {
+        close(cache->fd);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+bool lookupResult(struct resultCache *cache, struct cacheEntry *entry) {
+    lockCache(cache, LOCK_SH);
+    struct cacheEntry *slot = findSlot(cache, entry);
+    bool found = slot->mode != CACHE_MODE_EMPTY;
+    if(found) {
+        *entry = *slot;
+    }
+    unlockCache(cache);
+    return found;
+}
+
+bool insertResult(struct resultCache *cache, struct cacheEntry *entry) {
+    lockCache(cache, LOCK_EX);
+    if(2*(cache->header->numberOfEntries + 1) > cache->capacity &&
+     !growCache(cache)) {
+        unlockCache(cache);
+        return false;
+    }
+    struct cacheEntry *slot = findSlot(cache, entry);
+    if(slot->mode == CACHE_MODE_EMPTY) {
+        cache->header->numberOfEntries++;
+    }
+    *slot = *entry;
+    unlockCache(cache);
+    return true;
+}
+
+void closeResultCache(struct resultCache *cache) {
+    munmap(cache->header, cache->mappedSize);
+    if(cache->fd != -1) {
+        close(cache->fd);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
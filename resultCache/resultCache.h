@@ -0,0 +1,50 @@
+#ifndef RESULT_CACHE
+#define RESULT_CACHE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//  Certificates can be stored for graphs with at most 64*CERTIFICATE_WORDS
+//  edges.
+#define CERTIFICATE_WORDS 4
+
+//  What was computed for a graph. Part of the key of an entry.
+enum cacheMode {
+    CACHE_MODE_EMPTY = 0,
+    CACHE_MODE_DEFAULT = 1,     //  Heuristic followed by exact algorithm.
+    CACHE_MODE_EXACT = 2,       //  Only exact algorithm.
+    CACHE_MODE_HEURISTIC = 3    //  Only heuristic algorithm.
+};
+
+//  One slot of the on-disk hash table. The key consists of the hash of the
+//  canonical form, the number of vertices and the mode.
+struct cacheEntry {
+    uint64_t hash[2];
+    uint16_t numberOfVertices;
+    uint8_t mode;
+    uint8_t frankNumber;
+    uint8_t hasCertificate;
+    uint8_t padding[3];
+
+    //  Direction of every edge, numbered in the order of the canonical code,
+    //  in both orientations of the certificate. A bit is set if the edge is
+    //  oriented from the smaller to the larger canonical label.
+    uint64_t certificate[2][CERTIFICATE_WORDS];
+};
+
+struct resultCache;
+
+//  Open or create a cache file. If fileName is NULL the cache only lives in
+//  memory. Returns NULL on failure.
+struct resultCache *openResultCache(const char *fileName);
+
+//  Look up the entry with the same key as entry and copy it to entry. Returns
+//  false if there is no such entry.
+bool lookupResult(struct resultCache *cache, struct cacheEntry *entry);
+
+//  Insert entry, replacing any entry with the same key.
+bool insertResult(struct resultCache *cache, struct cacheEntry *entry);
+
+void closeResultCache(struct resultCache *cache);
+
+#endif
@@ -0,0 +1,475 @@
+#include <stdlib.h>
+#include <string.h>
+#include "runStats.h"
+
+//  Bucket i of a histogram counts the graphs for which a phase took between
+//  2^i and 2^(i+1) nanoseconds. Bucket 0 also counts shorter times and the
+//  last bucket also longer ones.
+#define HISTOGRAM_BUCKETS 48
+
+struct phaseStats {
+    long long unsigned int graphs;
+    long long unsigned int calls;
+    double wallSeconds;
+    double cpuSeconds;
+    double maxWallSeconds;
+    long long unsigned int histogram[HISTOGRAM_BUCKETS];
+    long long unsigned int events[NUMBER_OF_HARDWARE_EVENTS];
+};
+
+struct sizeBucket {
+    long long unsigned int graphs;
+    long long unsigned int events[NUMBER_OF_STATS_PHASES + 1]
+     [NUMBER_OF_HARDWARE_EVENTS];
+};
+
+struct slowGraph {
+    char *graphString;
+    double wallSeconds;
+    double cpuSeconds;
+};
+
+//  The statistics of the time per graph are kept as an extra phase.
+struct runStats {
+    long long unsigned int graphs;
+    struct timespec startWall;
+    struct timespec startCpu;
+    struct phaseStats phases[NUMBER_OF_STATS_PHASES + 1];
+
+    //  Sorted by decreasing wall time.
+    struct slowGraph slowest[SLOWEST_GRAPHS];
+    int numberOfSlowest;
+
+    //  Bit i is set if hardware event i was counted for some graph.
+    unsigned int countedEvents;
+    struct sizeBucket sizeBuckets[NUMBER_OF_SIZE_BUCKETS];
+};
+
+#define TOTAL_PHASE NUMBER_OF_STATS_PHASES
+
+static const char *phaseNames[NUMBER_OF_STATS_PHASES + 1] = {
+    [DECODE_PHASE] = "decode",
+    [VALIDATION_PHASE] = "validation",
+    [SUFFICIENT_CONDITION_PHASE] = "sufficientCondition",
+    [ORIENTATIONS_PHASE] = "orientations",
+    [DELETABLE_EDGES_PHASE] = "deletableEdges",
+    [COMPLEMENTARY_ORIENTATION_PHASE] = "complementaryOrientation",
+    [OUTPUT_PHASE] = "output",
+    [TOTAL_PHASE] = "graph"
+};
+
+static const bool isNested[NUMBER_OF_STATS_PHASES] = {
+    [DELETABLE_EDGES_PHASE] = true,
+    [COMPLEMENTARY_ORIENTATION_PHASE] = true
+};
+
+static double secondsBetween(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) +
+     (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void startEvents(struct graphTiming *timing, struct phaseStart *start) {
+    start->hasEvents = timing != NULL && timing->counters != NULL &&
+     readHardwareCounters(timing->counters, start->events);
+}
+
+void endEvents(struct graphTiming *timing, struct phaseStart *start,
+ enum statsPhase phase) {
+    long long unsigned int events[NUMBER_OF_HARDWARE_EVENTS];
+    if(!start->hasEvents || !readHardwareCounters(timing->counters, events)) {
+        return;
+    }
+    for(int i = 0; i < NUMBER_OF_HARDWARE_EVENTS; i++) {
+        timing->events[phase][i] += events[i] - start->events[i];
+    }
+}
+
+//  The counters are read last at the start and first at the end, such that
+//  reading the clocks is not counted.
+void startPhase(struct graphTiming *timing, struct phaseStart *start) {
+    if(timing != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &start->wall);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start->cpu);
+    }
+    startEvents(timing, start);
+}
+
+void endPhase(struct graphTiming *timing, struct phaseStart *start,
+ enum statsPhase phase) {
+    if(timing == NULL) {
+        return;
+    }
+    endEvents(timing, start, phase);
+    struct timespec wall;
+    struct timespec cpu;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    timing->wallSeconds[phase] += secondsBetween(&start->wall, &wall);
+    timing->cpuSeconds[phase] += secondsBetween(&start->cpu, &cpu);
+    timing->calls[phase]++;
+}
+
+struct runStats *newRunStats(void) {
+    struct runStats *stats = calloc(1, sizeof(struct runStats));
+    if(stats == NULL) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stats->startWall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stats->startCpu);
+    return stats;
+}
+
+void freeRunStats(struct runStats *stats) {
+    for(int i = 0; i < stats->numberOfSlowest; i++) {
+        free(stats->slowest[i].graphString);
+    }
+    free(stats);
+}
+
+static int getBucket(double seconds) {
+    double nanoseconds = seconds * 1e9;
+    int bucket = 0;
+    while(bucket < HISTOGRAM_BUCKETS - 1 && nanoseconds >= 2.0) {
+        nanoseconds /= 2;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void addToPhase(struct phaseStats *phase, long long unsigned int calls,
+ double wallSeconds, double cpuSeconds) {
+    phase->graphs++;
+    phase->calls += calls;
+    phase->wallSeconds += wallSeconds;
+    phase->cpuSeconds += cpuSeconds;
+    if(wallSeconds > phase->maxWallSeconds) {
+        phase->maxWallSeconds = wallSeconds;
+    }
+    phase->histogram[getBucket(wallSeconds)]++;
+}
+
+//  Insert the graph in the list of slowest graphs if it belongs there.
+static void updateSlowest(struct runStats *stats, const char *graphString,
+ double wallSeconds, double cpuSeconds) {
+    if(stats->numberOfSlowest == SLOWEST_GRAPHS &&
+     stats->slowest[SLOWEST_GRAPHS - 1].wallSeconds >= wallSeconds) {
+        return;
+    }
+    char *copy = strndup(graphString, strcspn(graphString, "\r\n"));
+    if(copy == NULL) {
+        return;
+    }
+    if(stats->numberOfSlowest == SLOWEST_GRAPHS) {
+        free(stats->slowest[SLOWEST_GRAPHS - 1].graphString);
+    }
+    else {
+        stats->numberOfSlowest++;
+    }
+    int i = stats->numberOfSlowest - 1;
+    while(i > 0 && stats->slowest[i - 1].wallSeconds < wallSeconds) {
+        stats->slowest[i] = stats->slowest[i - 1];
+        i--;
+    }
+    stats->slowest[i] = (struct slowGraph) {.graphString = copy,
+     .wallSeconds = wallSeconds, .cpuSeconds = cpuSeconds};
+}
+
+//  Add the hardware events of a graph to the totals of its phases and of its
+//  size bucket.
+static void recordEvents(struct runStats *stats, struct graphTiming *timing) {
+    stats->countedEvents |= getCountedEvents(timing->counters);
+    int bucket = timing->numberOfVertices / SIZE_BUCKET_WIDTH;
+    if(bucket >= NUMBER_OF_SIZE_BUCKETS) {
+        bucket = NUMBER_OF_SIZE_BUCKETS - 1;
+    }
+    struct sizeBucket *sizeBucket = &stats->sizeBuckets[bucket];
+    sizeBucket->graphs++;
+    for(int phase = 0; phase < NUMBER_OF_STATS_PHASES; phase++) {
+        for(int i = 0; i < NUMBER_OF_HARDWARE_EVENTS; i++) {
+            long long unsigned int count = timing->events[phase][i];
+            stats->phases[phase].events[i] += count;
+            sizeBucket->events[phase][i] += count;
+            if(!isNested[phase]) {
+                stats->phases[TOTAL_PHASE].events[i] += count;
+                sizeBucket->events[TOTAL_PHASE][i] += count;
+            }
+        }
+    }
+}
+
+void recordGraph(struct runStats *stats, const char *graphString,
+ struct graphTiming *timing) {
+    double wallSeconds = 0;
+    double cpuSeconds = 0;
+    for(int phase = 0; phase < NUMBER_OF_STATS_PHASES; phase++) {
+        if(timing->calls[phase] == 0) {
+            continue;
+        }
+        addToPhase(&stats->phases[phase], timing->calls[phase],
+         timing->wallSeconds[phase], timing->cpuSeconds[phase]);
+        if(!isNested[phase]) {
+            wallSeconds += timing->wallSeconds[phase];
+            cpuSeconds += timing->cpuSeconds[phase];
+        }
+    }
+    stats->graphs++;
+    addToPhase(&stats->phases[TOTAL_PHASE], 1, wallSeconds, cpuSeconds);
+    updateSlowest(stats, graphString, wallSeconds, cpuSeconds);
+    if(timing->counters != NULL) {
+        recordEvents(stats, timing);
+    }
+}
+
+//  Smallest upper bound of a bucket such that at least the fraction q of the
+//  graphs falls below it, or the maximum if that is smaller.
+static double getQuantile(struct phaseStats *phase, double q) {
+    long long unsigned int seen = 0;
+    for(int bucket = 0; bucket < HISTOGRAM_BUCKETS - 1; bucket++) {
+        seen += phase->histogram[bucket];
+        if(seen >= q * phase->graphs) {
+            double upperBound = (double) (1ULL << (bucket + 1)) / 1e9;
+            return upperBound < phase->maxWallSeconds ? upperBound :
+             phase->maxWallSeconds;
+        }
+    }
+    return phase->maxWallSeconds;
+}
+
+static char *formatDuration(double seconds, char *buffer, size_t size) {
+    if(seconds < 1e-6) {
+        snprintf(buffer, size, "%.0fns", seconds * 1e9);
+    }
+    else if(seconds < 1e-3) {
+        snprintf(buffer, size, "%.1fus", seconds * 1e6);
+    }
+    else if(seconds < 1) {
+        snprintf(buffer, size, "%.1fms", seconds * 1e3);
+    }
+    else {
+        snprintf(buffer, size, "%.2fs", seconds);
+    }
+    return buffer;
+}
+
+static char *formatInteger(int value, char *buffer, size_t size) {
+    snprintf(buffer, size, "%d", value);
+    return buffer;
+}
+
+static void printEventHeader(FILE *file, const char *label) {
+    fprintf(file, "%-34s", label);
+    for(int i = 0; i < NUMBER_OF_HARDWARE_EVENTS; i++) {
+        fprintf(file, " %14s", getHardwareEventName(i));
+    }
+    fprintf(file, " %6s\n", "IPC");
+}
+
+//  Events which were not counted are shown as a dash.
+static void printEventRow(struct runStats *stats, FILE *file,
+ const char *label, long long unsigned int events[]) {
+    fprintf(file, "%-34s", label);
+    for(int i = 0; i < NUMBER_OF_HARDWARE_EVENTS; i++) {
+        if(stats->countedEvents & (1U << i)) {
+            fprintf(file, " %14llu", events[i]);
+        }
+        else {
+            fprintf(file, " %14s", "-");
+        }
+    }
+    if(events[CYCLES_EVENT] > 0 && events[INSTRUCTIONS_EVENT] > 0) {
+        fprintf(file, " %6.2f", (double) events[INSTRUCTIONS_EVENT] /
+         events[CYCLES_EVENT]);
+    }
+    else {
+        fprintf(file, " %6s", "-");
+    }
+    fprintf(file, "\n");
+}
+
+static void printText(struct runStats *stats, FILE *file, double wallSeconds,
+ double cpuSeconds) {
+    char buffers[4][16];
+    fprintf(file, "Statistics of %llu graphs, %.3f s wall time and %.3f s CPU "
+     "time in total:\n", stats->graphs, wallSeconds, cpuSeconds);
+    fprintf(file, "%-26s %10s %12s %12s %12s %9s %9s %9s %9s\n", "phase",
+     "graphs", "calls", "wall (s)", "cpu (s)", "p50", "p90", "p99", "max");
+    for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+        struct phaseStats *phase = &stats->phases[i];
+        if(phase->graphs == 0) {
+            continue;
+        }
+        fprintf(file, "%-26s %10llu %12llu %12.3f %12.3f %9s %9s %9s %9s\n",
+         phaseNames[i], phase->graphs, phase->calls, phase->wallSeconds,
+         phase->cpuSeconds,
+         formatDuration(getQuantile(phase, 0.5), buffers[0], 16),
+         formatDuration(getQuantile(phase, 0.9), buffers[1], 16),
+         formatDuration(getQuantile(phase, 0.99), buffers[2], 16),
+         formatDuration(phase->maxWallSeconds, buffers[3], 16));
+    }
+
+    fprintf(file, "Wall time per graph (histogram buckets [t, 2t)):\n");
+    for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+        struct phaseStats *phase = &stats->phases[i];
+        if(phase->graphs == 0) {
+            continue;
+        }
+        fprintf(file, "  %s:", phaseNames[i]);
+        for(int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if(phase->histogram[bucket] > 0) {
+                fprintf(file, " %s:%llu",
+                 formatDuration((double) (1ULL << bucket) / 1e9, buffers[0],
+                 16), phase->histogram[bucket]);
+            }
+        }
+        fprintf(file, "\n");
+    }
+
+    if(stats->numberOfSlowest > 0) {
+        fprintf(file, "Slowest graphs (wall, cpu):\n");
+    }
+    for(int i = 0; i < stats->numberOfSlowest; i++) {
+        fprintf(file, "  %9s %9s  %s\n",
+         formatDuration(stats->slowest[i].wallSeconds, buffers[0], 16),
+         formatDuration(stats->slowest[i].cpuSeconds, buffers[1], 16),
+         stats->slowest[i].graphString);
+    }
+
+    if(stats->countedEvents == 0) {
+        return;
+    }
+    fprintf(file, "Hardware events per phase:\n");
+    printEventHeader(file, "phase");
+    for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+        if(stats->phases[i].graphs > 0) {
+            printEventRow(stats, file, phaseNames[i], stats->phases[i].events);
+        }
+    }
+    fprintf(file, "Hardware events per number of vertices:\n");
+    printEventHeader(file, "vertices phase");
+    for(int bucket = 0; bucket < NUMBER_OF_SIZE_BUCKETS; bucket++) {
+        struct sizeBucket *sizeBucket = &stats->sizeBuckets[bucket];
+        if(sizeBucket->graphs == 0) {
+            continue;
+        }
+        for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+            if(sizeBucket->events[i][CYCLES_EVENT] == 0 &&
+             sizeBucket->events[i][INSTRUCTIONS_EVENT] == 0) {
+                continue;
+            }
+            char label[48];
+            snprintf(label, sizeof(label), "%d-%s %s",
+             bucket*SIZE_BUCKET_WIDTH, bucket == NUMBER_OF_SIZE_BUCKETS - 1 ?
+             "" : formatInteger((bucket + 1)*SIZE_BUCKET_WIDTH - 1,
+             buffers[0], 16), phaseNames[i]);
+            printEventRow(stats, file, label, sizeBucket->events[i]);
+        }
+    }
+}
+
+//  graph6 strings can contain backslashes.
+static void printJSONString(const char *string, FILE *file) {
+    fputc('"', file);
+    for(; *string != '\0'; string++) {
+        if(*string == '\\' || *string == '"') {
+            fputc('\\', file);
+        }
+        fputc(*string, file);
+    }
+    fputc('"', file);
+}
+
+//  Only the events which were counted are included.
+static void printJSONEvents(struct runStats *stats, FILE *file,
+ long long unsigned int events[]) {
+    if(stats->countedEvents == 0) {
+        return;
+    }
+    fprintf(file, ", \"events\": {");
+    bool isFirst = true;
+    for(int i = 0; i < NUMBER_OF_HARDWARE_EVENTS; i++) {
+        if(stats->countedEvents & (1U << i)) {
+            fprintf(file, "%s\"%s\": %llu", isFirst ? "" : ", ",
+             getHardwareEventName(i), events[i]);
+            isFirst = false;
+        }
+    }
+    fprintf(file, "}");
+}
+
+static void printJSON(struct runStats *stats, FILE *file, double wallSeconds,
+ double cpuSeconds) {
+    fprintf(file, "{\"graphs\": %llu, \"wallSeconds\": %.9f, "
+     "\"cpuSeconds\": %.9f, \"phases\": [", stats->graphs, wallSeconds,
+     cpuSeconds);
+    bool isFirst = true;
+    for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+        struct phaseStats *phase = &stats->phases[i];
+        if(phase->graphs == 0) {
+            continue;
+        }
+        fprintf(file, "%s\n  {\"name\": \"%s\", \"graphs\": %llu, "
+         "\"calls\": %llu, \"wallSeconds\": %.9f, \"cpuSeconds\": %.9f, "
+         "\"maxWallSeconds\": %.9f, \"histogram\": [", isFirst ? "" : ",",
+         phaseNames[i], phase->graphs, phase->calls, phase->wallSeconds,
+         phase->cpuSeconds, phase->maxWallSeconds);
+        isFirst = false;
+        bool isFirstBucket = true;
+        for(int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if(phase->histogram[bucket] > 0) {
+                fprintf(file, "%s{\"fromNanoseconds\": %llu, \"count\": %llu}",
+                 isFirstBucket ? "" : ", ", bucket == 0 ? 0 : 1ULL << bucket,
+                 phase->histogram[bucket]);
+                isFirstBucket = false;
+            }
+        }
+        fprintf(file, "]");
+        printJSONEvents(stats, file, phase->events);
+        fprintf(file, "}");
+    }
+    fprintf(file, "],\n \"slowestGraphs\": [");
+    for(int i = 0; i < stats->numberOfSlowest; i++) {
+        fprintf(file, "%s\n  {\"graph\": ", i == 0 ? "" : ",");
+        printJSONString(stats->slowest[i].graphString, file);
+        fprintf(file, ", \"wallSeconds\": %.9f, \"cpuSeconds\": %.9f}",
+         stats->slowest[i].wallSeconds, stats->slowest[i].cpuSeconds);
+    }
+    fprintf(file, "]");
+    if(stats->countedEvents != 0) {
+        fprintf(file, ",\n \"sizeBuckets\": [");
+        bool isFirstBucket = true;
+        for(int bucket = 0; bucket < NUMBER_OF_SIZE_BUCKETS; bucket++) {
+            struct sizeBucket *sizeBucket = &stats->sizeBuckets[bucket];
+            if(sizeBucket->graphs == 0) {
+                continue;
+            }
+            fprintf(file, "%s\n  {\"fromVertices\": %d, \"graphs\": %llu, "
+             "\"phases\": [", isFirstBucket ? "" : ",",
+             bucket*SIZE_BUCKET_WIDTH, sizeBucket->graphs);
+            isFirstBucket = false;
+            for(int i = 0; i <= NUMBER_OF_STATS_PHASES; i++) {
+                fprintf(file, "%s{\"name\": \"%s\"", i == 0 ? "" : ", ",
+                 phaseNames[i]);
+                printJSONEvents(stats, file, sizeBucket->events[i]);
+                fprintf(file, "}");
+            }
+            fprintf(file, "]}");
+        }
+        fprintf(file, "]");
+    }
+    fprintf(file, "}\n");
+}
+
+void printRunStats(struct runStats *stats, FILE *file, bool json) {
+    struct timespec wall;
+    struct timespec cpu;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    double wallSeconds = secondsBetween(&stats->startWall, &wall);
+    double cpuSeconds = secondsBetween(&stats->startCpu, &cpu);
+    if(json) {
+        printJSON(stats, file, wallSeconds, cpuSeconds);
+    }
+    else {
+        printText(stats, file, wallSeconds, cpuSeconds);
+    }
+}
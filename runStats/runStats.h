@@ -0,0 +1,80 @@
+#ifndef RUN_STATS
+#define RUN_STATS
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "../hardwareCounters/hardwareCounters.h"
+
+//  Number of graphs kept in the list of slowest graphs.
+#define SLOWEST_GRAPHS 10
+
+//  The hardware events are also reported for graphs grouped by their number
+//  of vertices in buckets of SIZE_BUCKET_WIDTH. The last bucket also contains
+//  all larger graphs.
+#define SIZE_BUCKET_WIDTH 16
+#define NUMBER_OF_SIZE_BUCKETS 8
+
+//  Phases of checking a graph. Phases marked as nested are part of the
+//  orientations phase.
+enum statsPhase {
+    DECODE_PHASE,
+    VALIDATION_PHASE,
+    SUFFICIENT_CONDITION_PHASE,
+    ORIENTATIONS_PHASE,
+    DELETABLE_EDGES_PHASE,              //  Nested.
+    COMPLEMENTARY_ORIENTATION_PHASE,    //  Nested.
+    OUTPUT_PHASE,
+    NUMBER_OF_STATS_PHASES
+};
+
+//  Time spent on one graph in every phase and how often it was entered. The
+//  hardware events of every phase are only counted if counters is not NULL.
+struct graphTiming {
+    double wallSeconds[NUMBER_OF_STATS_PHASES];
+    double cpuSeconds[NUMBER_OF_STATS_PHASES];
+    long long unsigned int calls[NUMBER_OF_STATS_PHASES];
+    struct hardwareCounters *counters;
+    long long unsigned int events[NUMBER_OF_STATS_PHASES]
+     [NUMBER_OF_HARDWARE_EVENTS];
+    int numberOfVertices;
+};
+
+//  Timestamps and counter values taken at the start of a phase.
+struct phaseStart {
+    struct timespec wall;
+    struct timespec cpu;
+    bool hasEvents;
+    long long unsigned int events[NUMBER_OF_HARDWARE_EVENTS];
+};
+
+//  Time a phase using CLOCK_MONOTONIC and CLOCK_THREAD_CPUTIME_ID. Nothing
+//  happens if timing is NULL.
+void startPhase(struct graphTiming *timing, struct phaseStart *start);
+
+void endPhase(struct graphTiming *timing, struct phaseStart *start,
+ enum statsPhase phase);
+
+//  Only count the hardware events of a phase whose time is measured
+//  elsewhere. Nothing happens if timing is NULL or has no counters.
+void startEvents(struct graphTiming *timing, struct phaseStart *start);
+
+void endEvents(struct graphTiming *timing, struct phaseStart *start,
+ enum statsPhase phase);
+
+//  Totals, log-scale latency histograms, the slowest graphs and the hardware
+//  events per phase and per size bucket of a run.
+struct runStats;
+
+struct runStats *newRunStats(void);
+
+void freeRunStats(struct runStats *stats);
+
+//  Add the timings of a checked graph. graphString may end with a newline.
+void recordGraph(struct runStats *stats, const char *graphString,
+ struct graphTiming *timing);
+
+//  Write the summary in plain text or as a JSON object.
+void printRunStats(struct runStats *stats, FILE *file, bool json);
+
+#endif
@@ -0,0 +1,140 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "traceEvents.h"
+
+//  All timestamps are relative to the moment the file was opened. Threads get
+//  consecutive ids in the order in which their buffers were created.
+struct traceFile {
+    pthread_mutex_t lock;
+    FILE *file;
+    long long unsigned int origin;
+    int numberOfThreads;
+    bool hasEvents;
+};
+
+struct span {
+    const char *name;
+    long long unsigned int start;
+    long long unsigned int end;
+    char *graphString;
+};
+
+struct traceBuffer {
+    struct traceFile *file;
+    int threadId;
+    int numberOfSpans;
+    struct span spans[TRACE_BUFFER_SPANS];
+};
+
+long long unsigned int getTraceTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long unsigned int) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+struct traceFile *openTraceFile(const char *fileName) {
+    struct traceFile *file = malloc(sizeof(struct traceFile));
+    if(file == NULL) {
+        return NULL;
+    }
+    *file = (struct traceFile) {.lock = PTHREAD_MUTEX_INITIALIZER,
+     .file = fopen(fileName, "w"), .origin = getTraceTime()};
+    if(file->file == NULL) {
+        free(file);
+        return NULL;
+    }
+    fprintf(file->file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    return file;
+}
+
+bool closeTraceFile(struct traceFile *file) {
+    fprintf(file->file, "\n]}\n");
+    bool succeeded = !ferror(file->file);
+    succeeded = fclose(file->file) == 0 && succeeded;
+    pthread_mutex_destroy(&file->lock);
+    free(file);
+    return succeeded;
+}
+
+//  Should be called with the lock of the file.
+static void startEvent(struct traceFile *file) {
+    fprintf(file->file, "%s\n", file->hasEvents ? "," : "");
+    file->hasEvents = true;
+}
+
+//  graph6 strings can contain backslashes.
+static void writeGraphString(FILE *file, const char *graphString) {
+    for(; *graphString != '\0'; graphString++) {
+        if(*graphString == '\\' || *graphString == '"') {
+            fputc('\\', file);
+        }
+        fputc(*graphString, file);
+    }
+}
+
+static void flushTraceBuffer(struct traceBuffer *buffer) {
+    struct traceFile *file = buffer->file;
+    pid_t processId = getpid();
+    pthread_mutex_lock(&file->lock);
+    for(int i = 0; i < buffer->numberOfSpans; i++) {
+        struct span *span = &buffer->spans[i];
+        startEvent(file);
+        fprintf(file->file, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, "
+         "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f", span->name,
+         (int) processId, buffer->threadId,
+         (span->start - file->origin) / 1e3,
+         (span->end - span->start) / 1e3);
+        if(span->graphString != NULL) {
+            fprintf(file->file, ", \"args\": {\"graph\": \"");
+            writeGraphString(file->file, span->graphString);
+            fprintf(file->file, "\"}");
+            free(span->graphString);
+        }
+        fprintf(file->file, "}");
+    }
+    pthread_mutex_unlock(&file->lock);
+    buffer->numberOfSpans = 0;
+}
+
+struct traceBuffer *newTraceBuffer(struct traceFile *file,
+ const char *threadName) {
+    struct traceBuffer *buffer = malloc(sizeof(struct traceBuffer));
+    if(buffer == NULL) {
+        return NULL;
+    }
+    buffer->file = file;
+    buffer->numberOfSpans = 0;
+    pthread_mutex_lock(&file->lock);
+    buffer->threadId = file->numberOfThreads++;
+    startEvent(file);
+    fprintf(file->file, "{\"name\": \"thread_name\", \"ph\": \"M\", "
+     "\"pid\": %d, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+     (int) getpid(), buffer->threadId, threadName);
+    pthread_mutex_unlock(&file->lock);
+    return buffer;
+}
+
+void freeTraceBuffer(struct traceBuffer *buffer) {
+    if(buffer == NULL) {
+        return;
+    }
+    flushTraceBuffer(buffer);
+    free(buffer);
+}
+
+void addSpan(struct traceBuffer *buffer, const char *name,
+ long long unsigned int start, long long unsigned int end,
+ const char *graphString) {
+    if(buffer->numberOfSpans == TRACE_BUFFER_SPANS) {
+        flushTraceBuffer(buffer);
+    }
+    struct span *span = &buffer->spans[buffer->numberOfSpans++];
+    *span = (struct span) {.name = name, .start = start, .end = end};
+    if(graphString != NULL) {
+        span->graphString = strndup(graphString, strcspn(graphString, "\r\n"));
+    }
+}
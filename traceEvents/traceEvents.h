@@ -0,0 +1,41 @@
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS
+
+#include <stdbool.h>
+
+//  Number of spans a thread keeps before it writes them to the file.
+#define TRACE_BUFFER_SPANS 4096
+
+//  A file in the Chrome trace event format, which can be opened in
+//  chrome://tracing or Perfetto. Every thread records spans in its own
+//  buffer, so the file is only locked when a buffer is full or freed.
+struct traceFile;
+
+//  A buffer of spans of one thread.
+struct traceBuffer;
+
+//  Returns NULL if the file cannot be created.
+struct traceFile *openTraceFile(const char *fileName);
+
+//  Write the end of the trace and close the file. All buffers need to be
+//  freed first. Returns false if writing failed.
+bool closeTraceFile(struct traceFile *file);
+
+//  Create a buffer for the calling thread. threadName is shown by the trace
+//  viewer. Returns NULL if memory runs out.
+struct traceBuffer *newTraceBuffer(struct traceFile *file,
+ const char *threadName);
+
+//  Write the remaining spans of the buffer and free it.
+void freeTraceBuffer(struct traceBuffer *buffer);
+
+//  CLOCK_MONOTONIC in nanoseconds, used for the start and end of spans.
+long long unsigned int getTraceTime(void);
+
+//  Add a span from start to end. name should be a string literal. If
+//  graphString is not NULL, its first line is shown as argument of the span.
+void addSpan(struct traceBuffer *buffer, const char *name,
+ long long unsigned int start, long long unsigned int end,
+ const char *graphString);
+
+#endif